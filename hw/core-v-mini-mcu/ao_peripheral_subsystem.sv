@@ -378,11 +378,16 @@ module ao_peripheral_subsystem
   assign dma_trigger_slots[6] = ext_dma_slot_rx_i;
 
   dma #(
-      .reg_req_t (reg_pkg::reg_req_t),
-      .reg_rsp_t (reg_pkg::reg_rsp_t),
-      .obi_req_t (obi_pkg::obi_req_t),
-      .obi_resp_t(obi_pkg::obi_resp_t),
-      .SLOT_NUM  (DMA_TRIGGER_SLOT_NUM)
+      .reg_req_t      (reg_pkg::reg_req_t),
+      .reg_rsp_t      (reg_pkg::reg_rsp_t),
+      .obi_req_t      (obi_pkg::obi_req_t),
+      .obi_resp_t     (obi_pkg::obi_resp_t),
+      .SLOT_NUM       (DMA_TRIGGER_SLOT_NUM),
+      .FIFO_DEPTH     (core_v_mini_mcu_pkg::DMA_FIFO_DEPTH),
+      .MAX_OUTSTANDING(core_v_mini_mcu_pkg::DMA_MAX_OUTSTANDING),
+      .CH_NUM         (core_v_mini_mcu_pkg::DMA_CH_NUM),
+      .ARB_POLICY     (core_v_mini_mcu_pkg::DMA_ARB_POLICY),
+      .REG_ADDR_W     ($clog2(core_v_mini_mcu_pkg::DMA_SIZE))
   ) dma_i (
       .clk_i,
       .rst_ni,
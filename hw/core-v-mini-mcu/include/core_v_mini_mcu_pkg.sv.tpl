@@ -57,6 +57,15 @@ package core_v_mini_mcu_pkg;
   localparam int unsigned NUM_BANKS_IL = ${ram_numbanks_il};
   localparam int unsigned EXTERNAL_DOMAINS = ${external_domains};
 
+  // DMA channels, their register banks are DMA_CH_SIZE bytes apart
+  localparam int unsigned DMA_CH_NUM = ${dma_ch_num};
+  localparam logic [31:0] DMA_CH_SIZE = 32'h100;
+  // 0: round-robin, 1: by channel priority
+  localparam int unsigned DMA_ARB_POLICY = ${1 if dma_arb_policy == "priority" else 0};
+  // Words buffered and reads in flight per channel
+  localparam int unsigned DMA_FIFO_DEPTH = ${dma_fifo_depth};
+  localparam int unsigned DMA_MAX_OUTSTANDING = ${dma_max_outstanding};
+
   localparam logic[31:0] ERROR_START_ADDRESS = 32'hBADACCE5;
   localparam logic[31:0] ERROR_SIZE = 32'h00000001;
   localparam logic[31:0] ERROR_END_ADDRESS = ERROR_START_ADDRESS + ERROR_SIZE;
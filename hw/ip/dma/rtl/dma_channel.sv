@@ -0,0 +1,927 @@
+// Copyright 2022 EPFL
+// Solderpad Hardware License, Version 2.1, see LICENSE.md for details.
+// SPDX-License-Identifier: Apache-2.0 WITH SHL-2.1
+
+// One channel of the DMA: register bank, FIFOs and read/write/address
+// masters. The bus ports are shared with the other channels by dma.sv.
+//
+// The read and address masters keep up to MAX_OUTSTANDING requests in flight.
+// A request is only issued if the FIFO has room for the data of all the
+// requests in flight, so the responses are never dropped: with a latency of
+// L cycles, MAX_OUTSTANDING = L + 1 and FIFO_DEPTH > MAX_OUTSTANDING sustain
+// one word per cycle.
+//
+// Outside address mode a transfer can have 2 or 3 dimensions: SIZE_D3 planes
+// of SIZE_D2 rows of SIZE bytes. At the end of a row the read and write
+// pointers jump to the start of the next row (SRC/DST_STRIDE_D2 from the start
+// of the current one), at the end of a plane to the start of the next plane
+// (SRC/DST_STRIDE_D3 from the start of the current one).
+//
+// Writing DESC_PTR runs a linked list of descriptors: while the channel is
+// idle, the descriptor loader reads the DescWords words of a descriptor on the
+// read port, writes them to the transaction registers and starts the
+// transaction, then follows the next pointer once it is done. The interrupt
+// and STATUS.TRANSACTION_DONE are only raised for the descriptors with the irq
+// bit set, and at the end of the list.
+
+module dma_channel #(
+    parameter int unsigned FIFO_DEPTH = 4,
+    parameter int unsigned MAX_OUTSTANDING = 2,
+    parameter type reg_req_t = logic,
+    parameter type reg_rsp_t = logic,
+    parameter type obi_req_t = logic,
+    parameter type obi_resp_t = logic,
+    parameter int unsigned SLOT_NUM = 0
+) (
+    input logic clk_i,
+    input logic rst_ni,
+
+    input  reg_req_t reg_req_i,
+    output reg_rsp_t reg_rsp_o,
+
+    output obi_req_t  read_req_o,
+    input  obi_resp_t read_resp_i,
+
+    output obi_req_t  write_req_o,
+    input  obi_resp_t write_resp_i,
+
+    output obi_req_t  addr_req_o,
+    input  obi_resp_t addr_resp_i,
+
+    input logic [SLOT_NUM-1:0] trigger_slot_i,
+
+    output logic [2:0] priority_o,
+    output logic       busy_o,
+
+    output done_intr_o,
+    output window_intr_o
+);
+
+  import dma_reg_pkg::*;
+
+  localparam int unsigned Addr_Fifo_Depth = (FIFO_DEPTH > 1) ? $clog2(FIFO_DEPTH) : 1;
+  localparam int unsigned OutstandingW = $clog2(MAX_OUTSTANDING + 1);
+  localparam int unsigned FifoSlotW = $clog2(FIFO_DEPTH + 1);
+  // Descriptor: next, SRC_PTR, DST_PTR, SIZE, {irq, DATA_TYPE, PTR_INC}, SLOT,
+  // {SIZE_D3, SIZE_D2}, SRC_STRIDE_D2, DST_STRIDE_D2, SRC_STRIDE_D3, DST_STRIDE_D3
+  localparam int unsigned DescWords = 11;
+
+  dma_reg2hw_t                       reg2hw;
+  dma_hw2reg_t                       hw2reg;
+
+  logic        [               31:0] read_ptr_reg;
+  logic        [               31:0] read_row_ptr;
+  logic        [               31:0] read_plane_ptr;
+  logic        [               31:0] addr_ptr_reg;
+  logic        [                1:0] read_offset_valid;
+  logic        [               31:0] write_ptr_reg;
+  logic        [               31:0] write_row_ptr;
+  logic        [               31:0] write_plane_ptr;
+  logic        [               31:0] write_address;
+  logic        [               31:0] dma_cnt;
+  logic        [               31:0] dma_addr_cnt;
+  logic        [                2:0] dma_cnt_dec;
+  logic        [               31:0] write_cnt;
+
+  // 2D/3D transfer: rows and planes left for the read and write sides
+  logic        [               15:0] dim_rows;
+  logic        [               15:0] dim_planes;
+  logic        [               15:0] read_rows_left;
+  logic        [               15:0] read_planes_left;
+  logic        [               15:0] write_rows_left;
+  logic        [               15:0] write_planes_left;
+  logic                              read_row_end;
+  logic                              write_row_end;
+  logic                              dma_start;
+  logic                              dma_done;
+  logic                              dma_window_event;
+
+  logic                              window_done_q;
+  logic                              transaction_done_q;
+
+  logic        [Addr_Fifo_Depth-1:0] fifo_usage;
+  logic        [      FifoSlotW-1:0] fifo_slots;
+  logic                              read_credit;
+
+  logic        [Addr_Fifo_Depth-1:0] fifo_addr_usage;
+  logic        [      FifoSlotW-1:0] fifo_addr_slots;
+  logic                              addr_read_credit;
+
+  logic                              data_in_req;
+  logic                              data_in_we;
+  logic        [                3:0] data_in_be;
+  logic        [               31:0] data_in_addr;
+  logic                              data_in_gnt;
+  logic                              data_in_rvalid;
+  logic        [               31:0] data_in_rdata;
+
+  logic                              data_addr_in_req;
+  logic                              data_addr_in_we;
+  logic        [                3:0] data_addr_in_be;
+  logic        [               31:0] data_addr_in_addr;
+  logic                              data_addr_in_gnt;
+  logic                              data_addr_in_rvalid;
+  logic        [               31:0] data_addr_in_rdata;
+
+  logic                              data_out_req;
+  logic                              data_out_we;
+  logic        [                3:0] data_out_be;
+  logic        [               31:0] data_out_addr;
+  logic        [               31:0] data_out_wdata;
+  logic                              data_out_gnt;
+  logic                              data_out_rvalid;
+  logic        [               31:0] data_out_rdata;
+
+  logic                              fifo_flush;
+  logic                              fifo_full;
+  logic                              fifo_empty;
+
+  logic                              fifo_addr_flush;
+  logic                              fifo_addr_full;
+  logic fifo_addr_empty, fifo_addr_empty_check;
+
+  logic        wait_for_rx;
+  logic        wait_for_tx;
+
+  logic [ 1:0] data_type;
+
+  logic [31:0] fifo_input;
+  logic [31:0] fifo_addr_input;
+  logic [31:0] fifo_output;
+  logic [31:0] fifo_addr_output;
+
+  logic [ 3:0] byte_enable_out;
+
+  logic        circular_mode;
+  logic        address_mode;
+
+  logic        dma_start_pending;
+
+  // Linked list descriptor loader
+  logic [31:0] desc_addr_q;
+  logic [31:0] desc_next_q;
+  logic        desc_irq_q;
+  logic [ 3:0] desc_req_idx_q;
+  logic [ 3:0] desc_rsp_idx_q;
+  logic        desc_req;
+  logic        desc_gnt;
+  logic        desc_rvalid;
+  logic        desc_launch;
+  logic        desc_busy;
+  logic        desc_irq_en;
+
+  enum {
+    DMA_READY,
+    DMA_STARTING,
+    DMA_RUNNING
+  }
+      dma_state_q, dma_state_d;
+
+  logic [OutstandingW-1:0] outstanding_req, outstanding_addr_req;
+
+  enum logic {
+    DMA_READ_FSM_IDLE,
+    DMA_READ_FSM_ON
+  }
+      dma_read_fsm_state, dma_read_fsm_n_state, dma_read_addr_fsm_state, dma_read_addr_fsm_n_state;
+
+  enum logic {
+    DMA_WRITE_FSM_IDLE,
+    DMA_WRITE_FSM_ON
+  }
+      dma_write_fsm_state, dma_write_fsm_n_state;
+
+  // FETCH: read the descriptor, WAIT: wait for its transaction to be done
+  enum logic [1:0] {
+    DESC_IDLE,
+    DESC_FETCH,
+    DESC_WAIT
+  }
+      desc_state_q, desc_state_d;
+
+  // The descriptor loader only uses the read port while the transaction side is idle
+  assign read_req_o.req = data_in_req | desc_req;
+  assign read_req_o.we = data_in_we;
+  assign read_req_o.be = desc_req ? 4'b1111 : data_in_be;
+  assign read_req_o.addr = desc_req ? desc_addr_q + {26'h0, desc_req_idx_q, 2'b00} : data_in_addr;
+  assign read_req_o.wdata = 32'h0;
+
+  assign desc_gnt = read_resp_i.gnt & desc_req;
+  assign desc_rvalid = read_resp_i.rvalid & (desc_state_q == DESC_FETCH);
+
+  assign data_in_gnt = read_resp_i.gnt & ~desc_req;
+  assign data_in_rvalid = read_resp_i.rvalid & (desc_state_q != DESC_FETCH);
+  assign data_in_rdata = read_resp_i.rdata;
+
+  assign addr_req_o.req = data_addr_in_req;
+  assign addr_req_o.we = data_addr_in_we;
+  assign addr_req_o.be = data_addr_in_be;
+  assign addr_req_o.addr = data_addr_in_addr;
+  assign addr_req_o.wdata = 32'h0;
+
+  assign data_addr_in_gnt = addr_resp_i.gnt;
+  assign data_addr_in_rvalid = addr_resp_i.rvalid;
+  assign data_addr_in_rdata = addr_resp_i.rdata;
+
+  assign write_req_o.req = data_out_req;
+  assign write_req_o.we = data_out_we;
+  assign write_req_o.be = data_out_be;
+  assign write_req_o.addr = data_out_addr;
+  assign write_req_o.wdata = data_out_wdata;
+
+  assign data_out_gnt = write_resp_i.gnt;
+  assign data_out_rvalid = write_resp_i.rvalid;
+  assign data_out_rdata = write_resp_i.rdata;
+
+  // In a linked list, only the descriptors with the irq bit set and the last one
+  // raise the interrupt
+  assign desc_irq_en = ~desc_busy | desc_irq_q | ~|desc_next_q;
+
+  assign done_intr_o = dma_done & desc_irq_en & reg2hw.interrupt_en.transaction_done.q;
+  assign window_intr_o = dma_window_event & reg2hw.interrupt_en.window_done.q;
+
+  assign priority_o = reg2hw.ch_priority.q;
+  assign busy_o = (dma_state_q != DMA_READY) | desc_busy;
+
+
+  logic [31:0] window_counter;
+
+
+  assign data_type = reg2hw.data_type.q;
+
+  assign hw2reg.status.ready.d = (dma_state_q == DMA_READY) & ~desc_busy;
+
+  assign hw2reg.status.window_done.d = window_done_q;
+
+  assign hw2reg.status.transaction_done.d = transaction_done_q;
+
+  assign circular_mode = reg2hw.mode.q == 1;
+  assign address_mode = reg2hw.mode.q == 2;
+
+  assign write_address = address_mode ? fifo_addr_output : write_ptr_reg;
+
+  assign wait_for_rx = |(reg2hw.slot.rx_trigger_slot.q[SLOT_NUM-1:0] & (~trigger_slot_i));
+  assign wait_for_tx = |(reg2hw.slot.tx_trigger_slot.q[SLOT_NUM-1:0] & (~trigger_slot_i));
+
+  assign fifo_addr_empty_check = fifo_addr_empty && address_mode;
+
+  // 0 and 1 are a single row/plane, address mode is always 1D
+  assign dim_rows = (address_mode || ~|reg2hw.size_d2.q[15:1]) ? 16'h1 : reg2hw.size_d2.q;
+  assign dim_planes = (address_mode || ~|reg2hw.size_d3.q[15:1]) ? 16'h1 : reg2hw.size_d3.q;
+
+  assign read_row_end = (dma_cnt <= {29'h0, dma_cnt_dec});
+  assign write_row_end = (write_cnt <= {29'h0, dma_cnt_dec});
+
+  // Free FIFO entries (usage_o wraps to 0 when the FIFO is full)
+  assign fifo_slots = fifo_full ? '0 : FIFO_DEPTH[FifoSlotW-1:0] - FifoSlotW'(fifo_usage);
+  assign fifo_addr_slots = fifo_addr_full ? '0 : FIFO_DEPTH[FifoSlotW-1:0] - FifoSlotW'(fifo_addr_usage);
+
+  // Room for one more request: below the outstanding limit and a free FIFO entry
+  // for each request in flight, the rvalid in this cycle is not counted back
+  assign read_credit = (outstanding_req < MAX_OUTSTANDING[OutstandingW-1:0]) &&
+                       (FifoSlotW'(outstanding_req) < fifo_slots);
+  assign addr_read_credit = (outstanding_addr_req < MAX_OUTSTANDING[OutstandingW-1:0]) &&
+                            (FifoSlotW'(outstanding_addr_req) < fifo_addr_slots);
+
+  assign dma_start = (dma_state_q == DMA_STARTING);
+
+  //
+  // Main DMA state machine
+  //
+  // READY   : idle, waiting for a write pulse to size registered in `dma_start_pending`
+  // STARTING: load transaction data
+  // RUNNING : waiting for transaction finish
+  //           when `dma_done` rises either enter ready or restart in circular mode
+  //
+  always_comb begin
+    dma_state_d = dma_state_q;
+    case (dma_state_q)
+      DMA_READY: begin
+        if (dma_start_pending) begin
+          dma_state_d = DMA_STARTING;
+        end
+      end
+      DMA_STARTING: begin
+        dma_state_d = DMA_RUNNING;
+      end
+      DMA_RUNNING: begin
+        if (dma_done) begin
+          if (circular_mode && !desc_busy) dma_state_d = DMA_STARTING;
+          else dma_state_d = DMA_READY;
+        end
+      end
+    endcase
+  end
+
+  // update state
+  always_ff @(posedge clk_i, negedge rst_ni) begin
+    if (~rst_ni) begin
+      dma_state_q <= DMA_READY;
+    end else begin
+      dma_state_q <= dma_state_d;
+    end
+  end
+
+
+  // DMA pulse start when dma_start register is written
+  always_ff @(posedge clk_i or negedge rst_ni) begin : proc_dma_start
+    if (~rst_ni) begin
+      dma_start_pending <= 1'b0;
+    end else begin
+      if (dma_start == 1'b1) begin
+        dma_start_pending <= 1'b0;
+      end else if ((reg2hw.size.qe & |reg2hw.size.q) | desc_launch) begin
+        dma_start_pending <= 1'b1;
+      end
+    end
+  end
+
+  // Store input data pointer and increment everytime read request is granted,
+  // jump to the next row or plane at the end of a row
+  always_ff @(posedge clk_i or negedge rst_ni) begin : proc_ptr_in_reg
+    if (~rst_ni) begin
+      read_ptr_reg   <= '0;
+      read_row_ptr   <= '0;
+      read_plane_ptr <= '0;
+    end else begin
+      if (dma_start == 1'b1) begin
+        read_ptr_reg   <= reg2hw.src_ptr.q;
+        read_row_ptr   <= reg2hw.src_ptr.q;
+        read_plane_ptr <= reg2hw.src_ptr.q;
+      end else if (data_in_gnt == 1'b1) begin
+        if (read_row_end && read_rows_left > 16'h1) begin
+          read_ptr_reg <= read_row_ptr + reg2hw.src_stride_d2.q;
+          read_row_ptr <= read_row_ptr + reg2hw.src_stride_d2.q;
+        end else if (read_row_end && read_planes_left > 16'h1) begin
+          read_ptr_reg   <= read_plane_ptr + reg2hw.src_stride_d3.q;
+          read_row_ptr   <= read_plane_ptr + reg2hw.src_stride_d3.q;
+          read_plane_ptr <= read_plane_ptr + reg2hw.src_stride_d3.q;
+        end else begin
+          read_ptr_reg <= read_ptr_reg + {24'h0, reg2hw.ptr_inc.src_ptr_inc.q};
+        end
+      end
+    end
+  end
+
+  // Store address data pointer and increment everytime read request is granted - only in address mode
+  always_ff @(posedge clk_i or negedge rst_ni) begin : proc_ptr_addr_reg
+    if (~rst_ni) begin
+      addr_ptr_reg <= '0;
+    end else begin
+      if (dma_start == 1'b1 && address_mode) begin
+        addr_ptr_reg <= reg2hw.addr_ptr.q;
+      end else if (data_addr_in_gnt == 1'b1 && address_mode) begin
+        addr_ptr_reg <= addr_ptr_reg + 32'h4;  //always continuos in 32b
+      end
+    end
+  end
+
+  // Store output data pointer and increment everytime write request is granted,
+  // jump to the next row or plane at the end of a row
+  always_ff @(posedge clk_i or negedge rst_ni) begin : proc_ptr_out_reg
+    if (~rst_ni) begin
+      write_ptr_reg   <= '0;
+      write_row_ptr   <= '0;
+      write_plane_ptr <= '0;
+    end else begin
+      if (dma_start == 1'b1) begin
+        write_ptr_reg   <= reg2hw.dst_ptr.q;
+        write_row_ptr   <= reg2hw.dst_ptr.q;
+        write_plane_ptr <= reg2hw.dst_ptr.q;
+      end else if (data_out_gnt == 1'b1) begin
+        if (write_row_end && write_rows_left > 16'h1) begin
+          write_ptr_reg <= write_row_ptr + reg2hw.dst_stride_d2.q;
+          write_row_ptr <= write_row_ptr + reg2hw.dst_stride_d2.q;
+        end else if (write_row_end && write_planes_left > 16'h1) begin
+          write_ptr_reg   <= write_plane_ptr + reg2hw.dst_stride_d3.q;
+          write_row_ptr   <= write_plane_ptr + reg2hw.dst_stride_d3.q;
+          write_plane_ptr <= write_plane_ptr + reg2hw.dst_stride_d3.q;
+        end else begin
+          write_ptr_reg <= write_ptr_reg + {24'h0, reg2hw.ptr_inc.dst_ptr_inc.q};
+        end
+      end
+    end
+  end
+
+  // Store the bytes left in the row and the rows and planes left, decrement them
+  // everytime read request is granted; dma_cnt only reaches 0 after the last row
+  always_ff @(posedge clk_i or negedge rst_ni) begin : proc_dma_cnt_reg
+    if (~rst_ni) begin
+      dma_cnt <= '0;
+      read_rows_left <= '0;
+      read_planes_left <= '0;
+    end else begin
+      if (dma_start == 1'b1) begin
+        dma_cnt <= reg2hw.size.q;
+        read_rows_left <= dim_rows;
+        read_planes_left <= dim_planes;
+      end else if (data_in_gnt == 1'b1) begin
+        if (read_row_end && read_rows_left > 16'h1) begin
+          dma_cnt <= reg2hw.size.q;
+          read_rows_left <= read_rows_left - 16'h1;
+        end else if (read_row_end && read_planes_left > 16'h1) begin
+          dma_cnt <= reg2hw.size.q;
+          read_rows_left <= dim_rows;
+          read_planes_left <= read_planes_left - 16'h1;
+        end else if (read_row_end) begin
+          dma_cnt <= '0;
+        end else begin
+          dma_cnt <= dma_cnt - {29'h0, dma_cnt_dec};
+        end
+      end
+    end
+  end
+
+  // Same count on the write side, to know where its rows end
+  always_ff @(posedge clk_i or negedge rst_ni) begin : proc_write_cnt_reg
+    if (~rst_ni) begin
+      write_cnt <= '0;
+      write_rows_left <= '0;
+      write_planes_left <= '0;
+    end else begin
+      if (dma_start == 1'b1) begin
+        write_cnt <= reg2hw.size.q;
+        write_rows_left <= dim_rows;
+        write_planes_left <= dim_planes;
+      end else if (data_out_gnt == 1'b1) begin
+        if (write_row_end && write_rows_left > 16'h1) begin
+          write_cnt <= reg2hw.size.q;
+          write_rows_left <= write_rows_left - 16'h1;
+        end else if (write_row_end && write_planes_left > 16'h1) begin
+          write_cnt <= reg2hw.size.q;
+          write_rows_left <= dim_rows;
+          write_planes_left <= write_planes_left - 16'h1;
+        end else if (write_row_end) begin
+          write_cnt <= '0;
+        end else begin
+          write_cnt <= write_cnt - {29'h0, dma_cnt_dec};
+        end
+      end
+    end
+  end
+
+  // Store dma transfer size for the address port
+  always_ff @(posedge clk_i or negedge rst_ni) begin : proc_dma_addr_cnt_reg
+    if (~rst_ni) begin
+      dma_addr_cnt <= '0;
+    end else begin
+      if (dma_start == 1'b1 && address_mode) begin
+        dma_addr_cnt <= reg2hw.size.q;
+      end else if (data_addr_in_gnt == 1'b1 && address_mode) begin
+        dma_addr_cnt <= dma_addr_cnt - 32'h4;  //address always 32b
+      end
+    end
+  end
+
+  always_comb begin
+    case (data_type)
+      2'b00: dma_cnt_dec = 3'h4;
+      2'b01: dma_cnt_dec = 3'h2;
+      2'b10, 2'b11: dma_cnt_dec = 3'h1;
+    endcase
+  end
+
+  always_comb begin : proc_byte_enable_out
+    case (data_type)  // Data type 00 Word, 01 Half word, 11,10 byte
+      2'b00: byte_enable_out = 4'b1111;  // Writing a word (32 bits)
+
+      2'b01: begin  // Writing a half-word (16 bits)
+        case (write_address[1])
+          1'b0: byte_enable_out = 4'b0011;
+          1'b1: byte_enable_out = 4'b1100;
+        endcase
+        ;  // case(write_address[1:0])
+      end
+
+      2'b10, 2'b11: begin  // Writing a byte (8 bits)
+        case (write_address[1:0])
+          2'b00: byte_enable_out = 4'b0001;
+          2'b01: byte_enable_out = 4'b0010;
+          2'b10: byte_enable_out = 4'b0100;
+          2'b11: byte_enable_out = 4'b1000;
+        endcase
+        ;  // case(write_address[1:0])
+      end
+    endcase
+    ;  // case (data_type)
+  end
+
+  // Output data shift
+  always_comb begin : proc_output_data
+
+    data_out_wdata[7:0]   = fifo_output[7:0];
+    data_out_wdata[15:8]  = fifo_output[15:8];
+    data_out_wdata[23:16] = fifo_output[23:16];
+    data_out_wdata[31:24] = fifo_output[31:24];
+
+    case (write_address[1:0])
+      2'b00: ;
+
+      2'b01: data_out_wdata[15:8] = fifo_output[7:0];
+
+      2'b10: begin
+        data_out_wdata[23:16] = fifo_output[7:0];
+        data_out_wdata[31:24] = fifo_output[15:8];
+      end
+
+      2'b11: data_out_wdata[31:24] = fifo_output[7:0];
+    endcase
+  end
+
+  assign fifo_addr_input = data_addr_in_rdata;  //never misaligned, always 32b
+
+  // Input data shift: shift the input data to be on the LSB of the fifo
+  always_comb begin : proc_input_data
+
+    fifo_input[7:0]   = data_in_rdata[7:0];
+    fifo_input[15:8]  = data_in_rdata[15:8];
+    fifo_input[23:16] = data_in_rdata[23:16];
+    fifo_input[31:24] = data_in_rdata[31:24];
+
+    case (read_offset_valid)
+      2'b00: ;
+
+      2'b01: fifo_input[7:0] = data_in_rdata[15:8];
+
+      2'b10: begin
+        fifo_input[7:0]  = data_in_rdata[23:16];
+        fifo_input[15:8] = data_in_rdata[31:24];
+      end
+
+      2'b11: fifo_input[7:0] = data_in_rdata[31:24];
+    endcase
+  end
+
+  // FSM state update
+  always_ff @(posedge clk_i or negedge rst_ni) begin : proc_fsm_state
+    if (~rst_ni) begin
+      dma_read_fsm_state <= DMA_READ_FSM_IDLE;
+      dma_write_fsm_state <= DMA_WRITE_FSM_IDLE;
+      dma_read_addr_fsm_state <= DMA_READ_FSM_IDLE;
+      outstanding_req <= '0;
+      outstanding_addr_req <= '0;
+    end else begin
+      dma_read_fsm_state <= dma_read_fsm_n_state;
+      dma_write_fsm_state <= dma_write_fsm_n_state;
+      dma_read_addr_fsm_state <= dma_read_addr_fsm_n_state;
+      outstanding_req <= outstanding_req + (data_in_req && data_in_gnt) - data_in_rvalid;
+
+      if (address_mode)
+        outstanding_addr_req <= outstanding_addr_req + (data_addr_in_req && data_addr_in_gnt) - data_addr_in_rvalid;
+
+    end
+  end
+
+  // Read master FSM
+  always_comb begin : proc_dma_read_fsm_logic
+
+    dma_read_fsm_n_state = DMA_READ_FSM_IDLE;
+
+    data_in_req = '0;
+    data_in_we = '0;
+    data_in_be = '0;
+    data_in_addr = '0;
+
+    fifo_flush = 1'b0;
+
+    unique case (dma_read_fsm_state)
+
+      DMA_READ_FSM_IDLE: begin
+        // Wait for start signal
+        if (dma_start == 1'b1) begin
+          dma_read_fsm_n_state = DMA_READ_FSM_ON;
+          fifo_flush = 1'b1;
+        end else begin
+          dma_read_fsm_n_state = DMA_READ_FSM_IDLE;
+        end
+      end
+      // Read one word
+      DMA_READ_FSM_ON: begin
+        // If all input data read exit
+        if (|dma_cnt == 1'b0) begin
+          dma_read_fsm_n_state = DMA_READ_FSM_IDLE;
+        end else begin
+          dma_read_fsm_n_state = DMA_READ_FSM_ON;
+          // Wait if there is no credit (outstanding limit or fifo space), or if the SPI RX does not have valid data (only in SPI mode 1).
+          if (read_credit == 1'b1 && wait_for_rx == 1'b0) begin
+            data_in_req  = 1'b1;
+            data_in_we   = 1'b0;
+            data_in_be   = 4'b1111;  // always read all bytes
+            data_in_addr = read_ptr_reg;
+          end
+        end
+      end
+    endcase
+  end
+
+  // Read address master FSM
+  always_comb begin : proc_dma_addr_read_fsm_logic
+
+    dma_read_addr_fsm_n_state = DMA_READ_FSM_IDLE;
+
+    data_addr_in_req = '0;
+    data_addr_in_we = '0;
+    data_addr_in_be = '0;
+    data_addr_in_addr = '0;
+
+    fifo_addr_flush = 1'b0;
+
+    unique case (dma_read_addr_fsm_state)
+
+      DMA_READ_FSM_IDLE: begin
+        // Wait for start signal
+        if (dma_start == 1'b1 && address_mode) begin
+          dma_read_addr_fsm_n_state = DMA_READ_FSM_ON;
+          fifo_addr_flush = 1'b1;
+        end else begin
+          dma_read_addr_fsm_n_state = DMA_READ_FSM_IDLE;
+        end
+      end
+      // Read one word
+      DMA_READ_FSM_ON: begin
+        // If all input data read exit
+        if (|dma_addr_cnt == 1'b0) begin
+          dma_read_addr_fsm_n_state = DMA_READ_FSM_IDLE;
+        end else begin
+          dma_read_addr_fsm_n_state = DMA_READ_FSM_ON;
+          // Wait if there is no credit (outstanding limit or fifo space).
+          if (addr_read_credit == 1'b1) begin
+            data_addr_in_req  = 1'b1;
+            data_addr_in_we   = 1'b0;
+            data_addr_in_be   = 4'b1111;  // always read all bytes
+            data_addr_in_addr = addr_ptr_reg;
+          end
+        end
+      end
+    endcase
+  end
+
+  // Write master FSM
+  always_comb begin : proc_dma_write_fsm_logic
+
+    dma_write_fsm_n_state = DMA_WRITE_FSM_IDLE;
+    dma_done = 1'b0;
+
+    data_out_req = '0;
+    data_out_we = '0;
+    data_out_be = '0;
+    data_out_addr = '0;
+
+    unique case (dma_write_fsm_state)
+
+      DMA_WRITE_FSM_IDLE: begin
+        // Wait for start signal
+        if (dma_start == 1'b1) begin
+          dma_write_fsm_n_state = DMA_WRITE_FSM_ON;
+        end else begin
+          dma_write_fsm_n_state = DMA_WRITE_FSM_IDLE;
+        end
+      end
+      // Read one word
+      DMA_WRITE_FSM_ON: begin
+        // If all input data read exit
+        if (fifo_empty == 1'b1 && dma_read_fsm_state == DMA_READ_FSM_IDLE) begin
+          dma_done = outstanding_req == '0 && outstanding_addr_req == '0;
+          dma_write_fsm_n_state = dma_done ? DMA_WRITE_FSM_IDLE : DMA_WRITE_FSM_ON;
+        end else begin
+          dma_write_fsm_n_state = DMA_WRITE_FSM_ON;
+          // Wait if fifo is empty or if the SPI TX is not ready for new data (only in SPI mode 2).
+          if (fifo_empty == 1'b0 && wait_for_tx == 1'b0 && fifo_addr_empty_check == 1'b0) begin
+            data_out_req  = 1'b1;
+            data_out_we   = 1'b1;
+            data_out_be   = byte_enable_out;
+            data_out_addr = write_address;
+          end
+        end
+      end
+    endcase
+  end
+
+  //
+  // Linked list descriptor loader
+  //
+  // IDLE : waiting for a write of a non-zero address to DESC_PTR, with the channel ready
+  // FETCH: read the descriptor words (MAX_OUTSTANDING in flight) into the registers,
+  //        then start the transaction
+  // WAIT : waiting for the transaction to finish, then fetch the next descriptor
+  //
+  assign desc_busy = (desc_state_q != DESC_IDLE);
+  assign desc_req = (desc_state_q == DESC_FETCH) && (desc_req_idx_q < DescWords[3:0]) &&
+                    (desc_req_idx_q - desc_rsp_idx_q < MAX_OUTSTANDING[3:0]);
+  assign desc_launch = desc_rvalid && (desc_rsp_idx_q == DescWords[3:0] - 4'h1);
+
+  always_comb begin : proc_desc_fsm
+    desc_state_d = desc_state_q;
+    case (desc_state_q)
+      DESC_IDLE: begin
+        if (reg2hw.desc_ptr.qe && |reg2hw.desc_ptr.q && dma_state_q == DMA_READY) begin
+          desc_state_d = DESC_FETCH;
+        end
+      end
+      DESC_FETCH: begin
+        if (desc_launch) desc_state_d = DESC_WAIT;
+      end
+      DESC_WAIT: begin
+        if (dma_done) desc_state_d = |desc_next_q ? DESC_FETCH : DESC_IDLE;
+      end
+      default: desc_state_d = DESC_IDLE;
+    endcase
+  end
+
+  always_ff @(posedge clk_i, negedge rst_ni) begin : proc_desc_reg
+    if (~rst_ni) begin
+      desc_state_q   <= DESC_IDLE;
+      desc_addr_q    <= '0;
+      desc_next_q    <= '0;
+      desc_irq_q     <= 1'b0;
+      desc_req_idx_q <= '0;
+      desc_rsp_idx_q <= '0;
+    end else begin
+      desc_state_q <= desc_state_d;
+      if (desc_state_q == DESC_IDLE) begin
+        desc_addr_q    <= reg2hw.desc_ptr.q;
+        desc_req_idx_q <= '0;
+        desc_rsp_idx_q <= '0;
+      end else if (desc_state_q == DESC_WAIT) begin
+        desc_addr_q    <= desc_next_q;
+        desc_req_idx_q <= '0;
+        desc_rsp_idx_q <= '0;
+      end else begin
+        if (desc_gnt) desc_req_idx_q <= desc_req_idx_q + 4'h1;
+        if (desc_rvalid) desc_rsp_idx_q <= desc_rsp_idx_q + 4'h1;
+      end
+      if (desc_rvalid && desc_rsp_idx_q == 4'h0) desc_next_q <= read_resp_i.rdata;
+      if (desc_rvalid && desc_rsp_idx_q == 4'h4) desc_irq_q <= read_resp_i.rdata[31];
+    end
+  end
+
+  // Write the descriptor words to the transaction registers
+  always_comb begin : proc_desc_load
+    hw2reg.src_ptr.d = read_resp_i.rdata;
+    hw2reg.dst_ptr.d = read_resp_i.rdata;
+    hw2reg.size.d = read_resp_i.rdata;
+    hw2reg.ptr_inc.src_ptr_inc.d = read_resp_i.rdata[7:0];
+    hw2reg.ptr_inc.dst_ptr_inc.d = read_resp_i.rdata[15:8];
+    hw2reg.data_type.d = read_resp_i.rdata[17:16];
+    hw2reg.slot.rx_trigger_slot.d = read_resp_i.rdata[15:0];
+    hw2reg.slot.tx_trigger_slot.d = read_resp_i.rdata[31:16];
+    hw2reg.size_d2.d = read_resp_i.rdata[15:0];
+    hw2reg.size_d3.d = read_resp_i.rdata[31:16];
+    hw2reg.src_stride_d2.d = read_resp_i.rdata;
+    hw2reg.dst_stride_d2.d = read_resp_i.rdata;
+    hw2reg.src_stride_d3.d = read_resp_i.rdata;
+    hw2reg.dst_stride_d3.d = read_resp_i.rdata;
+
+    hw2reg.src_ptr.de = desc_rvalid && desc_rsp_idx_q == 4'h1;
+    hw2reg.dst_ptr.de = desc_rvalid && desc_rsp_idx_q == 4'h2;
+    hw2reg.size.de = desc_rvalid && desc_rsp_idx_q == 4'h3;
+    hw2reg.ptr_inc.src_ptr_inc.de = desc_rvalid && desc_rsp_idx_q == 4'h4;
+    hw2reg.ptr_inc.dst_ptr_inc.de = desc_rvalid && desc_rsp_idx_q == 4'h4;
+    hw2reg.data_type.de = desc_rvalid && desc_rsp_idx_q == 4'h4;
+    hw2reg.slot.rx_trigger_slot.de = desc_rvalid && desc_rsp_idx_q == 4'h5;
+    hw2reg.slot.tx_trigger_slot.de = desc_rvalid && desc_rsp_idx_q == 4'h5;
+    hw2reg.size_d2.de = desc_rvalid && desc_rsp_idx_q == 4'h6;
+    hw2reg.size_d3.de = desc_rvalid && desc_rsp_idx_q == 4'h6;
+    hw2reg.src_stride_d2.de = desc_rvalid && desc_rsp_idx_q == 4'h7;
+    hw2reg.dst_stride_d2.de = desc_rvalid && desc_rsp_idx_q == 4'h8;
+    hw2reg.src_stride_d3.de = desc_rvalid && desc_rsp_idx_q == 4'h9;
+    hw2reg.dst_stride_d3.de = desc_rvalid && desc_rsp_idx_q == 4'ha;
+
+    // DESC_PTR reads back the descriptor being run
+    hw2reg.desc_ptr.d = desc_next_q;
+    hw2reg.desc_ptr.de = desc_state_q == DESC_WAIT && dma_done && |desc_next_q;
+  end
+
+  fifo_v3 #(
+      .DEPTH(FIFO_DEPTH)
+  ) dma_fifo_i (
+      .clk_i,
+      .rst_ni,
+      .flush_i(fifo_flush),
+      .testmode_i(1'b0),
+      // status flags
+      .full_o(fifo_full),
+      .empty_o(fifo_empty),
+      .usage_o(fifo_usage),
+      // as long as the queue is not full we can push new data
+      .data_i(fifo_input),
+      .push_i(data_in_rvalid),
+      // as long as the queue is not empty we can pop new elements
+      .data_o(fifo_output),
+      .pop_i(data_out_gnt)
+  );
+
+  // Byte offset of each read in flight, to align its data once it is valid
+  fifo_v3 #(
+      .DATA_WIDTH(2),
+      .DEPTH(MAX_OUTSTANDING)
+  ) dma_read_offset_fifo_i (
+      .clk_i,
+      .rst_ni,
+      .flush_i(fifo_flush),
+      .testmode_i(1'b0),
+      // status flags
+      .full_o(),
+      .empty_o(),
+      .usage_o(),
+      // offset of the granted read
+      .data_i(read_ptr_reg[1:0]),
+      .push_i(data_in_req & data_in_gnt),
+      // offset of the oldest read in flight
+      .data_o(read_offset_valid),
+      .pop_i(data_in_rvalid)
+  );
+
+  fifo_v3 #(
+      .DEPTH(FIFO_DEPTH)
+  ) dma_addr_fifo_i (
+      .clk_i,
+      .rst_ni,
+      .flush_i(fifo_addr_flush),
+      .testmode_i(1'b0),
+      // status flags
+      .full_o(fifo_addr_full),
+      .empty_o(fifo_addr_empty),
+      .usage_o(fifo_addr_usage),
+      // as long as the queue is not full we can push new data
+      .data_i(fifo_addr_input),
+      .push_i(data_addr_in_rvalid),
+      // as long as the queue is not empty we can pop new elements
+      .data_o(fifo_addr_output),
+      .pop_i(data_out_gnt && address_mode)
+  );
+
+  dma_reg_top #(
+      .reg_req_t(reg_req_t),
+      .reg_rsp_t(reg_rsp_t)
+  ) dma_reg_top_i (
+      .clk_i,
+      .rst_ni,
+      .reg_req_i,
+      .reg_rsp_o,
+      .reg2hw,
+      .hw2reg,
+      .devmode_i(1'b1)
+  );
+
+  // WINDOW EVENT
+  // Count gnt write transaction and generate event pulse if WINDOW_SIZE is reached
+  assign dma_window_event = |reg2hw.window_size.q &  data_out_gnt & (window_counter + 'h1 >= reg2hw.window_size.q);
+
+  always_ff @(posedge clk_i, negedge rst_ni) begin
+    if (~rst_ni) begin
+      window_counter <= 'h0;
+    end else begin
+      if (|reg2hw.window_size.q) begin
+        if (dma_start | dma_done) begin
+          window_counter <= 'h0;
+        end else if (data_out_gnt) begin
+          if (window_counter + 'h1 >= reg2hw.window_size.q) begin
+            window_counter <= 'h0;
+          end else begin
+            window_counter <= window_counter + 'h1;
+          end
+        end
+      end
+    end
+  end
+
+  // Update WINDOW_COUNT register
+  always_comb begin
+    hw2reg.window_count.d  = reg2hw.window_count.q + 'h1;
+    hw2reg.window_count.de = 1'b0;
+    if (dma_start) begin
+      hw2reg.window_count.d  = 'h0;
+      hw2reg.window_count.de = 1'b1;
+    end else if (dma_window_event) begin
+      hw2reg.window_count.de = 1'b1;
+    end
+  end
+
+  // update window_done flag
+  // set on dma_window_event
+  // reset on read
+  always_ff @(posedge clk_i, negedge rst_ni) begin
+    if (~rst_ni) begin
+      window_done_q <= 1'b0;
+    end else begin
+      if (dma_window_event) window_done_q <= 1'b1;
+      else if (reg2hw.status.window_done.re) window_done_q <= 1'b0;
+    end
+  end
+
+  // update transaction_done flag
+  // set on dma_done, also at the end of each pass in circular mode and of each
+  // descriptor with the irq bit set in a linked list
+  // reset on read
+  always_ff @(posedge clk_i, negedge rst_ni) begin
+    if (~rst_ni) begin
+      transaction_done_q <= 1'b0;
+    end else begin
+      if (dma_done & desc_irq_en) transaction_done_q <= 1'b1;
+      else if (reg2hw.status.transaction_done.re) transaction_done_q <= 1'b0;
+    end
+  end
+
+
+endmodule : dma_channel
@@ -0,0 +1,117 @@
+// Copyright 2022 EPFL
+// Solderpad Hardware License, Version 2.1, see LICENSE.md for details.
+// SPDX-License-Identifier: Apache-2.0 WITH SHL-2.1
+
+// Shares one OBI master port of the DMA between its channels.
+//
+// ARB_POLICY 0 serves the requesting channels in turns, ARB_POLICY 1 serves
+// the requesting channel with the highest priority and the channels of equal
+// priority in turns. A request keeps the port until it is granted (or dropped
+// by its channel), as OBI wants the address phase stable. The index of each
+// granted channel is queued to route the responses back in order; the port
+// stalls when OUTSTANDING responses are pending.
+
+module dma_obi_arbiter #(
+    parameter int unsigned CH_NUM = 1,
+    parameter int unsigned ARB_POLICY = 0,
+    parameter int unsigned OUTSTANDING = 4,
+    parameter type obi_req_t = logic,
+    parameter type obi_resp_t = logic
+) (
+    input logic clk_i,
+    input logic rst_ni,
+
+    input  obi_req_t                ch_req_i     [CH_NUM],
+    output obi_resp_t               ch_resp_o    [CH_NUM],
+    input  logic      [CH_NUM-1:0][2:0] ch_priority_i,
+
+    output obi_req_t  req_o,
+    input  obi_resp_t resp_i
+);
+
+  if (CH_NUM == 1) begin : gen_single_channel
+
+    assign req_o = ch_req_i[0];
+    assign ch_resp_o[0] = resp_i;
+
+  end else begin : gen_arbiter
+
+    localparam int unsigned IdxW = $clog2(CH_NUM);
+
+    logic [IdxW-1:0] sel, sel_q, last_q, resp_idx;
+    logic            locked_q;
+    logic            locked;
+    logic            found;
+    logic [     2:0] best_priority;
+    logic            idx_fifo_full;
+    logic            handshake;
+
+    // A request not granted yet keeps the port, unless its channel drops it
+    assign locked = locked_q & ch_req_i[sel_q].req;
+
+    // Look for the next requesting channel after the last one served
+    always_comb begin : proc_select
+      int unsigned ch;
+      sel = last_q;
+      found = 1'b0;
+      best_priority = '0;
+      for (int unsigned k = 1; k <= CH_NUM; k++) begin
+        ch = int'(last_q) + k;
+        if (ch >= CH_NUM) ch = ch - CH_NUM;
+        if (ch_req_i[ch].req && (!found || (ARB_POLICY == 1 && ch_priority_i[ch] > best_priority))) begin
+          sel = ch[IdxW-1:0];
+          found = 1'b1;
+          best_priority = ch_priority_i[ch];
+        end
+      end
+      if (locked) sel = sel_q;
+    end
+
+    always_comb begin : proc_port
+      req_o = ch_req_i[sel];
+      req_o.req = ch_req_i[sel].req & ~idx_fifo_full;
+    end
+
+    assign handshake = req_o.req & resp_i.gnt;
+
+    for (genvar i = 0; i < CH_NUM; i++) begin : gen_ch_resp
+      assign ch_resp_o[i].gnt = handshake & (sel == i);
+      assign ch_resp_o[i].rvalid = resp_i.rvalid & (resp_idx == i);
+      assign ch_resp_o[i].rdata = resp_i.rdata;
+    end
+
+    always_ff @(posedge clk_i, negedge rst_ni) begin
+      if (~rst_ni) begin
+        locked_q <= 1'b0;
+        sel_q <= '0;
+        last_q <= '0;
+      end else begin
+        locked_q <= req_o.req & ~resp_i.gnt;
+        sel_q <= sel;
+        if (handshake) last_q <= sel;
+      end
+    end
+
+    fifo_v3 #(
+        .DATA_WIDTH(IdxW),
+        .DEPTH(OUTSTANDING)
+    ) resp_idx_fifo_i (
+        .clk_i,
+        .rst_ni,
+        .flush_i(1'b0),
+        .testmode_i(1'b0),
+        // status flags
+        .full_o(idx_fifo_full),
+        .empty_o(),
+        .usage_o(),
+        // index of the channel granted
+        .data_i(sel),
+        .push_i(handshake),
+        // index of the channel the response goes to
+        .data_o(resp_idx),
+        .pop_i(resp_i.rvalid)
+    );
+
+  end
+
+endmodule : dma_obi_arbiter
@@ -7,7 +7,7 @@
 package dma_reg_pkg;
 
   // Address widths within the block
-  parameter int BlockAw = 6;
+  parameter int BlockAw = 7;
 
   ////////////////////////////
   // Typedefs for registers //
@@ -33,6 +33,10 @@ package dma_reg_pkg;
       logic q;
       logic re;
     } window_done;
+    struct packed {
+      logic q;
+      logic re;
+    } transaction_done;
   } dma_reg2hw_status_reg_t;
 
   typedef struct packed {
@@ -58,56 +62,183 @@ package dma_reg_pkg;
     struct packed {logic q;} window_done;
   } dma_reg2hw_interrupt_en_reg_t;
 
+  typedef struct packed {logic [2:0] q;} dma_reg2hw_ch_priority_reg_t;
+
+  typedef struct packed {logic [15:0] q;} dma_reg2hw_size_d2_reg_t;
+
+  typedef struct packed {logic [15:0] q;} dma_reg2hw_size_d3_reg_t;
+
+  typedef struct packed {logic [31:0] q;} dma_reg2hw_src_stride_d2_reg_t;
+
+  typedef struct packed {logic [31:0] q;} dma_reg2hw_src_stride_d3_reg_t;
+
+  typedef struct packed {logic [31:0] q;} dma_reg2hw_dst_stride_d2_reg_t;
+
+  typedef struct packed {logic [31:0] q;} dma_reg2hw_dst_stride_d3_reg_t;
+
+  typedef struct packed {
+    logic [31:0] q;
+    logic        qe;
+  } dma_reg2hw_desc_ptr_reg_t;
+
+  typedef struct packed {
+    logic [31:0] d;
+    logic        de;
+  } dma_hw2reg_src_ptr_reg_t;
+
+  typedef struct packed {
+    logic [31:0] d;
+    logic        de;
+  } dma_hw2reg_dst_ptr_reg_t;
+
+  typedef struct packed {
+    logic [31:0] d;
+    logic        de;
+  } dma_hw2reg_size_reg_t;
+
   typedef struct packed {
     struct packed {logic d;} ready;
     struct packed {logic d;} window_done;
+    struct packed {logic d;} transaction_done;
   } dma_hw2reg_status_reg_t;
 
+  typedef struct packed {
+    struct packed {
+      logic [7:0] d;
+      logic       de;
+    } src_ptr_inc;
+    struct packed {
+      logic [7:0] d;
+      logic       de;
+    } dst_ptr_inc;
+  } dma_hw2reg_ptr_inc_reg_t;
+
+  typedef struct packed {
+    struct packed {
+      logic [15:0] d;
+      logic        de;
+    } rx_trigger_slot;
+    struct packed {
+      logic [15:0] d;
+      logic        de;
+    } tx_trigger_slot;
+  } dma_hw2reg_slot_reg_t;
+
+  typedef struct packed {
+    logic [1:0] d;
+    logic       de;
+  } dma_hw2reg_data_type_reg_t;
+
   typedef struct packed {
     logic [31:0] d;
     logic        de;
   } dma_hw2reg_window_count_reg_t;
 
+  typedef struct packed {
+    logic [15:0] d;
+    logic        de;
+  } dma_hw2reg_size_d2_reg_t;
+
+  typedef struct packed {
+    logic [15:0] d;
+    logic        de;
+  } dma_hw2reg_size_d3_reg_t;
+
+  typedef struct packed {
+    logic [31:0] d;
+    logic        de;
+  } dma_hw2reg_src_stride_d2_reg_t;
+
+  typedef struct packed {
+    logic [31:0] d;
+    logic        de;
+  } dma_hw2reg_src_stride_d3_reg_t;
+
+  typedef struct packed {
+    logic [31:0] d;
+    logic        de;
+  } dma_hw2reg_dst_stride_d2_reg_t;
+
+  typedef struct packed {
+    logic [31:0] d;
+    logic        de;
+  } dma_hw2reg_dst_stride_d3_reg_t;
+
+  typedef struct packed {
+    logic [31:0] d;
+    logic        de;
+  } dma_hw2reg_desc_ptr_reg_t;
+
   // Register -> HW type
   typedef struct packed {
-    dma_reg2hw_src_ptr_reg_t src_ptr;  // [250:219]
-    dma_reg2hw_dst_ptr_reg_t dst_ptr;  // [218:187]
-    dma_reg2hw_addr_ptr_reg_t addr_ptr;  // [186:155]
-    dma_reg2hw_size_reg_t size;  // [154:122]
-    dma_reg2hw_status_reg_t status;  // [121:118]
-    dma_reg2hw_ptr_inc_reg_t ptr_inc;  // [117:102]
-    dma_reg2hw_slot_reg_t slot;  // [101:70]
-    dma_reg2hw_data_type_reg_t data_type;  // [69:68]
-    dma_reg2hw_mode_reg_t mode;  // [67:66]
-    dma_reg2hw_window_size_reg_t window_size;  // [65:34]
-    dma_reg2hw_window_count_reg_t window_count;  // [33:2]
-    dma_reg2hw_interrupt_en_reg_t interrupt_en;  // [1:0]
+    dma_reg2hw_src_ptr_reg_t src_ptr;  // [448:417]
+    dma_reg2hw_dst_ptr_reg_t dst_ptr;  // [416:385]
+    dma_reg2hw_addr_ptr_reg_t addr_ptr;  // [384:353]
+    dma_reg2hw_size_reg_t size;  // [352:320]
+    dma_reg2hw_status_reg_t status;  // [319:314]
+    dma_reg2hw_ptr_inc_reg_t ptr_inc;  // [313:298]
+    dma_reg2hw_slot_reg_t slot;  // [297:266]
+    dma_reg2hw_data_type_reg_t data_type;  // [265:264]
+    dma_reg2hw_mode_reg_t mode;  // [263:262]
+    dma_reg2hw_window_size_reg_t window_size;  // [261:230]
+    dma_reg2hw_window_count_reg_t window_count;  // [229:198]
+    dma_reg2hw_interrupt_en_reg_t interrupt_en;  // [197:196]
+    dma_reg2hw_ch_priority_reg_t ch_priority;  // [195:193]
+    dma_reg2hw_size_d2_reg_t size_d2;  // [192:177]
+    dma_reg2hw_size_d3_reg_t size_d3;  // [176:161]
+    dma_reg2hw_src_stride_d2_reg_t src_stride_d2;  // [160:129]
+    dma_reg2hw_src_stride_d3_reg_t src_stride_d3;  // [128:97]
+    dma_reg2hw_dst_stride_d2_reg_t dst_stride_d2;  // [96:65]
+    dma_reg2hw_dst_stride_d3_reg_t dst_stride_d3;  // [64:33]
+    dma_reg2hw_desc_ptr_reg_t desc_ptr;  // [32:0]
   } dma_reg2hw_t;
 
   // HW -> register type
   typedef struct packed {
-    dma_hw2reg_status_reg_t status;  // [34:33]
-    dma_hw2reg_window_count_reg_t window_count;  // [32:0]
+    dma_hw2reg_src_ptr_reg_t src_ptr;  // [388:356]
+    dma_hw2reg_dst_ptr_reg_t dst_ptr;  // [355:323]
+    dma_hw2reg_size_reg_t size;  // [322:290]
+    dma_hw2reg_status_reg_t status;  // [289:287]
+    dma_hw2reg_ptr_inc_reg_t ptr_inc;  // [286:269]
+    dma_hw2reg_slot_reg_t slot;  // [268:235]
+    dma_hw2reg_data_type_reg_t data_type;  // [234:232]
+    dma_hw2reg_window_count_reg_t window_count;  // [231:199]
+    dma_hw2reg_size_d2_reg_t size_d2;  // [198:182]
+    dma_hw2reg_size_d3_reg_t size_d3;  // [181:165]
+    dma_hw2reg_src_stride_d2_reg_t src_stride_d2;  // [164:132]
+    dma_hw2reg_src_stride_d3_reg_t src_stride_d3;  // [131:99]
+    dma_hw2reg_dst_stride_d2_reg_t dst_stride_d2;  // [98:66]
+    dma_hw2reg_dst_stride_d3_reg_t dst_stride_d3;  // [65:33]
+    dma_hw2reg_desc_ptr_reg_t desc_ptr;  // [32:0]
   } dma_hw2reg_t;
 
   // Register offsets
-  parameter logic [BlockAw-1:0] DMA_SRC_PTR_OFFSET = 6'h0;
-  parameter logic [BlockAw-1:0] DMA_DST_PTR_OFFSET = 6'h4;
-  parameter logic [BlockAw-1:0] DMA_ADDR_PTR_OFFSET = 6'h8;
-  parameter logic [BlockAw-1:0] DMA_SIZE_OFFSET = 6'hc;
-  parameter logic [BlockAw-1:0] DMA_STATUS_OFFSET = 6'h10;
-  parameter logic [BlockAw-1:0] DMA_PTR_INC_OFFSET = 6'h14;
-  parameter logic [BlockAw-1:0] DMA_SLOT_OFFSET = 6'h18;
-  parameter logic [BlockAw-1:0] DMA_DATA_TYPE_OFFSET = 6'h1c;
-  parameter logic [BlockAw-1:0] DMA_MODE_OFFSET = 6'h20;
-  parameter logic [BlockAw-1:0] DMA_WINDOW_SIZE_OFFSET = 6'h24;
-  parameter logic [BlockAw-1:0] DMA_WINDOW_COUNT_OFFSET = 6'h28;
-  parameter logic [BlockAw-1:0] DMA_INTERRUPT_EN_OFFSET = 6'h2c;
+  parameter logic [BlockAw-1:0] DMA_SRC_PTR_OFFSET = 7'h0;
+  parameter logic [BlockAw-1:0] DMA_DST_PTR_OFFSET = 7'h4;
+  parameter logic [BlockAw-1:0] DMA_ADDR_PTR_OFFSET = 7'h8;
+  parameter logic [BlockAw-1:0] DMA_SIZE_OFFSET = 7'hc;
+  parameter logic [BlockAw-1:0] DMA_STATUS_OFFSET = 7'h10;
+  parameter logic [BlockAw-1:0] DMA_PTR_INC_OFFSET = 7'h14;
+  parameter logic [BlockAw-1:0] DMA_SLOT_OFFSET = 7'h18;
+  parameter logic [BlockAw-1:0] DMA_DATA_TYPE_OFFSET = 7'h1c;
+  parameter logic [BlockAw-1:0] DMA_MODE_OFFSET = 7'h20;
+  parameter logic [BlockAw-1:0] DMA_WINDOW_SIZE_OFFSET = 7'h24;
+  parameter logic [BlockAw-1:0] DMA_WINDOW_COUNT_OFFSET = 7'h28;
+  parameter logic [BlockAw-1:0] DMA_INTERRUPT_EN_OFFSET = 7'h2c;
+  parameter logic [BlockAw-1:0] DMA_CH_PRIORITY_OFFSET = 7'h30;
+  parameter logic [BlockAw-1:0] DMA_SIZE_D2_OFFSET = 7'h34;
+  parameter logic [BlockAw-1:0] DMA_SIZE_D3_OFFSET = 7'h38;
+  parameter logic [BlockAw-1:0] DMA_SRC_STRIDE_D2_OFFSET = 7'h3c;
+  parameter logic [BlockAw-1:0] DMA_SRC_STRIDE_D3_OFFSET = 7'h40;
+  parameter logic [BlockAw-1:0] DMA_DST_STRIDE_D2_OFFSET = 7'h44;
+  parameter logic [BlockAw-1:0] DMA_DST_STRIDE_D3_OFFSET = 7'h48;
+  parameter logic [BlockAw-1:0] DMA_DESC_PTR_OFFSET = 7'h4c;
 
   // Reset values for hwext registers and their fields
-  parameter logic [1:0] DMA_STATUS_RESVAL = 2'h1;
+  parameter logic [2:0] DMA_STATUS_RESVAL = 3'h1;
   parameter logic [0:0] DMA_STATUS_READY_RESVAL = 1'h1;
   parameter logic [0:0] DMA_STATUS_WINDOW_DONE_RESVAL = 1'h0;
+  parameter logic [0:0] DMA_STATUS_TRANSACTION_DONE_RESVAL = 1'h0;
 
   // Register index
   typedef enum int {
@@ -122,11 +253,19 @@ package dma_reg_pkg;
     DMA_MODE,
     DMA_WINDOW_SIZE,
     DMA_WINDOW_COUNT,
-    DMA_INTERRUPT_EN
+    DMA_INTERRUPT_EN,
+    DMA_CH_PRIORITY,
+    DMA_SIZE_D2,
+    DMA_SIZE_D3,
+    DMA_SRC_STRIDE_D2,
+    DMA_SRC_STRIDE_D3,
+    DMA_DST_STRIDE_D2,
+    DMA_DST_STRIDE_D3,
+    DMA_DESC_PTR
   } dma_id_e;
 
   // Register width information to check illegal writes
-  parameter logic [3:0] DMA_PERMIT[12] = '{
+  parameter logic [3:0] DMA_PERMIT[20] = '{
       4'b1111,  // index[ 0] DMA_SRC_PTR
       4'b1111,  // index[ 1] DMA_DST_PTR
       4'b1111,  // index[ 2] DMA_ADDR_PTR
@@ -138,7 +277,15 @@ package dma_reg_pkg;
       4'b0001,  // index[ 8] DMA_MODE
       4'b1111,  // index[ 9] DMA_WINDOW_SIZE
       4'b1111,  // index[10] DMA_WINDOW_COUNT
-      4'b0001  // index[11] DMA_INTERRUPT_EN
+      4'b0001,  // index[11] DMA_INTERRUPT_EN
+      4'b0001,  // index[12] DMA_CH_PRIORITY
+      4'b0011,  // index[13] DMA_SIZE_D2
+      4'b0011,  // index[14] DMA_SIZE_D3
+      4'b1111,  // index[15] DMA_SRC_STRIDE_D2
+      4'b1111,  // index[16] DMA_SRC_STRIDE_D3
+      4'b1111,  // index[17] DMA_DST_STRIDE_D2
+      4'b1111,  // index[18] DMA_DST_STRIDE_D3
+      4'b1111  // index[19] DMA_DESC_PTR
   };
 
 endpackage
@@ -10,7 +10,7 @@
 module dma_reg_top #(
     parameter type reg_req_t = logic,
     parameter type reg_rsp_t = logic,
-    parameter int AW = 6
+    parameter int AW = 7
 ) (
     input logic clk_i,
     input logic rst_ni,
@@ -84,6 +84,8 @@ module dma_reg_top #(
   logic status_ready_re;
   logic status_window_done_qs;
   logic status_window_done_re;
+  logic status_transaction_done_qs;
+  logic status_transaction_done_re;
   logic [7:0] ptr_inc_src_ptr_inc_qs;
   logic [7:0] ptr_inc_src_ptr_inc_wd;
   logic ptr_inc_src_ptr_inc_we;
@@ -112,6 +114,30 @@ module dma_reg_top #(
   logic interrupt_en_window_done_qs;
   logic interrupt_en_window_done_wd;
   logic interrupt_en_window_done_we;
+  logic [2:0] ch_priority_qs;
+  logic [2:0] ch_priority_wd;
+  logic ch_priority_we;
+  logic [15:0] size_d2_qs;
+  logic [15:0] size_d2_wd;
+  logic size_d2_we;
+  logic [15:0] size_d3_qs;
+  logic [15:0] size_d3_wd;
+  logic size_d3_we;
+  logic [31:0] src_stride_d2_qs;
+  logic [31:0] src_stride_d2_wd;
+  logic src_stride_d2_we;
+  logic [31:0] src_stride_d3_qs;
+  logic [31:0] src_stride_d3_wd;
+  logic src_stride_d3_we;
+  logic [31:0] dst_stride_d2_qs;
+  logic [31:0] dst_stride_d2_wd;
+  logic dst_stride_d2_we;
+  logic [31:0] dst_stride_d3_qs;
+  logic [31:0] dst_stride_d3_wd;
+  logic dst_stride_d3_we;
+  logic [31:0] desc_ptr_qs;
+  logic [31:0] desc_ptr_wd;
+  logic desc_ptr_we;
 
   // Register instances
   // R[src_ptr]: V(False)
@@ -129,8 +155,8 @@ module dma_reg_top #(
       .wd(src_ptr_wd),
 
       // from internal hardware
-      .de(1'b0),
-      .d ('0),
+      .de(hw2reg.src_ptr.de),
+      .d (hw2reg.src_ptr.d),
 
       // to internal hardware
       .qe(),
@@ -156,8 +182,8 @@ module dma_reg_top #(
       .wd(dst_ptr_wd),
 
       // from internal hardware
-      .de(1'b0),
-      .d ('0),
+      .de(hw2reg.dst_ptr.de),
+      .d (hw2reg.dst_ptr.d),
 
       // to internal hardware
       .qe(),
@@ -210,8 +236,8 @@ module dma_reg_top #(
       .wd(size_wd),
 
       // from internal hardware
-      .de(1'b0),
-      .d ('0),
+      .de(hw2reg.size.de),
+      .d (hw2reg.size.d),
 
       // to internal hardware
       .qe(reg2hw.size.qe),
@@ -254,6 +280,21 @@ module dma_reg_top #(
   );
 
 
+  //   F[transaction_done]: 2:2
+  prim_subreg_ext #(
+      .DW(1)
+  ) u_status_transaction_done (
+      .re (status_transaction_done_re),
+      .we (1'b0),
+      .wd ('0),
+      .d  (hw2reg.status.transaction_done.d),
+      .qre(reg2hw.status.transaction_done.re),
+      .qe (),
+      .q  (reg2hw.status.transaction_done.q),
+      .qs (status_transaction_done_qs)
+  );
+
+
   // R[ptr_inc]: V(False)
 
   //   F[src_ptr_inc]: 7:0
@@ -270,8 +311,8 @@ module dma_reg_top #(
       .wd(ptr_inc_src_ptr_inc_wd),
 
       // from internal hardware
-      .de(1'b0),
-      .d ('0),
+      .de(hw2reg.ptr_inc.src_ptr_inc.de),
+      .d (hw2reg.ptr_inc.src_ptr_inc.d),
 
       // to internal hardware
       .qe(),
@@ -296,8 +337,8 @@ module dma_reg_top #(
       .wd(ptr_inc_dst_ptr_inc_wd),
 
       // from internal hardware
-      .de(1'b0),
-      .d ('0),
+      .de(hw2reg.ptr_inc.dst_ptr_inc.de),
+      .d (hw2reg.ptr_inc.dst_ptr_inc.d),
 
       // to internal hardware
       .qe(),
@@ -324,8 +365,8 @@ module dma_reg_top #(
       .wd(slot_rx_trigger_slot_wd),
 
       // from internal hardware
-      .de(1'b0),
-      .d ('0),
+      .de(hw2reg.slot.rx_trigger_slot.de),
+      .d (hw2reg.slot.rx_trigger_slot.d),
 
       // to internal hardware
       .qe(),
@@ -350,8 +391,8 @@ module dma_reg_top #(
       .wd(slot_tx_trigger_slot_wd),
 
       // from internal hardware
-      .de(1'b0),
-      .d ('0),
+      .de(hw2reg.slot.tx_trigger_slot.de),
+      .d (hw2reg.slot.tx_trigger_slot.d),
 
       // to internal hardware
       .qe(),
@@ -377,8 +418,8 @@ module dma_reg_top #(
       .wd(data_type_wd),
 
       // from internal hardware
-      .de(1'b0),
-      .d ('0),
+      .de(hw2reg.data_type.de),
+      .d (hw2reg.data_type.d),
 
       // to internal hardware
       .qe(),
@@ -523,9 +564,225 @@ module dma_reg_top #(
   );
 
 
+  // R[ch_priority]: V(False)
+
+  prim_subreg #(
+      .DW      (3),
+      .SWACCESS("RW"),
+      .RESVAL  (3'h0)
+  ) u_ch_priority (
+      .clk_i (clk_i),
+      .rst_ni(rst_ni),
+
+      // from register interface
+      .we(ch_priority_we),
+      .wd(ch_priority_wd),
+
+      // from internal hardware
+      .de(1'b0),
+      .d ('0),
+
+      // to internal hardware
+      .qe(),
+      .q (reg2hw.ch_priority.q),
+
+      // to register interface (read)
+      .qs(ch_priority_qs)
+  );
+
+
+  // R[size_d2]: V(False)
+
+  prim_subreg #(
+      .DW      (16),
+      .SWACCESS("RW"),
+      .RESVAL  (16'h0)
+  ) u_size_d2 (
+      .clk_i (clk_i),
+      .rst_ni(rst_ni),
+
+      // from register interface
+      .we(size_d2_we),
+      .wd(size_d2_wd),
+
+      // from internal hardware
+      .de(hw2reg.size_d2.de),
+      .d (hw2reg.size_d2.d),
+
+      // to internal hardware
+      .qe(),
+      .q (reg2hw.size_d2.q),
+
+      // to register interface (read)
+      .qs(size_d2_qs)
+  );
+
+
+  // R[size_d3]: V(False)
+
+  prim_subreg #(
+      .DW      (16),
+      .SWACCESS("RW"),
+      .RESVAL  (16'h0)
+  ) u_size_d3 (
+      .clk_i (clk_i),
+      .rst_ni(rst_ni),
+
+      // from register interface
+      .we(size_d3_we),
+      .wd(size_d3_wd),
+
+      // from internal hardware
+      .de(hw2reg.size_d3.de),
+      .d (hw2reg.size_d3.d),
+
+      // to internal hardware
+      .qe(),
+      .q (reg2hw.size_d3.q),
+
+      // to register interface (read)
+      .qs(size_d3_qs)
+  );
+
+
+  // R[src_stride_d2]: V(False)
+
+  prim_subreg #(
+      .DW      (32),
+      .SWACCESS("RW"),
+      .RESVAL  (32'h0)
+  ) u_src_stride_d2 (
+      .clk_i (clk_i),
+      .rst_ni(rst_ni),
+
+      // from register interface
+      .we(src_stride_d2_we),
+      .wd(src_stride_d2_wd),
+
+      // from internal hardware
+      .de(hw2reg.src_stride_d2.de),
+      .d (hw2reg.src_stride_d2.d),
+
+      // to internal hardware
+      .qe(),
+      .q (reg2hw.src_stride_d2.q),
+
+      // to register interface (read)
+      .qs(src_stride_d2_qs)
+  );
+
+
+  // R[src_stride_d3]: V(False)
+
+  prim_subreg #(
+      .DW      (32),
+      .SWACCESS("RW"),
+      .RESVAL  (32'h0)
+  ) u_src_stride_d3 (
+      .clk_i (clk_i),
+      .rst_ni(rst_ni),
+
+      // from register interface
+      .we(src_stride_d3_we),
+      .wd(src_stride_d3_wd),
+
+      // from internal hardware
+      .de(hw2reg.src_stride_d3.de),
+      .d (hw2reg.src_stride_d3.d),
+
+      // to internal hardware
+      .qe(),
+      .q (reg2hw.src_stride_d3.q),
+
+      // to register interface (read)
+      .qs(src_stride_d3_qs)
+  );
+
+
+  // R[dst_stride_d2]: V(False)
+
+  prim_subreg #(
+      .DW      (32),
+      .SWACCESS("RW"),
+      .RESVAL  (32'h0)
+  ) u_dst_stride_d2 (
+      .clk_i (clk_i),
+      .rst_ni(rst_ni),
+
+      // from register interface
+      .we(dst_stride_d2_we),
+      .wd(dst_stride_d2_wd),
+
+      // from internal hardware
+      .de(hw2reg.dst_stride_d2.de),
+      .d (hw2reg.dst_stride_d2.d),
+
+      // to internal hardware
+      .qe(),
+      .q (reg2hw.dst_stride_d2.q),
+
+      // to register interface (read)
+      .qs(dst_stride_d2_qs)
+  );
+
+
+  // R[dst_stride_d3]: V(False)
+
+  prim_subreg #(
+      .DW      (32),
+      .SWACCESS("RW"),
+      .RESVAL  (32'h0)
+  ) u_dst_stride_d3 (
+      .clk_i (clk_i),
+      .rst_ni(rst_ni),
+
+      // from register interface
+      .we(dst_stride_d3_we),
+      .wd(dst_stride_d3_wd),
+
+      // from internal hardware
+      .de(hw2reg.dst_stride_d3.de),
+      .d (hw2reg.dst_stride_d3.d),
+
+      // to internal hardware
+      .qe(),
+      .q (reg2hw.dst_stride_d3.q),
+
+      // to register interface (read)
+      .qs(dst_stride_d3_qs)
+  );
+
+
+  // R[desc_ptr]: V(False)
+
+  prim_subreg #(
+      .DW      (32),
+      .SWACCESS("RW"),
+      .RESVAL  (32'h0)
+  ) u_desc_ptr (
+      .clk_i (clk_i),
+      .rst_ni(rst_ni),
+
+      // from register interface
+      .we(desc_ptr_we),
+      .wd(desc_ptr_wd),
+
+      // from internal hardware
+      .de(hw2reg.desc_ptr.de),
+      .d (hw2reg.desc_ptr.d),
+
+      // to internal hardware
+      .qe(reg2hw.desc_ptr.qe),
+      .q (reg2hw.desc_ptr.q),
+
+      // to register interface (read)
+      .qs(desc_ptr_qs)
+  );
+
+
 
 
-  logic [11:0] addr_hit;
+  logic [19:0] addr_hit;
   always_comb begin
     addr_hit = '0;
     addr_hit[0] = (reg_addr == DMA_SRC_PTR_OFFSET);
@@ -540,6 +797,14 @@ module dma_reg_top #(
     addr_hit[9] = (reg_addr == DMA_WINDOW_SIZE_OFFSET);
     addr_hit[10] = (reg_addr == DMA_WINDOW_COUNT_OFFSET);
     addr_hit[11] = (reg_addr == DMA_INTERRUPT_EN_OFFSET);
+    addr_hit[12] = (reg_addr == DMA_CH_PRIORITY_OFFSET);
+    addr_hit[13] = (reg_addr == DMA_SIZE_D2_OFFSET);
+    addr_hit[14] = (reg_addr == DMA_SIZE_D3_OFFSET);
+    addr_hit[15] = (reg_addr == DMA_SRC_STRIDE_D2_OFFSET);
+    addr_hit[16] = (reg_addr == DMA_SRC_STRIDE_D3_OFFSET);
+    addr_hit[17] = (reg_addr == DMA_DST_STRIDE_D2_OFFSET);
+    addr_hit[18] = (reg_addr == DMA_DST_STRIDE_D3_OFFSET);
+    addr_hit[19] = (reg_addr == DMA_DESC_PTR_OFFSET);
   end
 
   assign addrmiss = (reg_re || reg_we) ? ~|addr_hit : 1'b0;
@@ -558,7 +823,15 @@ module dma_reg_top #(
                (addr_hit[ 8] & (|(DMA_PERMIT[ 8] & ~reg_be))) |
                (addr_hit[ 9] & (|(DMA_PERMIT[ 9] & ~reg_be))) |
                (addr_hit[10] & (|(DMA_PERMIT[10] & ~reg_be))) |
-               (addr_hit[11] & (|(DMA_PERMIT[11] & ~reg_be)))));
+               (addr_hit[11] & (|(DMA_PERMIT[11] & ~reg_be))) |
+               (addr_hit[12] & (|(DMA_PERMIT[12] & ~reg_be))) |
+               (addr_hit[13] & (|(DMA_PERMIT[13] & ~reg_be))) |
+               (addr_hit[14] & (|(DMA_PERMIT[14] & ~reg_be))) |
+               (addr_hit[15] & (|(DMA_PERMIT[15] & ~reg_be))) |
+               (addr_hit[16] & (|(DMA_PERMIT[16] & ~reg_be))) |
+               (addr_hit[17] & (|(DMA_PERMIT[17] & ~reg_be))) |
+               (addr_hit[18] & (|(DMA_PERMIT[18] & ~reg_be))) |
+               (addr_hit[19] & (|(DMA_PERMIT[19] & ~reg_be)))));
   end
 
   assign src_ptr_we = addr_hit[0] & reg_we & !reg_error;
@@ -577,6 +850,8 @@ module dma_reg_top #(
 
   assign status_window_done_re = addr_hit[4] & reg_re & !reg_error;
 
+  assign status_transaction_done_re = addr_hit[4] & reg_re & !reg_error;
+
   assign ptr_inc_src_ptr_inc_we = addr_hit[5] & reg_we & !reg_error;
   assign ptr_inc_src_ptr_inc_wd = reg_wdata[7:0];
 
@@ -604,6 +879,30 @@ module dma_reg_top #(
   assign interrupt_en_window_done_we = addr_hit[11] & reg_we & !reg_error;
   assign interrupt_en_window_done_wd = reg_wdata[1];
 
+  assign ch_priority_we = addr_hit[12] & reg_we & !reg_error;
+  assign ch_priority_wd = reg_wdata[2:0];
+
+  assign size_d2_we = addr_hit[13] & reg_we & !reg_error;
+  assign size_d2_wd = reg_wdata[15:0];
+
+  assign size_d3_we = addr_hit[14] & reg_we & !reg_error;
+  assign size_d3_wd = reg_wdata[15:0];
+
+  assign src_stride_d2_we = addr_hit[15] & reg_we & !reg_error;
+  assign src_stride_d2_wd = reg_wdata[31:0];
+
+  assign src_stride_d3_we = addr_hit[16] & reg_we & !reg_error;
+  assign src_stride_d3_wd = reg_wdata[31:0];
+
+  assign dst_stride_d2_we = addr_hit[17] & reg_we & !reg_error;
+  assign dst_stride_d2_wd = reg_wdata[31:0];
+
+  assign dst_stride_d3_we = addr_hit[18] & reg_we & !reg_error;
+  assign dst_stride_d3_wd = reg_wdata[31:0];
+
+  assign desc_ptr_we = addr_hit[19] & reg_we & !reg_error;
+  assign desc_ptr_wd = reg_wdata[31:0];
+
   // Read data return
   always_comb begin
     reg_rdata_next = '0;
@@ -627,6 +926,7 @@ module dma_reg_top #(
       addr_hit[4]: begin
         reg_rdata_next[0] = status_ready_qs;
         reg_rdata_next[1] = status_window_done_qs;
+        reg_rdata_next[2] = status_transaction_done_qs;
       end
 
       addr_hit[5]: begin
@@ -660,6 +960,38 @@ module dma_reg_top #(
         reg_rdata_next[1] = interrupt_en_window_done_qs;
       end
 
+      addr_hit[12]: begin
+        reg_rdata_next[2:0] = ch_priority_qs;
+      end
+
+      addr_hit[13]: begin
+        reg_rdata_next[15:0] = size_d2_qs;
+      end
+
+      addr_hit[14]: begin
+        reg_rdata_next[15:0] = size_d3_qs;
+      end
+
+      addr_hit[15]: begin
+        reg_rdata_next[31:0] = src_stride_d2_qs;
+      end
+
+      addr_hit[16]: begin
+        reg_rdata_next[31:0] = src_stride_d3_qs;
+      end
+
+      addr_hit[17]: begin
+        reg_rdata_next[31:0] = dst_stride_d2_qs;
+      end
+
+      addr_hit[18]: begin
+        reg_rdata_next[31:0] = dst_stride_d3_qs;
+      end
+
+      addr_hit[19]: begin
+        reg_rdata_next[31:0] = desc_ptr_qs;
+      end
+
       default: begin
         reg_rdata_next = '1;
       end
@@ -681,7 +1013,7 @@ module dma_reg_top #(
 endmodule
 
 module dma_reg_top_intf #(
-    parameter  int AW = 6,
+    parameter  int AW = 7,
     localparam int DW = 32
 ) (
     input logic clk_i,
@@ -71,4 +71,7 @@ module soc_ctrl #(
   assign use_spimemio_o = reg2hw.use_spimemio.q;
   assign enable_spi_sel = reg2hw.enable_spi_sel.q;
 
+  // reg2hw.host_call is not used by the hardware, the writes to HOST_CALL are
+  // served by the simulation testbench (tb_util.svh)
+
 endmodule : soc_ctrl
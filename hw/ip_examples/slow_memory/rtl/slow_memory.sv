@@ -42,7 +42,7 @@ module slow_memory #(
   logic [          3:0] mem_be;
 
   logic rvalid_n, rvalid_q;
-  logic [4:0] counter_n, counter_q;
+  logic [15:0] counter_n, counter_q;
 
   typedef enum logic {
     READY,
@@ -53,6 +53,28 @@ module slow_memory #(
 
   int random1, random2;
 
+`ifdef VERILATOR
+  // The grants and the latencies come from the C++ model of tb/tb_slowmem.cpp,
+  // seeded and configured by the testbench. The decision for the next cycle is
+  // taken with the request and the grant of this one.
+  import "DPI-C" function void tb_slow_memory_tick(
+    input bit rst_n,
+    input bit req,
+    input bit gnt,
+    output bit gnt_next,
+    output int latency
+  );
+
+  bit gnt_next;
+  int latency;
+
+  always_ff @(posedge clk_i) begin
+    tb_slow_memory_tick(rst_ni, req_i && state_q == READY, gnt_o, gnt_next, latency);
+    random1 <= {31'b0, gnt_next};
+    random2 <= latency - 2;
+  end
+`endif
+
   always_ff @(posedge clk_i or negedge rst_ni) begin : proc_
     if (~rst_ni) begin
       counter_q <= '0;
@@ -64,8 +86,10 @@ module slow_memory #(
       mem_wdata_q <= '0;
       mem_be_q <= '0;
     end else begin
+`ifndef VERILATOR
       random1 <= $random();
       random2 <= $random();
+`endif
       counter_q <= counter_n;
       rvalid_q <= rvalid_n;
       state_q <= state_n;
@@ -93,7 +117,11 @@ module slow_memory #(
           gnt_o = random1[0];
           if (gnt_o) begin
             state_n   = WAIT_RVALID;
+`ifndef VERILATOR
             counter_n = random2[4:0] + 1;
+`else
+            counter_n = random2[15:0] + 1;
+`endif
             mem_req_n <= req_i;
             mem_we_n <= we_i;
             mem_addr_n <= addr_i;
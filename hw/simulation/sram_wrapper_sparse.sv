@@ -0,0 +1,72 @@
+// Copyright EPFL contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Simulation-only SRAM whose content lives in the C++ page store of
+// tb/tb_sram.cpp (SparseSram): the pages are allocated on the first write,
+// so large memory configurations cost no model size nor build time.
+// Selected with FUSESOC_FLAGS="--flag=sparse_sram" (Verilator only).
+// Words never written read as 0.
+
+module sram_wrapper #(
+    parameter int unsigned NumWords = 32'd1024,  // Number of Words in data array
+    parameter int unsigned DataWidth = 32'd32,  // Data signal width
+    // DEPENDENT PARAMETERS, DO NOT OVERWRITE!
+    parameter int unsigned AddrWidth = (NumWords > 32'd1) ? $clog2(NumWords) : 32'd1
+) (
+    input logic clk_i,
+    input logic rst_ni,
+    // input ports
+    input logic req_i,
+    input logic we_i,
+    input logic [AddrWidth-1:0] addr_i,
+    input logic [31:0] wdata_i,
+    input logic [3:0] be_i,
+    input logic set_retentive_ni,
+    // output ports
+    output logic [31:0] rdata_o
+);
+
+  import "DPI-C" function chandle tb_sparse_sram_create(
+    input string scope,
+    input int num_words
+  );
+  import "DPI-C" function int tb_sparse_sram_read(
+    input chandle mem,
+    input int addr
+  );
+  import "DPI-C" function void tb_sparse_sram_write(
+    input chandle mem,
+    input int addr,
+    input int wdata,
+    input int be
+  );
+  import "DPI-C" function void tb_sparse_sram_load(
+    input chandle mem,
+    input int addr,
+    input int data
+  );
+
+  chandle mem;
+  logic [31:0] rdata_q;
+
+  initial begin
+    mem = tb_sparse_sram_create($sformatf("%m"), NumWords);
+  end
+
+  // same timing as tc_sram: the read data comes one cycle after the request
+  always_ff @(posedge clk_i) begin
+    if (req_i) begin
+      if (we_i) tb_sparse_sram_write(mem, int'(addr_i), wdata_i, int'(be_i));
+      else rdata_q <= tb_sparse_sram_read(mem, int'(addr_i));
+    end
+  end
+
+  assign rdata_o = rdata_q;
+
+  // backdoor of tb_loadHEX, not counted as an access
+  function void tb_write_word(input int addr, input logic [31:0] data);
+    tb_sparse_sram_load(mem, addr, data);
+  endfunction
+
+endmodule
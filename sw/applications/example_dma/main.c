@@ -17,11 +17,22 @@
 #define TEST_WINDOW
 #define TEST_ADDRESS_MODE
 #define TEST_ADDRESS_MODE_EXTERNAL_DEVICE
+#define TEST_THROUGHPUT
+#define TEST_2D_TILE
+#define TEST_LINKED_LIST
+#define TEST_RELAUNCH
 
 #define TEST_DATA_SIZE      16
 #define TEST_DATA_LARGE     1024
 #define TRANSACTIONS_N      3       // Only possible to perform transaction at a time, others should be blocked
 #define TEST_WINDOW_SIZE_DU  1024    // if put at <=71 the isr is too slow to react to the interrupt
+#define TEST_THROUGHPUT_RUNS 4       // Copies of TEST_DATA_LARGE words averaged by the throughput test
+#define TEST_RELAUNCH_RUNS  8       // Launches averaged by the relaunch test, alternating two destinations
+#define TEST_MATRIX_COLS    32      // TEST_DATA_LARGE words seen as a matrix of 32 columns by the tile test
+#define TEST_TILE_ROW       3       // Position and size of the tile copied in one transaction
+#define TEST_TILE_COL       5
+#define TEST_TILE_ROWS      4
+#define TEST_TILE_COLS      6
 
 
 
@@ -399,6 +410,255 @@ int main(int argc, char *argv[])
 
 #endif // TEST_WINDOW
 
+#ifdef TEST_THROUGHPUT
+
+    PRINTF("\n\n\r===================================\n\n\r");
+    PRINTF("    TESTING THROUGHPUT   ");
+    PRINTF("\n\n\r===================================\n\n\r");
+
+    for (uint32_t i = 0; i < TEST_DATA_LARGE; i++) {
+        test_data_large [i] = ~i;
+        copied_data_4B  [i] = 0;
+    }
+
+    tgt_src.ptr     = test_data_large;
+    tgt_src.size_du = TEST_DATA_LARGE;
+
+    trans.win_du    = 0;
+    trans.mode      = DMA_TRANS_MODE_SINGLE;
+    trans.end       = DMA_TRANS_END_POLLING; // Polling, so the interrupts do not add to the cycles
+
+    res = dma_validate_transaction( &trans, DMA_ENABLE_REALIGN, DMA_PERFORM_CHECKS_INTEGRITY );
+    PRINTF("tran: %u \t%s\n\r", res, res == DMA_CONFIG_OK ?  "Ok!" : "Error!");
+
+    // Only the copy is measured, from the launch until the DMA is ready again.
+    // The launch itself (the register write of dma_launch) is included.
+    uint32_t copy_cycles = 0;
+    uint32_t start_cycles, end_cycles;
+
+    CSR_CLEAR_BITS(CSR_REG_MCOUNTINHIBIT, 0x1);
+
+    for( uint8_t i = 0; i < TEST_THROUGHPUT_RUNS; i++ ){
+        dma_load_transaction(&trans);
+        CSR_READ(CSR_REG_MCYCLE, &start_cycles);
+        dma_launch(&trans);
+        while( ! dma_is_ready() );
+        CSR_READ(CSR_REG_MCYCLE, &end_cycles);
+        copy_cycles += end_cycles - start_cycles;
+    }
+
+    for(uint32_t i = 0; i < TEST_DATA_LARGE; i++ ) {
+        if (copied_data_4B[i] != test_data_large[i]) {
+            PRINTF("[%d] %04x\tvs.\t%04x\n\r", i, copied_data_4B[i], test_data_large[i]);
+            errors++;
+        }
+    }
+
+    // Bytes per cycle with two decimals, the sustained maximum is 4 (one word per cycle).
+    // The result is printed also in simulation, where the benchmark is run.
+    uint32_t bytes_per_cycle_x100 = (uint32_t)( ( (uint64_t)trans.size_b * TEST_THROUGHPUT_RUNS * 100 ) / copy_cycles );
+    printf("%d bytes in %d cycles (dma_launch included): %d.%02d bytes/cycle\n\r", trans.size_b * TEST_THROUGHPUT_RUNS, copy_cycles,
+           bytes_per_cycle_x100 / 100, bytes_per_cycle_x100 % 100);
+
+    if (errors == 0) {
+        PRINTF("DMA throughput success\n\r");
+    } else {
+        PRINTF("DMA throughput failure: %d errors out of %d words checked\n\r", errors, TEST_DATA_LARGE);
+        return EXIT_FAILURE;
+    }
+
+#endif // TEST_THROUGHPUT
+
+#ifdef TEST_2D_TILE
+
+    PRINTF("\n\n\r===================================\n\n\r");
+    PRINTF("    TESTING 2D TILE   ");
+    PRINTF("\n\n\r===================================\n\n\r");
+
+    for (uint32_t i = 0; i < TEST_DATA_LARGE; i++) {
+        test_data_large [i] = i;
+        copied_data_4B  [i] = 0;
+    }
+
+    /* The source is a tile inside a matrix: rows of TEST_TILE_COLS words,
+    TEST_MATRIX_COLS words apart. The destination gets the rows packed. */
+    dma_target_t tgt_tile = {
+                                .ptr          = &test_data_large[TEST_TILE_ROW * TEST_MATRIX_COLS + TEST_TILE_COL],
+                                .inc_du       = 1,
+                                .size_du      = TEST_TILE_COLS,
+                                .size_d2      = TEST_TILE_ROWS,
+                                .stride_d2_du = TEST_MATRIX_COLS,
+                                .trig         = DMA_TRIG_MEMORY,
+                                .type         = DMA_DATA_TYPE_WORD,
+                                };
+
+    tgt_dst.ptr         = copied_data_4B;
+    trans.src           = &tgt_tile;
+    trans.win_du        = 0;
+    trans.mode          = DMA_TRANS_MODE_SINGLE;
+    trans.end           = DMA_TRANS_END_POLLING;
+
+    res = dma_validate_transaction( &trans, DMA_ENABLE_REALIGN, DMA_PERFORM_CHECKS_INTEGRITY );
+    PRINTF("tran: %u \t%s\n\r", res, res == DMA_CONFIG_OK ?  "Ok!" : "Error!");
+    res = dma_load_transaction(&trans);
+    PRINTF("load: %u \t%s\n\r", res, res == DMA_CONFIG_OK ?  "Ok!" : "Error!");
+    res = dma_launch(&trans);
+    PRINTF("laun: %u \t%s\n\r", res, res == DMA_CONFIG_OK ?  "Ok!" : "Error!");
+
+    while( ! dma_is_ready() );
+
+    for(uint32_t r = 0; r < TEST_TILE_ROWS; r++ ) {
+        for(uint32_t c = 0; c < TEST_TILE_COLS; c++ ) {
+            uint32_t expected = ( TEST_TILE_ROW + r ) * TEST_MATRIX_COLS + TEST_TILE_COL + c;
+            if (copied_data_4B[r * TEST_TILE_COLS + c] != expected) {
+                PRINTF("[%d][%d] %04x\tvs.\t%04x\n\r", r, c, copied_data_4B[r * TEST_TILE_COLS + c], expected);
+                errors++;
+            }
+        }
+    }
+    // Nothing written after the tile
+    if (copied_data_4B[TEST_TILE_ROWS * TEST_TILE_COLS] != 0) {
+        errors++;
+    }
+
+    if (errors == 0) {
+        PRINTF("DMA 2D tile success\n\r");
+    } else {
+        PRINTF("DMA 2D tile failure: %d errors out of %d words checked\n\r", errors, TEST_TILE_ROWS * TEST_TILE_COLS);
+        return EXIT_FAILURE;
+    }
+
+#endif // TEST_2D_TILE
+
+#ifdef TEST_LINKED_LIST
+
+    PRINTF("\n\n\r===================================\n\n\r");
+    PRINTF("    TESTING LINKED LIST   ");
+    PRINTF("\n\n\r===================================\n\n\r");
+
+    /* Two descriptors swap the halves of the test data: the first half is
+    copied after the second one. The descriptors keep a copy of the
+    transaction, so it can be changed to build the next one. */
+    static dma_desc_t desc[2];
+
+    for (uint32_t i = 0; i < TEST_DATA_SIZE; i++) {
+        copied_data_4B[i] = 0;
+    }
+
+    tgt_src.ptr         = test_data_4B;
+    tgt_src.size_du     = TEST_DATA_SIZE / 2;
+    tgt_dst.ptr         = &copied_data_4B[TEST_DATA_SIZE / 2];
+    trans.src           = &tgt_src;
+    trans.win_du        = 0;
+    trans.mode          = DMA_TRANS_MODE_SINGLE;
+    trans.end           = DMA_TRANS_END_POLLING;
+
+    res = dma_validate_transaction( &trans, DMA_ENABLE_REALIGN, DMA_PERFORM_CHECKS_INTEGRITY );
+    res |= dma_desc_build( &desc[0], &trans, &desc[1] );
+
+    tgt_src.ptr         = &test_data_4B[TEST_DATA_SIZE / 2];
+    tgt_dst.ptr         = copied_data_4B;
+
+    res |= dma_validate_transaction( &trans, DMA_ENABLE_REALIGN, DMA_PERFORM_CHECKS_INTEGRITY );
+    res |= dma_desc_build( &desc[1], &trans, NULL );
+    PRINTF("desc: %u \t%s\n\r", res, res == DMA_CONFIG_OK ?  "Ok!" : "Error!");
+    res = dma_launch_list( &desc[0], DMA_TRANS_END_POLLING );
+    PRINTF("laun: %u \t%s\n\r", res, res == DMA_CONFIG_OK ?  "Ok!" : "Error!");
+
+    while( ! dma_is_ready() );
+
+    for(uint32_t i = 0; i < TEST_DATA_SIZE; i++ ) {
+        uint32_t expected = test_data_4B[( i + TEST_DATA_SIZE / 2 ) % TEST_DATA_SIZE];
+        if (copied_data_4B[i] != expected) {
+            PRINTF("[%d] %04x\tvs.\t%04x\n\r", i, copied_data_4B[i], expected);
+            errors++;
+        }
+    }
+
+    if (errors == 0) {
+        PRINTF("DMA linked list success\n\r");
+    } else {
+        PRINTF("DMA linked list failure: %d errors out of %d words checked\n\r", errors, TEST_DATA_SIZE);
+        return EXIT_FAILURE;
+    }
+
+#endif // TEST_LINKED_LIST
+
+#ifdef TEST_RELAUNCH
+
+    PRINTF("\n\n\r===================================\n\n\r");
+    PRINTF("    TESTING RELAUNCH   ");
+    PRINTF("\n\n\r===================================\n\n\r");
+
+    /* The same copy is launched TEST_RELAUNCH_RUNS times into two ping-pong
+    buffers, first through validate + load + launch, then compiled once and
+    relaunched. Only the launch cost on the CPU is measured, the copy is
+    waited for outside of it. */
+    uint32_t *pingpong[2] = { copied_data_4B, &copied_data_4B[TEST_DATA_SIZE] };
+    uint32_t full_cycles = 0, relaunch_cycles = 0;
+    uint32_t launch_start, launch_end;
+
+    tgt_src.ptr         = test_data_4B;
+    tgt_src.size_du     = TEST_DATA_SIZE;
+    trans.src           = &tgt_src;
+    trans.win_du        = 0;
+    trans.mode          = DMA_TRANS_MODE_SINGLE;
+    trans.end           = DMA_TRANS_END_POLLING;
+
+    CSR_CLEAR_BITS(CSR_REG_MCOUNTINHIBIT, 0x1);
+
+    for( uint8_t i = 0; i < TEST_RELAUNCH_RUNS; i++ ){
+        tgt_dst.ptr = pingpong[i & 1];
+        CSR_READ(CSR_REG_MCYCLE, &launch_start);
+        dma_validate_transaction( &trans, DMA_ENABLE_REALIGN, DMA_PERFORM_CHECKS_INTEGRITY );
+        dma_load_transaction(&trans);
+        dma_launch(&trans);
+        CSR_READ(CSR_REG_MCYCLE, &launch_end);
+        full_cycles += launch_end - launch_start;
+        while( ! dma_is_ready() );
+    }
+
+    for (uint32_t i = 0; i < 2 * TEST_DATA_SIZE; i++) {
+        copied_data_4B[i] = 0;
+    }
+
+    dma_trans_image_t img;
+    dma_ch_t *ch = dma_channel(0);
+
+    res = dma_compile_transaction( &img, &trans, DMA_ENABLE_REALIGN, DMA_PERFORM_CHECKS_INTEGRITY );
+    PRINTF("comp: %u \t%s\n\r", res, res == DMA_CONFIG_OK ?  "Ok!" : "Error!");
+    res = dma_ch_load_image( ch, &img );
+    PRINTF("load: %u \t%s\n\r", res, res == DMA_CONFIG_OK ?  "Ok!" : "Error!");
+
+    for( uint8_t i = 0; i < TEST_RELAUNCH_RUNS; i++ ){
+        CSR_READ(CSR_REG_MCYCLE, &launch_start);
+        img.dst_ptr = (uint32_t)pingpong[i & 1];
+        dma_ch_relaunch( ch, &img );
+        CSR_READ(CSR_REG_MCYCLE, &launch_end);
+        relaunch_cycles += launch_end - launch_start;
+        while( ! dma_ch_is_ready(ch) );
+    }
+
+    for(uint32_t i = 0; i < 2 * TEST_DATA_SIZE; i++ ) {
+        if (copied_data_4B[i] != test_data_4B[i % TEST_DATA_SIZE]) {
+            PRINTF("[%d] %04x\tvs.\t%04x\n\r", i, copied_data_4B[i], test_data_4B[i % TEST_DATA_SIZE]);
+            errors++;
+        }
+    }
+
+    // Printed also in simulation, like the throughput
+    printf("Launch cost: %d cycles (validate + load + launch), %d cycles (relaunch)\n\r",
+           full_cycles / TEST_RELAUNCH_RUNS, relaunch_cycles / TEST_RELAUNCH_RUNS);
+
+    if (errors == 0) {
+        PRINTF("DMA relaunch success\n\r");
+    } else {
+        PRINTF("DMA relaunch failure: %d errors out of %d words checked\n\r", errors, 2 * TEST_DATA_SIZE);
+        return EXIT_FAILURE;
+    }
+
+#endif // TEST_RELAUNCH
+
 
     return EXIT_SUCCESS;
 }
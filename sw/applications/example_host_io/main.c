@@ -0,0 +1,58 @@
+// Copyright EPFL contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Processes a dataset streamed by the Verilator testbench instead of data
+// compiled in a header: the input is read block by block with host_read()
+// and the energy of each block of 16-bit samples is written back with
+// host_write(). The same image runs any dataset:
+//
+//   ./Vtestharness +firmware=main.hex +host_in=samples.raw +host_out=energy.raw
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "host_call.h"
+#include "x-heep.h"
+
+/* By default, printfs are activated for FPGA and disabled for simulation. */
+#define PRINTF_IN_FPGA  1
+#define PRINTF_IN_SIM   0
+
+#if TARGET_SIM && PRINTF_IN_SIM
+        #define PRINTF(fmt, ...)    printf(fmt, ## __VA_ARGS__)
+#elif TARGET_PYNQ_Z2 && PRINTF_IN_FPGA
+    #define PRINTF(fmt, ...)    printf(fmt, ## __VA_ARGS__)
+#else
+    #define PRINTF(...)
+#endif
+
+#define BLOCK_SAMPLES 256
+
+static int16_t samples[BLOCK_SAMPLES];
+
+int main(int argc, char *argv[])
+{
+    uint32_t blocks = 0;
+    int32_t len;
+
+    while ((len = host_read(samples, sizeof(samples))) > 0) {
+        uint32_t energy = 0;
+        for (int i = 0; i < len / (int32_t)sizeof(int16_t); i++)
+            energy += ((int32_t)samples[i] * samples[i]) >> 8;
+        if (host_write(&energy, sizeof(energy)) != sizeof(energy)) {
+            PRINTF("Cannot write the result of block %u\n\r", blocks);
+            return EXIT_FAILURE;
+        }
+        blocks++;
+    }
+
+    if (len < 0) {
+        // FPGA, other simulators, or no +host_in= given to the testbench
+        PRINTF("No host input stream, nothing to process\n\r");
+        return EXIT_SUCCESS;
+    }
+
+    PRINTF("Processed %u blocks\n\r", blocks);
+    return EXIT_SUCCESS;
+}
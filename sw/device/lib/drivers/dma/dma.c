@@ -175,6 +175,7 @@ static inline uint8_t is_region_outbound(   uint8_t  *p_start,
  * @brief Writes a given value into the specified register. Its operation
  * mimics that of bitfield_field32_write(), but does not require the use of
  * a field structure, that is not always provided in the _regs.h file.
+ * @param p_ch The channel whose register is written.
  * @param p_val The value to be written.
  * @param p_offset The register's offset from the peripheral's base address
  *  where the target register is located.
@@ -183,18 +184,88 @@ static inline uint8_t is_region_outbound(   uint8_t  *p_start,
  * @param p_sel The selection index (i.e. From which bit inside the register
  * the value is to be written).
  */
-static inline void write_register(  uint32_t p_val,
+static inline void write_register(  dma_ch_t *p_ch,
+                                    uint32_t p_val,
                                     uint32_t p_offset,
                                     uint32_t p_mask,
                                     uint8_t  p_sel );
 
 
+/**
+ * @brief Computes the register values of a validated transaction.
+ * @param p_trans A pointer to the transaction.
+ * @param p_img A pointer to the image where the values are stored.
+ */
+static inline void pack_transaction( dma_trans_t       *p_trans,
+                                     dma_trans_image_t *p_img );
+
+/**
+ * @brief Writes the registers of an image into a channel, except the size
+ * (that launches the transaction), and enables its interrupts.
+ * @param p_ch The channel.
+ * @param p_img A pointer to the image to write.
+ */
+static inline void write_image( dma_ch_t          *p_ch,
+                                dma_trans_image_t *p_img );
+
+/**
+ * @brief Enables the interrupts of a channel for the given end event, and
+ * disables the DMA interrupts in the CPU if no channel uses them.
+ * @param p_ch The channel.
+ * @param p_end The end event of the transaction or list to launch.
+ * @param p_window Whether the window interrupt is used.
+ */
+static inline void set_interrupts( dma_ch_t            *p_ch,
+                                   dma_trans_end_evt_t p_end,
+                                   uint8_t             p_window );
+
 /**
  * @brief Analyzes a target to determine the size of its increment (in bytes).
+ * @param p_trans A pointer to the transaction the target belongs to.
  * @param p_tgt A pointer to the target to analyze.
  * @return The number of bytes of the increment.
  */
-static inline uint32_t get_increment_b( dma_target_t * p_tgt );
+static inline uint32_t get_increment_b( dma_trans_t  *p_trans,
+                                        dma_target_t *p_tgt );
+
+/**
+ * @brief Computes the distance between the starts of two rows or two planes
+ * of a target (in bytes), using the defaults if they were not set.
+ * @param p_tgt A pointer to the target.
+ * @param p_dataSize_b The size of the data units of the transfer, in bytes.
+ * @param p_size_du The number of data units of a row.
+ * @param p_size_d2 The number of rows of a plane.
+ * @param p_dim The dimension, 2 for rows or 3 for planes.
+ * @return The stride in bytes, 0 if the target is a peripheral.
+ */
+static inline int32_t get_stride_b( dma_target_t *p_tgt,
+                                    uint8_t      p_dataSize_b,
+                                    uint32_t     p_size_du,
+                                    uint16_t     p_size_d2,
+                                    uint8_t      p_dim );
+
+/**
+ * @brief Computes where the last row of a 2D/3D target starts.
+ * @param p_tgt A pointer to the target.
+ * @param p_dataSize_b The size of the data units of the transfer, in bytes.
+ * @param p_size_du The number of data units of a row.
+ * @param p_size_d2 The number of rows of a plane (at least 1).
+ * @param p_size_d3 The number of planes (at least 1).
+ * @return Pointer to the first byte of the last row.
+ */
+static inline uint8_t* get_last_row_ptr( dma_target_t *p_tgt,
+                                         uint8_t      p_dataSize_b,
+                                         uint32_t     p_size_du,
+                                         uint16_t     p_size_d2,
+                                         uint16_t     p_size_d3 );
+
+/**
+ * @brief Reads the STATUS register of a channel. The done flags are cleared
+ * by the read, so they are kept in the channel until they are handled.
+ * @param p_ch The channel to read.
+ * @return The value of the STATUS register.
+ */
+static inline uint32_t read_status( dma_ch_t *p_ch );
 
 
 /****************************************************************************/
@@ -216,21 +287,10 @@ static inline uint32_t get_increment_b( dma_target_t * p_tgt );
 static struct
 {
     /**
-    * Pointer to the transaction to be performed.
-    */
-    dma_trans_t* trans;
-
-    /**
-    * Flag to lower as soon as a transaction is launched, and raised by the
-    * interrupt handler once it has finished. Only used when the end event is
-    * set to INTR_WAIT.
-    */
-    uint8_t intrFlag;
-
-    /**
-     * memory mapped structure of a DMA.
+     * Control block of each channel. The functions without a channel handle
+     * use the first one.
      */
-    dma *peri;
+    dma_ch_t ch[DMA_CH_NUM];
 
 }dma_cb;
 
@@ -243,45 +303,127 @@ static struct
 
 void handler_irq_dma(uint32_t id)
 {
+    uint8_t i;
+    dma_ch_t *ch;
+
     /*
-     * Call the weak implementation provided in this module,
-     * or the non-weak implementation.
+     * The channels share the interrupt line, the WINDOW_DONE flag tells
+     * which ones have copied a window.
      */
-    dma_intr_handler_window_done();
+    for( i = 0; i < DMA_CH_NUM; i++ )
+    {
+        ch = &dma_cb.ch[i];
+        if( ch->peri == NULL ) continue;
+
+        read_status( ch );
+        if( ch->events & ( 1 << DMA_STATUS_WINDOW_DONE_BIT ) )
+        {
+            ch->events &= ~( 1 << DMA_STATUS_WINDOW_DONE_BIT );
+            /*
+             * Call the weak implementation provided in this module,
+             * or the non-weak implementation.
+             */
+            dma_ch_intr_handler_window_done( ch );
+        }
+    }
 }
 
 void fic_irq_dma(void)
 {
-    /* The flag is raised so the waiting loop can be broken.*/
-    dma_cb.intrFlag = 1;
+    uint8_t i;
+    dma_ch_t *ch;
+    uint32_t status;
 
     /*
-     * Call the weak implementation provided in this module,
-     * or the non-weak implementation.
+     * The channels share the interrupt line, the TRANSACTION_DONE flag tells
+     * which ones have finished. Those polled for are left alone. A channel
+     * that is ready and was not signalled since its launch has finished too,
+     * in case its flag was lost.
      */
-    dma_intr_handler_trans_done();
+    for( i = 0; i < DMA_CH_NUM; i++ )
+    {
+        ch = &dma_cb.ch[i];
+        if(     ( ch->peri == NULL )
+            ||  ( ch->end == DMA_TRANS_END_POLLING ) ) continue;
+
+        status = read_status( ch );
+        if(     ( ch->events & ( 1 << DMA_STATUS_TRANSACTION_DONE_BIT ) )
+            ||  (    ( status & ( 1 << DMA_STATUS_READY_BIT ) )
+                  && ( ch->intrFlag == 0 ) ) )
+        {
+            ch->events &= ~( 1 << DMA_STATUS_TRANSACTION_DONE_BIT );
+            /* The flag is raised so the waiting loop can be broken.*/
+            ch->intrFlag = 1;
+            /*
+             * Call the weak implementation provided in this module,
+             * or the non-weak implementation.
+             */
+            dma_ch_intr_handler_trans_done( ch );
+        }
+    }
 }
 
 void dma_init( dma *peri )
 {
-    /*
-     * If a DMA peripheral was provided, use that one, otherwise use the
-     * integrated one.
-     */
-    dma_cb.peri = peri ? peri : dma_peri;
-
-    /* Clear the loaded transaction */
-    dma_cb.trans = NULL;
-    /* Clear all values in the DMA registers. */
-    dma_cb.peri->SRC_PTR       = 0;
-    dma_cb.peri->DST_PTR       = 0;
-    dma_cb.peri->SIZE          = 0;
-    dma_cb.peri->PTR_INC       = 0;
-    dma_cb.peri->SLOT          = 0;
-    dma_cb.peri->DATA_TYPE     = 0;
-    dma_cb.peri->MODE          = 0;
-    dma_cb.peri->WINDOW_SIZE   = 0;
-    dma_cb.peri->INTERRUPT_EN  = 0;
+    uint8_t i;
+    dma_ch_t *ch;
+
+    for( i = 0; i < DMA_CH_NUM; i++ )
+    {
+        ch = &dma_cb.ch[i];
+        ch->id = i;
+
+        /*
+         * If a DMA peripheral was provided, use that one as the only channel,
+         * otherwise use the channels of the integrated one.
+         */
+        if( peri )
+        {
+            ch->peri = i == 0 ? peri : NULL;
+        }
+        else
+        {
+            ch->peri = (dma *)( (uint8_t *)dma_peri + i * DMA_CH_SIZE );
+        }
+
+        /* Clear the loaded transaction */
+        ch->trans    = NULL;
+        ch->events   = 0;
+        ch->end      = DMA_TRANS_END_POLLING;
+        /* Nothing launched, so nothing to signal. */
+        ch->intrFlag = 1;
+
+        if( ch->peri == NULL ) continue;
+
+        /* Clear all values in the DMA registers. */
+        ch->peri->SRC_PTR       = 0;
+        ch->peri->DST_PTR       = 0;
+        ch->peri->SIZE          = 0;
+        ch->peri->PTR_INC       = 0;
+        ch->peri->SLOT          = 0;
+        ch->peri->DATA_TYPE     = 0;
+        ch->peri->MODE          = 0;
+        ch->peri->WINDOW_SIZE   = 0;
+        ch->peri->INTERRUPT_EN  = 0;
+        ch->peri->CH_PRIORITY   = 0;
+        ch->peri->SIZE_D2       = 0;
+        ch->peri->SIZE_D3       = 0;
+        ch->peri->SRC_STRIDE_D2 = 0;
+        ch->peri->SRC_STRIDE_D3 = 0;
+        ch->peri->DST_STRIDE_D2 = 0;
+        ch->peri->DST_STRIDE_D3 = 0;
+        ch->peri->DESC_PTR      = 0;
+    }
+}
+
+dma_ch_t* dma_channel( uint8_t p_ch )
+{
+    if(     ( p_ch >= DMA_CH_NUM )
+        ||  ( dma_cb.ch[p_ch].peri == NULL ) )
+    {
+        return NULL;
+    }
+    return &dma_cb.ch[p_ch];
 }
 
 dma_config_flags_t dma_validate_transaction(    dma_trans_t        *p_trans,
@@ -381,6 +523,22 @@ dma_config_flags_t dma_validate_transaction(    dma_trans_t        *p_trans,
         }
     }
 
+    /*
+     * In address mode each data unit goes to the address read from the
+     * address port, so there are no destination rows. The DMA only does 1D
+     * transfers in this mode.
+     */
+    if( p_check )
+    {
+        if(    p_trans->mode == DMA_TRANS_MODE_ADDRESS
+            && ( p_trans->src->size_d2 > 1 || p_trans->src->size_d3 > 1 ) )
+        {
+            p_trans->flags |= DMA_CONFIG_INCOMPATIBLE;
+            p_trans->flags |= DMA_CONFIG_CRITICAL_ERROR;
+            return p_trans->flags;
+        }
+    }
+
     /*
      * SET UP THE DEFAULT CONFIGURATIONS
      */
@@ -391,6 +549,10 @@ dma_config_flags_t dma_validate_transaction(    dma_trans_t        *p_trans,
     transformed to bytes, to be used as default size.*/
     uint8_t dataSize_b = DMA_DATA_TYPE_2_SIZE(p_trans->src->type);
     p_trans->size_b = p_trans->src->size_du * dataSize_b;
+    /* The source also defines the number of rows and planes (0 is taken as a
+    single one). The size in bytes is then the size of each row. */
+    p_trans->size_d2 = p_trans->src->size_d2 ? p_trans->src->size_d2 : 1;
+    p_trans->size_d3 = p_trans->src->size_d3 ? p_trans->src->size_d3 : 1;
     /* By default, the source defines the data type.*/
     p_trans->type = p_trans->src->type;
     /*
@@ -562,9 +724,17 @@ dma_config_flags_t dma_validate_transaction(    dma_trans_t        *p_trans,
          * No further operations are done to prevent corrupting information
          * that could be useful for debugging purposes.
          */
+        /*
+         * For a 2D/3D transaction the last row written is checked, assuming
+         * the strides are positive (the rows go forward).
+         */
         uint8_t isEnv = (p_trans->dst->env != NULL);
         uint8_t isOutb = is_region_outbound(
-                                    p_trans->dst->ptr,
+                                    get_last_row_ptr( p_trans->dst,
+                                                      dataSize_b,
+                                                      p_trans->src->size_du,
+                                                      p_trans->size_d2,
+                                                      p_trans->size_d3 ),
                                     p_trans->dst->env->end,
                                     p_trans->type,
                                     p_trans->src->size_du,
@@ -591,7 +761,10 @@ dma_config_flags_t dma_validate_transaction(    dma_trans_t        *p_trans,
          * this would not cause any error, the transaction is rejected because
          * it is likely a mistake.
          */
-        if( p_trans->win_du > p_trans->size_b )
+        uint32_t totalSize_b = p_trans->size_b
+                                * p_trans->size_d2
+                                * p_trans->size_d3;
+        if( p_trans->win_du > totalSize_b )
         {
             p_trans->flags |= DMA_CONFIG_WINDOW_SIZE;
             p_trans->flags |= DMA_CONFIG_CRITICAL_ERROR;
@@ -609,7 +782,7 @@ dma_config_flags_t dma_validate_transaction(    dma_trans_t        *p_trans,
          * certainty that an real error will occur.
          */
         uint32_t threshold = dma_window_ratio_warning_threshold();
-        uint32_t ratio = p_trans->size_b / p_trans->win_du;
+        uint32_t ratio = totalSize_b / p_trans->win_du;
         if(     p_trans->win_du
             &&  threshold
             &&  ( ratio > threshold) )
@@ -624,6 +797,14 @@ dma_config_flags_t dma_validate_transaction(    dma_trans_t        *p_trans,
 
 dma_config_flags_t dma_load_transaction( dma_trans_t *p_trans )
 {
+    return dma_ch_load_transaction( &dma_cb.ch[0], p_trans );
+}
+
+dma_config_flags_t dma_ch_load_transaction( dma_ch_t    *p_ch,
+                                            dma_trans_t *p_trans )
+{
+    dma_trans_image_t img;
+
     /*
      * CHECK FOR CRITICAL ERRORS
      */
@@ -635,7 +816,7 @@ dma_config_flags_t dma_load_transaction( dma_trans_t *p_trans )
      */
     if( p_trans->flags & DMA_CONFIG_CRITICAL_ERROR )
     {
-        dma_cb.trans = NULL;
+        p_ch->trans = NULL;
         return DMA_CONFIG_CRITICAL_ERROR;
     }
 
@@ -650,168 +831,215 @@ dma_config_flags_t dma_load_transaction( dma_trans_t *p_trans )
      * until it has ended.
      * Transactions can still be validated in the meantime.
      */
-    if( !dma_is_ready() )
+    if( !dma_ch_is_ready( p_ch ) )
     {
         return DMA_CONFIG_TRANS_OVERRIDE;
     }
 
     /* Save the current transaction */
-    dma_cb.trans = p_trans;
+    p_ch->trans = p_trans;
+    p_ch->end   = p_trans->end;
 
     /*
-     * ENABLE/DISABLE INTERRUPTS
+     * SET THE REGISTERS
      */
+    pack_transaction( p_trans, &img );
+    write_image( p_ch, &img );
+
+    return DMA_CONFIG_OK;
+}
 
+dma_config_flags_t dma_launch( dma_trans_t *p_trans )
+{
+    return dma_ch_launch( &dma_cb.ch[0], p_trans );
+}
+
+dma_config_flags_t dma_ch_launch( dma_ch_t *p_ch, dma_trans_t *p_trans )
+{
     /*
-     * If the selected en event is polling, interrupts are disabled.
-     * Otherwise the mie.MEIE bit is set to one to enable machine-level
-     * fast DMA interrupt.
+     * Make sure that the loaded transaction is the intended transaction.
+     * If the loaded trans was NULL'd, then this the transaction is never
+     * launched.
      */
-    dma_cb.peri->INTERRUPT_EN = INTR_EN_NONE;
-    CSR_CLEAR_BITS(CSR_REG_MIE, DMA_CSR_REG_MIE_MASK );
-
-    if( dma_cb.trans->end != DMA_TRANS_END_POLLING )
+    if(     ( p_trans == NULL )
+        ||  ( p_ch->trans != p_trans ) ) // @ToDo: Check per-element.
     {
-        /* Enable global interrupt for machine-level interrupts. */
-        CSR_SET_BITS(CSR_REG_MSTATUS, 0x8 );
-        /* @ToDo: What does this do? */
-        CSR_SET_BITS(CSR_REG_MIE, DMA_CSR_REG_MIE_MASK );
-
-        dma_cb.peri->INTERRUPT_EN |= INTR_EN_TRANS_DONE;
-
-        /* Only if a window is used should the window interrupt be set. */
-        if( p_trans->win_du > 0 )
-        {
-            dma_cb.peri->INTERRUPT_EN |= INTR_EN_WINDOW_DONE;
-        }
+        return DMA_CONFIG_CRITICAL_ERROR;
     }
 
     /*
-     * SET THE POINTERS
+     * CHECK IF THERE IS A TRANSACTION RUNNING
      */
-    dma_cb.peri->SRC_PTR = (uint32_t)dma_cb.trans->src->ptr;
 
-    if(dma_cb.trans->mode != DMA_TRANS_MODE_ADDRESS)
-    {
-        /*
-        Write to the destination pointers only if we are not in address mode,
-        otherwise the destination address is read in a separate port in parallel with the data
-        from the address port
-        */
-        dma_cb.peri->DST_PTR = (uint32_t)dma_cb.trans->dst->ptr;
-    }
-    else
+    /*
+     * Modifying the DMA registers during the execution of a transaction can be
+     * dangerous.
+     * This is prevented by blocking any modification of the current transaction
+     * until it has ended.
+     * Transactions can still be validated in the meantime.
+     */
+    if( !dma_ch_is_ready( p_ch ) )
     {
-        dma_cb.peri->ADDR_PTR = (uint32_t)dma_cb.trans->src_addr->ptr;
+        return DMA_CONFIG_TRANS_OVERRIDE;
     }
 
     /*
-     * SET THE INCREMENTS
+     * This has to be done prior to writing the register because otherwise
+     * the interrupt could arrive before it is lowered.
+     * The done flags left by the previous transaction are dropped.
      */
+    p_ch->intrFlag = 0;
+    p_ch->events   = 0;
+
+    /* Load the size and start the transaction. */
+    p_ch->peri->SIZE = p_ch->trans->size_b;
 
     /*
-     * The increments might have been changed (vs. the original value of
-     * the target) due to misalignment issues. If they have, use the changed
-     * values, otherwise, use the target-specific ones.
-     * Other reason to overwrite the target increment is if a trigger is used.
-     * In that case, a increment of 0 is necessary.
-     * In case of DMA Address mode transaction, the dst pointer is ignored
-     * as the values read from the second port are instead used.
+     * If the end event was set to wait for the interrupt, the dma_launch
+     * will not return until the interrupt arrives.
      */
+    while(    p_trans->end == DMA_TRANS_END_INTR_WAIT
+          && ( p_ch->intrFlag != 0 ) ) { // @ToDo: add a label for this 0
+        wait_for_interrupt();
+    }
 
-    write_register(  get_increment_b( dma_cb.trans->src ),
-                    DMA_PTR_INC_REG_OFFSET,
-                    DMA_PTR_INC_SRC_PTR_INC_MASK,
-                    DMA_PTR_INC_SRC_PTR_INC_OFFSET );
-
+    return DMA_CONFIG_OK;
+}
 
+dma_config_flags_t dma_compile_transaction( dma_trans_image_t *p_img,
+                                            dma_trans_t       *p_trans,
+                                            dma_en_realign_t  p_enRealign,
+                                            dma_perf_checks_t p_check )
+{
+    dma_config_flags_t flags;
 
-    if(dma_cb.trans->mode != DMA_TRANS_MODE_ADDRESS)
+    flags = dma_validate_transaction( p_trans, p_enRealign, p_check );
+    if( flags & DMA_CONFIG_CRITICAL_ERROR )
     {
-        write_register(  get_increment_b( dma_cb.trans->dst ),
-                        DMA_PTR_INC_REG_OFFSET,
-                        DMA_PTR_INC_DST_PTR_INC_MASK,
-                        DMA_PTR_INC_DST_PTR_INC_OFFSET );
+        return flags;
     }
 
+    pack_transaction( p_trans, p_img );
+    return flags;
+}
+
+dma_config_flags_t dma_load_image( dma_trans_image_t *p_img )
+{
+    return dma_ch_load_image( &dma_cb.ch[0], p_img );
+}
 
+dma_config_flags_t dma_ch_load_image( dma_ch_t          *p_ch,
+                                      dma_trans_image_t *p_img )
+{
     /*
-     * SET THE OPERATION MODE AND WINDOW SIZE
+     * CHECK IF THERE IS A TRANSACTION RUNNING
      */
-
-    dma_cb.peri->MODE = dma_cb.trans->mode;
-    /* The window size is set to the transaction size if it was set to 0 in
-    order to disable the functionality (it will never be triggered). */
-
-    dma_cb.peri->WINDOW_SIZE =   dma_cb.trans->win_du
-                            ? dma_cb.trans->win_du
-                            : dma_cb.trans->size_b;
+    if( !dma_ch_is_ready( p_ch ) )
+    {
+        return DMA_CONFIG_TRANS_OVERRIDE;
+    }
 
     /*
-     * SET TRIGGER SLOTS AND DATA TYPE
+     * The image overwrites the registers of the loaded transaction, it
+     * cannot be launched again.
      */
-    write_register(  dma_cb.trans->src->trig,
-                    DMA_SLOT_REG_OFFSET,
-                    DMA_SLOT_RX_TRIGGER_SLOT_MASK,
-                    DMA_SLOT_RX_TRIGGER_SLOT_OFFSET );
-
-    write_register(  dma_cb.trans->dst->trig,
-                    DMA_SLOT_REG_OFFSET,
-                    DMA_SLOT_TX_TRIGGER_SLOT_MASK,
-                    DMA_SLOT_TX_TRIGGER_SLOT_OFFSET );
+    p_ch->trans = NULL;
+    p_ch->end   = p_img->end;
 
-    write_register(  dma_cb.trans->type,
-                    DMA_DATA_TYPE_REG_OFFSET,
-                    DMA_DATA_TYPE_DATA_TYPE_MASK,
-                    DMA_SELECTION_OFFSET_START );
+    write_image( p_ch, p_img );
 
     return DMA_CONFIG_OK;
 }
 
-dma_config_flags_t dma_launch( dma_trans_t *p_trans )
+dma_config_flags_t dma_desc_build(  dma_desc_t  *p_desc,
+                                    dma_trans_t *p_trans,
+                                    dma_desc_t  *p_next )
 {
+    dma_trans_image_t img;
+
     /*
-     * Make sure that the loaded transaction is the intended transaction.
-     * If the loaded trans was NULL'd, then this the transaction is never
-     * launched.
+     * The transaction must have been validated without critical errors. A
+     * descriptor holds neither the mode, nor the address pointer nor the
+     * window: only single transactions can be part of a list.
      */
-    if(     ( p_trans == NULL )
-        ||  ( dma_cb.trans != p_trans ) ) // @ToDo: Check per-element.
+    if( p_trans->flags & DMA_CONFIG_CRITICAL_ERROR )
     {
         return DMA_CONFIG_CRITICAL_ERROR;
     }
+    if( p_trans->mode != DMA_TRANS_MODE_SINGLE )
+    {
+        return ( DMA_CONFIG_INCOMPATIBLE | DMA_CONFIG_CRITICAL_ERROR );
+    }
 
-    /*
-     * CHECK IF THERE IS A TRANSACTION RUNNING
-     */
+    /* The descriptor holds the same values as the registers. */
+    pack_transaction( p_trans, &img );
+
+    p_desc->next            = (uint32_t)p_next;
+    p_desc->src_ptr         = img.src_ptr;
+    p_desc->dst_ptr         = img.dst_ptr;
+    p_desc->size_b          = img.size_b;
+    p_desc->ctrl            =   img.ptr_inc
+                              | ( img.data_type << DMA_DESC_DATA_TYPE_OFFSET )
+                              | (   ( p_trans->end != DMA_TRANS_END_POLLING )
+                                 << DMA_DESC_IRQ_BIT );
+    p_desc->slot            = img.slot;
+    p_desc->size_d2_d3      =   img.size_d2
+                              | ( img.size_d3 << DMA_DESC_SIZE_D3_OFFSET );
+    p_desc->src_stride_d2   = img.src_stride_d2;
+    p_desc->dst_stride_d2   = img.dst_stride_d2;
+    p_desc->src_stride_d3   = img.src_stride_d3;
+    p_desc->dst_stride_d3   = img.dst_stride_d3;
+
+    return DMA_CONFIG_OK;
+}
+
+dma_config_flags_t dma_launch_list( dma_desc_t          *p_head,
+                                    dma_trans_end_evt_t p_end )
+{
+    return dma_ch_launch_list( &dma_cb.ch[0], p_head, p_end );
+}
+
+dma_config_flags_t dma_ch_launch_list(  dma_ch_t            *p_ch,
+                                        dma_desc_t          *p_head,
+                                        dma_trans_end_evt_t p_end )
+{
+    if( p_head == NULL )
+    {
+        return DMA_CONFIG_CRITICAL_ERROR;
+    }
 
     /*
-     * Modifying the DMA registers during the execution of a transaction can be
-     * dangerous.
-     * This is prevented by blocking any modification of the current transaction
-     * until it has ended.
-     * Transactions can still be validated in the meantime.
+     * CHECK IF THERE IS A TRANSACTION RUNNING
      */
-    if( !dma_is_ready() )
+    if( !dma_ch_is_ready( p_ch ) )
     {
         return DMA_CONFIG_TRANS_OVERRIDE;
     }
 
     /*
-     * This has to be done prior to writing the register because otherwise
-     * the interrupt could arrive before it is lowered.
+     * The descriptors overwrite the registers of the loaded transaction, it
+     * cannot be launched again.
      */
-    dma_cb.intrFlag = 0;
+    p_ch->trans = NULL;
+    p_ch->end   = p_end;
 
-    /* Load the size and start the transaction. */
-    dma_cb.peri->SIZE = dma_cb.trans->size_b;
+    set_interrupts( p_ch, p_end, 0 );
+
+    p_ch->peri->MODE        = DMA_TRANS_MODE_SINGLE;
+    p_ch->peri->WINDOW_SIZE = 0;
+
+    p_ch->intrFlag = 0;
+    p_ch->events   = 0;
+
+    /* Start fetching the first descriptor. */
+    p_ch->peri->DESC_PTR = (uint32_t)p_head;
 
     /*
-     * If the end event was set to wait for the interrupt, the dma_launch
-     * will not return until the interrupt arrives.
+     * The interrupt can be raised by the descriptors in the middle of the
+     * list, so wait for the channel to be done.
      */
-    while(    p_trans->end == DMA_TRANS_END_INTR_WAIT
-          && ( dma_cb.intrFlag != 0 ) ) { // @ToDo: add a label for this 0
+    while(    p_end == DMA_TRANS_END_INTR_WAIT
+          && !dma_ch_is_ready( p_ch ) ) {
         wait_for_interrupt();
     }
 
@@ -819,10 +1047,15 @@ dma_config_flags_t dma_launch( dma_trans_t *p_trans )
 }
 
 
-__attribute__((optimize("O0"))) uint32_t dma_is_ready(void)
+uint32_t dma_is_ready(void)
+{
+    return dma_ch_is_ready( &dma_cb.ch[0] );
+}
+
+__attribute__((optimize("O0"))) uint32_t dma_ch_is_ready( dma_ch_t *p_ch )
 {
     /* The transaction READY bit is read from the status register*/
-    uint32_t ret = ( dma_cb.peri->STATUS & (1<<DMA_STATUS_READY_BIT) );
+    uint32_t ret = ( read_status( p_ch ) & (1<<DMA_STATUS_READY_BIT) );
     return ret;
 }
 /* @ToDo: Reconsider this decision.
@@ -838,17 +1071,34 @@ __attribute__((optimize("O0"))) uint32_t dma_is_ready(void)
 
 uint32_t dma_get_window_count()
 {
-    return dma_cb.peri->WINDOW_COUNT;
+    return dma_ch_get_window_count( &dma_cb.ch[0] );
+}
+
+uint32_t dma_ch_get_window_count( dma_ch_t *p_ch )
+{
+    return p_ch->peri->WINDOW_COUNT;
 }
 
 
 void dma_stop_circular()
+{
+    dma_ch_stop_circular( &dma_cb.ch[0] );
+}
+
+void dma_ch_stop_circular( dma_ch_t *p_ch )
 {
     /*
      * The DMA finishes the current transaction before and does not start
      * a new one.
      */
-    dma_cb.peri->MODE = DMA_TRANS_MODE_SINGLE;
+    p_ch->peri->MODE = DMA_TRANS_MODE_SINGLE;
+}
+
+
+void dma_ch_set_priority( dma_ch_t *p_ch, uint8_t p_priority )
+{
+    /* Only used if the DMA arbitrates the channels by priority. */
+    p_ch->peri->CH_PRIORITY = p_priority & DMA_CH_PRIORITY_CH_PRIORITY_MASK;
 }
 
 
@@ -874,6 +1124,30 @@ __attribute__((weak, optimize("O0"))) void dma_intr_handler_window_done()
      */
 }
 
+__attribute__((weak, optimize("O0"))) void dma_ch_intr_handler_trans_done( dma_ch_t *p_ch )
+{
+    /*
+     * The transaction of the channel has finished!
+     * This is a weak implementation, it calls the handler without channel.
+     * Create your own function called
+     * void dma_ch_intr_handler_trans_done( dma_ch_t *p_ch )
+     * to override this one.
+     */
+    dma_intr_handler_trans_done();
+}
+
+__attribute__((weak, optimize("O0"))) void dma_ch_intr_handler_window_done( dma_ch_t *p_ch )
+{
+    /*
+     * The channel has copied another window.
+     * This is a weak implementation, it calls the handler without channel.
+     * Create your own function called
+     * void dma_ch_intr_handler_window_done( dma_ch_t *p_ch )
+     * to override this one.
+     */
+    dma_intr_handler_window_done();
+}
+
 __attribute__((weak, optimize("O0"))) uint8_t dma_window_ratio_warning_threshold()
 {
     /*
@@ -931,7 +1205,12 @@ dma_config_flags_t validate_target( dma_target_t *p_tgt )
          */
         if( p_tgt->size_du != 0 )
         {
-            uint8_t isOutb = is_region_outbound(  p_tgt->ptr,
+            uint8_t isOutb = is_region_outbound(
+                                          get_last_row_ptr( p_tgt,
+                                                DMA_DATA_TYPE_2_SIZE( p_tgt->type ),
+                                                p_tgt->size_du,
+                                                p_tgt->size_d2 ? p_tgt->size_d2 : 1,
+                                                p_tgt->size_d3 ? p_tgt->size_d3 : 1 ),
                                           p_tgt->env->end,
                                           p_tgt->type,
                                           p_tgt->size_du,
@@ -1100,7 +1379,8 @@ static inline uint8_t is_region_outbound(   uint8_t  *p_start,
 
 /* @ToDo: Consider changing the "mask" parameter for a bitfield definition
 (see dma_regs.h) */
-static inline void write_register( uint32_t  p_val,
+static inline void write_register( dma_ch_t  *p_ch,
+                                  uint32_t  p_val,
                                   uint32_t  p_offset,
                                   uint32_t  p_mask,
                                   uint8_t   p_sel )
@@ -1114,16 +1394,201 @@ static inline void write_register( uint32_t  p_val,
      * An intermediate variable "value" is used to prevent writing twice into
      * the register.
      */
-    uint32_t value  =  (( uint32_t * ) dma_cb.peri ) [ index ];
+    uint32_t value  =  (( uint32_t * ) p_ch->peri ) [ index ];
     value           &= ~( p_mask << p_sel );
     value           |= (p_val & p_mask) << p_sel;
-    (( uint32_t * ) dma_cb.peri ) [ index ] = value;
+    (( uint32_t * ) p_ch->peri ) [ index ] = value;
 
 // @ToDo: mmio_region_write32(dma->base_addr, (ptrdiff_t)(DMA_SLOT_REG_OFFSET), (tx_slot_mask << DMA_SLOT_TX_TRIGGER_SLOT_OFFSET) + rx_slot_mask)
 
 }
 
-static inline uint32_t get_increment_b( dma_target_t * p_tgt )
+static inline void pack_transaction( dma_trans_t       *p_trans,
+                                     dma_trans_image_t *p_img )
+{
+    /*
+     * SET THE POINTERS
+     */
+
+    /*
+     * In address mode the destination pointer is not used, the destination
+     * addresses are read from the address port, starting at ADDR_PTR.
+     */
+    p_img->src_ptr  = (uint32_t)p_trans->src->ptr;
+    p_img->size_b   = p_trans->size_b;
+    if( p_trans->mode != DMA_TRANS_MODE_ADDRESS )
+    {
+        p_img->dst_ptr  = (uint32_t)p_trans->dst->ptr;
+        p_img->addr_ptr = 0;
+    }
+    else
+    {
+        p_img->dst_ptr  = 0;
+        p_img->addr_ptr = (uint32_t)p_trans->src_addr->ptr;
+    }
+
+    /*
+     * SET THE INCREMENTS
+     */
+
+    /*
+     * The increments might have been changed (vs. the original value of
+     * the target) due to misalignment issues. If they have, use the changed
+     * values, otherwise, use the target-specific ones.
+     * Other reason to overwrite the target increment is if a trigger is used.
+     * In that case, a increment of 0 is necessary.
+     * In case of DMA Address mode transaction, the dst pointer is ignored
+     * as the values read from the second port are instead used.
+     */
+    p_img->ptr_inc =  ( get_increment_b( p_trans, p_trans->src )
+                        & DMA_PTR_INC_SRC_PTR_INC_MASK )
+                      << DMA_PTR_INC_SRC_PTR_INC_OFFSET;
+    if( p_trans->mode != DMA_TRANS_MODE_ADDRESS )
+    {
+        p_img->ptr_inc |= ( get_increment_b( p_trans, p_trans->dst )
+                            & DMA_PTR_INC_DST_PTR_INC_MASK )
+                          << DMA_PTR_INC_DST_PTR_INC_OFFSET;
+    }
+
+    /*
+     * SET THE OPERATION MODE AND WINDOW SIZE
+     */
+    p_img->mode     = p_trans->mode;
+    p_img->end      = p_trans->end;
+    p_img->win_intr = p_trans->win_du > 0;
+
+    /* The window size is set to the transaction size if it was set to 0 in
+    order to disable the functionality (it will never be triggered). */
+    p_img->window_size =    p_trans->win_du
+                          ? p_trans->win_du
+                          : p_trans->size_b
+                            * p_trans->size_d2
+                            * p_trans->size_d3;
+
+    /*
+     * SET THE ROWS AND PLANES
+     */
+
+    /*
+     * The strides are given in data units of the source, the same as the
+     * size, so they do not change if the data type was realigned.
+     * For 1D transactions the strides are not used by the DMA.
+     */
+    uint8_t dataSize_b = DMA_DATA_TYPE_2_SIZE( p_trans->src->type );
+
+    p_img->size_d2 = p_trans->size_d2;
+    p_img->size_d3 = p_trans->size_d3;
+
+    p_img->src_stride_d2 = get_stride_b( p_trans->src, dataSize_b,
+                                         p_trans->src->size_du,
+                                         p_trans->size_d2, 2 );
+    p_img->src_stride_d3 = get_stride_b( p_trans->src, dataSize_b,
+                                         p_trans->src->size_du,
+                                         p_trans->size_d2, 3 );
+    p_img->dst_stride_d2 = get_stride_b( p_trans->dst, dataSize_b,
+                                         p_trans->src->size_du,
+                                         p_trans->size_d2, 2 );
+    p_img->dst_stride_d3 = get_stride_b( p_trans->dst, dataSize_b,
+                                         p_trans->src->size_du,
+                                         p_trans->size_d2, 3 );
+
+    /*
+     * SET TRIGGER SLOTS AND DATA TYPE
+     */
+    p_img->slot =     ( ( p_trans->src->trig & DMA_SLOT_RX_TRIGGER_SLOT_MASK )
+                        << DMA_SLOT_RX_TRIGGER_SLOT_OFFSET )
+                    | ( ( p_trans->dst->trig & DMA_SLOT_TX_TRIGGER_SLOT_MASK )
+                        << DMA_SLOT_TX_TRIGGER_SLOT_OFFSET );
+
+    p_img->data_type = p_trans->type & DMA_DATA_TYPE_DATA_TYPE_MASK;
+}
+
+static inline void write_image( dma_ch_t          *p_ch,
+                                dma_trans_image_t *p_img )
+{
+    /*
+     * ENABLE/DISABLE INTERRUPTS
+     */
+    set_interrupts( p_ch, p_img->end, p_img->win_intr );
+
+    /*
+     * Write to the destination pointer only if we are not in address mode,
+     * otherwise the destination address is read in a separate port in
+     * parallel with the data from the address port.
+     */
+    p_ch->peri->SRC_PTR = p_img->src_ptr;
+    if( p_img->mode != DMA_TRANS_MODE_ADDRESS )
+    {
+        p_ch->peri->DST_PTR = p_img->dst_ptr;
+    }
+    else
+    {
+        p_ch->peri->ADDR_PTR = p_img->addr_ptr;
+    }
+
+    p_ch->peri->PTR_INC         = p_img->ptr_inc;
+    p_ch->peri->MODE            = p_img->mode;
+    p_ch->peri->WINDOW_SIZE     = p_img->window_size;
+    p_ch->peri->SIZE_D2         = p_img->size_d2;
+    p_ch->peri->SIZE_D3         = p_img->size_d3;
+    p_ch->peri->SRC_STRIDE_D2   = p_img->src_stride_d2;
+    p_ch->peri->SRC_STRIDE_D3   = p_img->src_stride_d3;
+    p_ch->peri->DST_STRIDE_D2   = p_img->dst_stride_d2;
+    p_ch->peri->DST_STRIDE_D3   = p_img->dst_stride_d3;
+    p_ch->peri->SLOT            = p_img->slot;
+    p_ch->peri->DATA_TYPE       = p_img->data_type;
+}
+
+static inline void set_interrupts( dma_ch_t            *p_ch,
+                                   dma_trans_end_evt_t p_end,
+                                   uint8_t             p_window )
+{
+    uint8_t i;
+    uint8_t intrUsed = 0;
+
+    /*
+     * If the selected en event is polling, interrupts are disabled.
+     * Otherwise the mie.MEIE bit is set to one to enable machine-level
+     * fast DMA interrupt.
+     * The interrupt lines are shared by the channels, they are only disabled
+     * if no other channel uses them.
+     * Nothing is launched yet with these interrupts, so there is nothing to
+     * signal until the next launch lowers the flag.
+     */
+    p_ch->intrFlag           = 1;
+    p_ch->peri->INTERRUPT_EN = INTR_EN_NONE;
+
+    for( i = 0; i < DMA_CH_NUM; i++ )
+    {
+        if( dma_cb.ch[i].peri && dma_cb.ch[i].peri->INTERRUPT_EN )
+        {
+            intrUsed = 1;
+        }
+    }
+    if( !intrUsed )
+    {
+        CSR_CLEAR_BITS(CSR_REG_MIE, DMA_CSR_REG_MIE_MASK );
+    }
+
+    if( p_end != DMA_TRANS_END_POLLING )
+    {
+        /* Enable global interrupt for machine-level interrupts. */
+        CSR_SET_BITS(CSR_REG_MSTATUS, 0x8 );
+        /* @ToDo: What does this do? */
+        CSR_SET_BITS(CSR_REG_MIE, DMA_CSR_REG_MIE_MASK );
+
+        p_ch->peri->INTERRUPT_EN |= INTR_EN_TRANS_DONE;
+
+        /* Only if a window is used should the window interrupt be set. */
+        if( p_window )
+        {
+            p_ch->peri->INTERRUPT_EN |= INTR_EN_WINDOW_DONE;
+        }
+    }
+}
+
+static inline uint32_t get_increment_b( dma_trans_t  *p_trans,
+                                        dma_target_t *p_tgt )
 {
     uint32_t inc_b = 0;
     /* If the target uses a trigger, the increment remains 0. */
@@ -1133,7 +1598,7 @@ static inline uint32_t get_increment_b( dma_target_t * p_tgt )
          * If the transaction increment has been overriden (due to
          * misalignments), then that value is used (it's always set to 1).
          */
-        inc_b = dma_cb.trans->inc_b;
+        inc_b = p_trans->inc_b;
 
         /*
         * Otherwise, the target-specific increment is used transformed into
@@ -1141,13 +1606,79 @@ static inline uint32_t get_increment_b( dma_target_t * p_tgt )
         */
         if( inc_b == 0 )
         {
-            uint8_t dataSize_b = DMA_DATA_TYPE_2_SIZE( dma_cb.trans->type );
+            uint8_t dataSize_b = DMA_DATA_TYPE_2_SIZE( p_trans->type );
             inc_b = ( p_tgt->inc_du * dataSize_b );
         }
     }
     return inc_b;
 }
 
+static inline int32_t get_stride_b( dma_target_t *p_tgt,
+                                    uint8_t      p_dataSize_b,
+                                    uint32_t     p_size_du,
+                                    uint16_t     p_size_d2,
+                                    uint8_t      p_dim )
+{
+    /* If the target uses a trigger, the pointer never moves. */
+    if( p_tgt->trig != DMA_TRIG_MEMORY )
+    {
+        return 0;
+    }
+
+    /* By default the rows are placed one after the other... */
+    int32_t stride_d2_du =  p_tgt->stride_d2_du
+                          ? p_tgt->stride_d2_du
+                          : (int32_t)( p_size_du * p_tgt->inc_du );
+    if( p_dim == 2 )
+    {
+        return stride_d2_du * p_dataSize_b;
+    }
+
+    /* ...and so are the planes. */
+    int32_t stride_d3_du =  p_tgt->stride_d3_du
+                          ? p_tgt->stride_d3_du
+                          : p_size_d2 * stride_d2_du;
+    return stride_d3_du * p_dataSize_b;
+}
+
+static inline uint8_t* get_last_row_ptr( dma_target_t *p_tgt,
+                                         uint8_t      p_dataSize_b,
+                                         uint32_t     p_size_du,
+                                         uint16_t     p_size_d2,
+                                         uint16_t     p_size_d3 )
+{
+    return p_tgt->ptr
+        + ( p_size_d3 - 1 ) * get_stride_b( p_tgt, p_dataSize_b, p_size_du,
+                                            p_size_d2, 3 )
+        + ( p_size_d2 - 1 ) * get_stride_b( p_tgt, p_dataSize_b, p_size_du,
+                                            p_size_d2, 2 );
+}
+
+static inline uint32_t read_status( dma_ch_t *p_ch )
+{
+    uint32_t mstatus;
+    uint32_t status;
+
+    /*
+     * Reading the register clears its done flags. The interrupts are held
+     * until they are saved in the events, otherwise a handler running in
+     * between would find them in neither place and skip the channel. In the
+     * handlers the interrupts are already disabled and stay so.
+     */
+    CSR_READ( CSR_REG_MSTATUS, &mstatus );
+    CSR_CLEAR_BITS( CSR_REG_MSTATUS, 0x8 );
+
+    status = p_ch->peri->STATUS;
+    p_ch->events |= status & (  ( 1 << DMA_STATUS_TRANSACTION_DONE_BIT )
+                              | ( 1 << DMA_STATUS_WINDOW_DONE_BIT ) );
+
+    if( mstatus & 0x8 )
+    {
+        CSR_SET_BITS( CSR_REG_MSTATUS, 0x8 );
+    }
+    return status;
+}
+
 /****************************************************************************/
 /**                                                                        **/
 /*                                 EOF                                      */
@@ -77,6 +77,15 @@ extern "C" {
  */
 #define DMA_DATA_TYPE_2_SIZE(type) (0b00000100 >> (type) )
 
+/**
+ * Fields of the control word of a linked list descriptor. The increments are
+ * placed as in the PTR_INC register, the sizes of the 2nd and 3rd dimensions
+ * share one word the same way.
+ */
+#define DMA_DESC_DATA_TYPE_OFFSET   16
+#define DMA_DESC_IRQ_BIT            31
+#define DMA_DESC_SIZE_D3_OFFSET     16
+
 /****************************************************************************/
 /**                                                                        **/
 /**                       TYPEDEFS AND STRUCTURES                          **/
@@ -288,6 +297,17 @@ typedef struct
     Can be left blank if the target will only be used as destination. */
     dma_trigger_slot_mask_t trig;    /*!< If the target is a peripheral, a
     trigger can be set to control the data flow.  */
+    uint16_t                size_d2; /*!< The number of rows of size_du data
+    units (2nd dimension) to be copied. 0 or 1 for a 1D copy. Like the size,
+    only the one of the source is used. */
+    uint16_t                size_d3; /*!< The number of planes of size_d2 rows
+    (3rd dimension) to be copied. 0 or 1 for a 1D or 2D copy. */
+    int32_t                 stride_d2_du; /*!< Distance (in data units) from the
+    start of a row to the start of the next one. If 0, the rows are placed one
+    after the other (size_du * inc_du). */
+    int32_t                 stride_d3_du; /*!< Distance (in data units) from the
+    start of a plane to the start of the next one. If 0, the planes are placed
+    one after the other (size_d2 * stride_d2_du). */
 } dma_target_t;
 
 /**
@@ -307,7 +327,12 @@ typedef struct
     uint16_t            inc_b;  /*!< A common increment in case both targets
     need to use one same increment. */
     uint32_t            size_b; /*!< The size of the transfer, in bytes (in
-    contrast, the size stored in the targets is in data units). */
+    contrast, the size stored in the targets is in data units). For a 2D/3D
+    transfer, the size of each row. */
+    uint16_t            size_d2; /*!< The number of rows per plane (1 for a 1D
+    transfer). */
+    uint16_t            size_d3; /*!< The number of planes (1 for a 1D or 2D
+    transfer). */
     dma_data_type_t     type;   /*!< The data type to use. One is chosen among
     the targets. */
     dma_trans_mode_t    mode;   /*!< The copy mode to use. */
@@ -320,6 +345,85 @@ typedef struct
     the creation of the transaction. */
 } dma_trans_t;
 
+/**
+ * A channel runs its own transaction with its own registers and interrupts.
+ * The DMA has DMA_CH_NUM channels, that share its bus ports (in turns, or by
+ * priority if DMA_ARB_PRIORITY is defined). Handles are obtained with
+ * dma_channel() once the DMA has been initialized.
+ */
+typedef struct
+{
+    dma*                peri;     /*!< Register bank of the channel. */
+    dma_trans_t*        trans;    /*!< Transaction loaded in the channel. */
+    uint8_t             id;       /*!< Index of the channel. */
+    uint8_t             intrFlag; /*!< Lowered as soon as a transaction is
+    launched, and raised by the interrupt handler once it has finished (it is
+    raised by dma_init()). Used when the end event is set to INTR_WAIT, and by
+    the handler to tell a channel that has finished and was not signalled. */
+    uint32_t            events;   /*!< The TRANSACTION_DONE and WINDOW_DONE
+    flags read from the STATUS register and not yet handled (reading the
+    register clears them). */
+    dma_trans_end_evt_t end;      /*!< The end event of the transaction or
+    linked list launched in the channel. */
+} dma_ch_t;
+
+/**
+ * The register values of a transaction, packed once by
+ * dma_compile_transaction(). It is loaded into a channel without validating
+ * the transaction again, then relaunched with dma_ch_relaunch() by only
+ * writing its pointers and size, which can be changed in between (e.g. to
+ * swap ping-pong buffers).
+ */
+typedef struct
+{
+    uint32_t            src_ptr;        /*!< SRC_PTR register. */
+    uint32_t            dst_ptr;        /*!< DST_PTR register (not used in
+    address mode). */
+    uint32_t            size_b;         /*!< SIZE register, writing it
+    launches the transaction. */
+    uint32_t            addr_ptr;       /*!< ADDR_PTR register (only used in
+    address mode). */
+    uint32_t            ptr_inc;        /*!< PTR_INC register. */
+    uint32_t            slot;           /*!< SLOT register. */
+    uint32_t            data_type;      /*!< DATA_TYPE register. */
+    uint32_t            mode;           /*!< MODE register. */
+    uint32_t            window_size;    /*!< WINDOW_SIZE register. */
+    uint32_t            size_d2;        /*!< SIZE_D2 register. */
+    uint32_t            size_d3;        /*!< SIZE_D3 register. */
+    int32_t             src_stride_d2;  /*!< SRC_STRIDE_D2 register. */
+    int32_t             src_stride_d3;  /*!< SRC_STRIDE_D3 register. */
+    int32_t             dst_stride_d2;  /*!< DST_STRIDE_D2 register. */
+    int32_t             dst_stride_d3;  /*!< DST_STRIDE_D3 register. */
+    dma_trans_end_evt_t end;            /*!< The end event of the
+    transaction. */
+    uint8_t             win_intr;       /*!< Whether the window interrupt is
+    used. */
+} dma_trans_image_t;
+
+/**
+ * A descriptor of a linked list, read by the DMA from memory. Each one holds
+ * a transaction, that is started once the previous one is done, without the
+ * CPU. Descriptors are built from validated transactions with
+ * dma_desc_build(), and must stay in memory until the list is done.
+ */
+typedef struct
+{
+    uint32_t    next;           /*!< Address of the next descriptor, 0 for the
+    last one. */
+    uint32_t    src_ptr;        /*!< SRC_PTR register. */
+    uint32_t    dst_ptr;        /*!< DST_PTR register. */
+    uint32_t    size_b;         /*!< SIZE register. */
+    uint32_t    ctrl;           /*!< PTR_INC register, the data type from
+    DMA_DESC_DATA_TYPE_OFFSET and the interrupt flag in DMA_DESC_IRQ_BIT. */
+    uint32_t    slot;           /*!< SLOT register. */
+    uint32_t    size_d2_d3;     /*!< SIZE_D2 register, and SIZE_D3 from
+    DMA_DESC_SIZE_D3_OFFSET. */
+    int32_t     src_stride_d2;  /*!< SRC_STRIDE_D2 register. */
+    int32_t     dst_stride_d2;  /*!< DST_STRIDE_D2 register. */
+    int32_t     src_stride_d3;  /*!< SRC_STRIDE_D3 register. */
+    int32_t     dst_stride_d3;  /*!< DST_STRIDE_D3 register. */
+} dma_desc_t;
+
 /****************************************************************************/
 /**                                                                        **/
 /**                          EXPORTED VARIABLES                            **/
@@ -348,10 +452,19 @@ void fic_irq_dma(void);
  * transaction can be performed.
  * It can be called anytime to reset the DMA control block.
  * @param peri Pointer to a register address following the dma structure. By
- * default (peri == NULL), the integrated DMA will be used.
+ * default (peri == NULL), the integrated DMA will be used with all its
+ * channels. A peripheral given here is used as a single channel.
  */
 void dma_init( dma *peri );
 
+/**
+ * @brief Gets the handle of a channel. The functions without a channel handle
+ * operate on channel 0.
+ * @param p_ch The index of the channel, from 0 to DMA_CH_NUM-1.
+ * @return The handle of the channel, NULL if the DMA has no such channel.
+ */
+dma_ch_t* dma_channel( uint8_t p_ch );
+
 /**
  * @brief Creates a transaction that can be loaded into the DMA.
  * @param p_trans Pointer to the dma_transaction_t structure where configuration
@@ -383,6 +496,15 @@ dma_config_flags_t dma_validate_transaction(  dma_trans_t       *p_trans,
  */
 dma_config_flags_t dma_load_transaction( dma_trans_t* p_trans );
 
+/**
+ * @brief Same as dma_load_transaction(), on the given channel.
+ * @param p_ch The channel to load the transaction into.
+ * @param p_trans Pointer to the transaction struct to be loaded.
+ * @return A configuration flags mask.
+ */
+dma_config_flags_t dma_ch_load_transaction( dma_ch_t    *p_ch,
+                                            dma_trans_t *p_trans );
+
 /**
  * @brief Launches the loaded transaction.
  * @param p_trans A pointer to the desired transaction. This is only used to
@@ -395,6 +517,89 @@ dma_config_flags_t dma_load_transaction( dma_trans_t* p_trans );
  */
 dma_config_flags_t dma_launch( dma_trans_t* p_trans );
 
+/**
+ * @brief Same as dma_launch(), on the given channel.
+ * @param p_ch The channel the transaction was loaded into.
+ * @param p_trans A pointer to the desired transaction.
+ * @retval DMA_CONFIG_CRITICAL_ERROR if the transaction is not the one loaded
+ * in the channel.
+ * @retval DMA_CONFIG_OK == 0 otherwise.
+ */
+dma_config_flags_t dma_ch_launch( dma_ch_t *p_ch, dma_trans_t *p_trans );
+
+/**
+ * @brief Validates a transaction and packs its register values into an
+ * image, so that it can be loaded and relaunched without going through the
+ * validation again.
+ * @param p_img Pointer to the image to fill.
+ * @param p_trans Pointer to the transaction, as for dma_validate_transaction().
+ * @param p_enRealign Whether to allow the DMA to take a smaller data type
+ * in order to counter misalignments.
+ * @param p_check Whether integrity checks should be performed.
+ * @return The configuration flags of dma_validate_transaction(). The image is
+ * only filled if there is no critical error.
+ */
+dma_config_flags_t dma_compile_transaction( dma_trans_image_t *p_img,
+                                            dma_trans_t       *p_trans,
+                                            dma_en_realign_t  p_enRealign,
+                                            dma_perf_checks_t p_check );
+
+/**
+ * @brief Same as dma_ch_load_image(), on channel 0.
+ */
+dma_config_flags_t dma_load_image( dma_trans_image_t *p_img );
+
+/**
+ * @brief Writes all the registers of an image into a channel, except the
+ * size: the transaction is launched with dma_ch_relaunch(). The transaction
+ * loaded in the channel is lost.
+ * @param p_ch The channel to load the image into.
+ * @param p_img Pointer to the image, filled by dma_compile_transaction().
+ * @retval DMA_CONFIG_TRANS_OVERRIDE if the channel is running a transaction.
+ * @retval DMA_CONFIG_OK == 0 otherwise.
+ */
+dma_config_flags_t dma_ch_load_image( dma_ch_t          *p_ch,
+                                      dma_trans_image_t *p_img );
+
+/**
+ * @brief Builds the descriptor of a linked list from a validated transaction.
+ * The interrupt flag of the descriptor is set if the end event of the
+ * transaction is not polling: the channel raises its interrupt once that
+ * transaction is done. The end of the list always raises it.
+ * @note The mode of the transaction must be single, the window is not used.
+ * @param p_desc Pointer to the descriptor to build.
+ * @param p_trans Pointer to the transaction to take the configuration from.
+ * @param p_next Pointer to the descriptor to run next, NULL to end the list.
+ * @retval DMA_CONFIG_CRITICAL_ERROR if the transaction cannot be run from a
+ * descriptor.
+ * @retval DMA_CONFIG_OK == 0 otherwise.
+ */
+dma_config_flags_t dma_desc_build(  dma_desc_t  *p_desc,
+                                    dma_trans_t *p_trans,
+                                    dma_desc_t  *p_next );
+
+/**
+ * @brief Same as dma_ch_launch_list(), on channel 0.
+ */
+dma_config_flags_t dma_launch_list( dma_desc_t          *p_head,
+                                    dma_trans_end_evt_t p_end );
+
+/**
+ * @brief Runs a linked list of descriptors on the given channel. The DMA
+ * fetches each descriptor and runs its transaction until the end of the
+ * list, the transaction loaded in the channel is lost.
+ * @param p_ch The channel to run the list on.
+ * @param p_head Pointer to the first descriptor of the list.
+ * @param p_end What should happen after the list is launched. The interrupt
+ * is raised for the descriptors with the interrupt flag and at the end of the
+ * list, INTR_WAIT waits for the end of the list.
+ * @retval DMA_CONFIG_TRANS_OVERRIDE if the channel is running a transaction.
+ * @retval DMA_CONFIG_OK == 0 otherwise.
+ */
+dma_config_flags_t dma_ch_launch_list(  dma_ch_t            *p_ch,
+                                        dma_desc_t          *p_head,
+                                        dma_trans_end_evt_t p_end );
+
 /**
  * @brief Read from the done register of the DMA. Additionally decreases the
  * count of simultaneously-launched transactions. Be careful when calling this
@@ -409,6 +614,13 @@ dma_config_flags_t dma_launch( dma_trans_t* p_trans );
  */
 uint32_t dma_is_ready(void);
 
+/**
+ * @brief Same as dma_is_ready(), for the given channel.
+ * @retval 0 - The channel is working.
+ * @retval 1 - The channel is idle.
+ */
+uint32_t dma_ch_is_ready( dma_ch_t *p_ch );
+
 /**
  * @brief Get the number of windows that have already been written. Resets on
  * the start of each transaction.
@@ -416,6 +628,11 @@ uint32_t dma_is_ready(void);
  */
 uint32_t dma_get_window_count(void);
 
+/**
+ * @brief Same as dma_get_window_count(), for the given channel.
+ */
+uint32_t dma_ch_get_window_count( dma_ch_t *p_ch );
+
 /**
  * @brief Prevent the DMA from relaunching the transaction automatically after
  * finishing the current one. It does not affect the currently running
@@ -424,6 +641,20 @@ uint32_t dma_get_window_count(void);
  */
 void dma_stop_circular(void);
 
+/**
+ * @brief Same as dma_stop_circular(), for the given channel.
+ */
+void dma_ch_stop_circular( dma_ch_t *p_ch );
+
+/**
+ * @brief Sets the priority of a channel on the bus ports, from 0 (lowest,
+ * the default) to 7. It only matters if the DMA arbitrates by priority
+ * (DMA_ARB_PRIORITY defined), channels of equal priority take turns.
+ * @param p_ch The channel.
+ * @param p_priority The priority of the channel.
+ */
+void dma_ch_set_priority( dma_ch_t *p_ch, uint8_t p_priority );
+
 /**
 * @brief DMA interrupt handler.
 * `dma.c` provides a weak definition of this symbol, which can be overridden
@@ -438,6 +669,20 @@ void dma_intr_handler_trans_done(void);
 */
 void dma_intr_handler_window_done(void);
 
+/**
+* @brief DMA interrupt handler, called for each channel whose transaction has
+* finished. Its weak definition calls dma_intr_handler_trans_done().
+* It can be overridden at link-time by providing a non-weak definition.
+*/
+void dma_ch_intr_handler_trans_done( dma_ch_t *p_ch );
+
+/**
+* @brief DMA interrupt handler, called for each channel that has copied a
+* window. Its weak definition calls dma_intr_handler_window_done().
+* It can be overridden at link-time by providing a non-weak definition.
+*/
+void dma_ch_intr_handler_window_done( dma_ch_t *p_ch );
+
 /**
  * @brief This weak implementation allows the user to override the threshold
  * in which a warning is raised for a transaction to window size ratio that
@@ -456,6 +701,29 @@ uint8_t dma_window_ratio_warning_threshold(void);
 /**                          INLINE FUNCTIONS                              **/
 /**                                                                        **/
 /****************************************************************************/
+
+/**
+ * @brief Launches again the image loaded in a channel, with the pointers and
+ * size it currently holds. Only the SRC_PTR, DST_PTR and SIZE registers are
+ * written, and nothing is checked: the channel must be ready and the image
+ * the one loaded with dma_ch_load_image(). The end event of the image is not
+ * waited for, INTR_WAIT behaves as INTR.
+ * There is no version without a channel handle: the handle returned by
+ * dma_channel() is kept by the application.
+ * @param p_ch The channel the image was loaded into.
+ * @param p_img Pointer to the image.
+ */
+static inline void dma_ch_relaunch( dma_ch_t          *p_ch,
+                                    dma_trans_image_t *p_img )
+{
+    /* Lowered before the start, the interrupt could arrive right after. */
+    p_ch->intrFlag = 0;
+    p_ch->events   = 0;
+
+    p_ch->peri->SRC_PTR = p_img->src_ptr;
+    p_ch->peri->DST_PTR = p_img->dst_ptr;
+    p_ch->peri->SIZE    = p_img->size_b;
+}
 #ifdef __cplusplus
 } // extern "C"
 #endif
@@ -32,6 +32,7 @@ extern "C" {
 #define DMA_STATUS_REG_OFFSET 0x10
 #define DMA_STATUS_READY_BIT 0
 #define DMA_STATUS_WINDOW_DONE_BIT 1
+#define DMA_STATUS_TRANSACTION_DONE_BIT 2
 
 // Increment number of src/dst pointer every time a word is copied
 #define DMA_PTR_INC_REG_OFFSET 0x14
@@ -87,6 +88,46 @@ extern "C" {
 #define DMA_INTERRUPT_EN_TRANSACTION_DONE_BIT 0
 #define DMA_INTERRUPT_EN_WINDOW_DONE_BIT 1
 
+// Priority of the channel on the bus ports shared by the channels,
+#define DMA_CH_PRIORITY_REG_OFFSET 0x30
+#define DMA_CH_PRIORITY_CH_PRIORITY_MASK 0x7
+#define DMA_CH_PRIORITY_CH_PRIORITY_OFFSET 0
+#define DMA_CH_PRIORITY_CH_PRIORITY_FIELD \
+  ((bitfield_field32_t) { .mask = DMA_CH_PRIORITY_CH_PRIORITY_MASK, .index = DMA_CH_PRIORITY_CH_PRIORITY_OFFSET })
+
+// Number of rows of SIZE bytes (2nd dimension) in a 2D/3D transfer.
+#define DMA_SIZE_D2_REG_OFFSET 0x34
+#define DMA_SIZE_D2_SIZE_D2_MASK 0xffff
+#define DMA_SIZE_D2_SIZE_D2_OFFSET 0
+#define DMA_SIZE_D2_SIZE_D2_FIELD \
+  ((bitfield_field32_t) { .mask = DMA_SIZE_D2_SIZE_D2_MASK, .index = DMA_SIZE_D2_SIZE_D2_OFFSET })
+
+// Number of planes of SIZE_D2 rows (3rd dimension) in a 3D transfer.
+#define DMA_SIZE_D3_REG_OFFSET 0x38
+#define DMA_SIZE_D3_SIZE_D3_MASK 0xffff
+#define DMA_SIZE_D3_SIZE_D3_OFFSET 0
+#define DMA_SIZE_D3_SIZE_D3_FIELD \
+  ((bitfield_field32_t) { .mask = DMA_SIZE_D3_SIZE_D3_MASK, .index = DMA_SIZE_D3_SIZE_D3_OFFSET })
+
+// Source distance in bytes from the start of a row to the start of the next
+// one (signed)
+#define DMA_SRC_STRIDE_D2_REG_OFFSET 0x3c
+
+// Source distance in bytes from the start of a plane to the start of the
+// next one (signed)
+#define DMA_SRC_STRIDE_D3_REG_OFFSET 0x40
+
+// Destination distance in bytes from the start of a row to the start of the
+// next one (signed)
+#define DMA_DST_STRIDE_D2_REG_OFFSET 0x44
+
+// Destination distance in bytes from the start of a plane to the start of
+// the next one (signed)
+#define DMA_DST_STRIDE_D3_REG_OFFSET 0x48
+
+// Address of the descriptor of a linked list (word aligned). Writing
+#define DMA_DESC_PTR_REG_OFFSET 0x4c
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
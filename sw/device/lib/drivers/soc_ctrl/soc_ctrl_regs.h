@@ -48,6 +48,10 @@ extern "C" {
 // system is running (in Hz)
 #define SOC_CTRL_SYSTEM_FREQUENCY_HZ_REG_OFFSET 0x1c
 
+// Host Call - Written with the address of a host call descriptor, served by
+// the simulation testbench
+#define SOC_CTRL_HOST_CALL_REG_OFFSET 0x20
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
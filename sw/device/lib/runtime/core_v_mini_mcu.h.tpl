@@ -16,6 +16,16 @@ extern "C" {
 
 #define EXTERNAL_DOMAINS ${external_domains}
 
+#define DMA_CH_NUM ${dma_ch_num}
+#define DMA_CH_SIZE 0x100
+% if dma_arb_policy == "priority":
+#define DMA_ARB_PRIORITY
+% endif
+
+#define RAM_START_ADDRESS 0x${ram_start_address}
+#define RAM_SIZE 0x${ram_size_address}
+#define RAM_END_ADDRESS (RAM_START_ADDRESS + RAM_SIZE)
+
 #define DEBUG_START_ADDRESS 0x${debug_start_address}
 #define DEBUG_SIZE 0x${debug_size_address}
 #define DEBUG_END_ADDRESS (DEBUG_START_ADDRESS + DEBUG_SIZE)
@@ -0,0 +1,38 @@
+// Copyright 2024 EPFL
+// Solderpad Hardware License, Version 2.1, see LICENSE.md for details.
+// SPDX-License-Identifier: Apache-2.0 WITH SHL-2.1
+
+#include "host_call.h"
+
+#include "core_v_mini_mcu.h"
+#include "mmio.h"
+#include "soc_ctrl_regs.h"
+
+int32_t host_call(host_call_op_t op, uint32_t arg0, uint32_t arg1, uint32_t arg2)
+{
+    volatile host_call_t call;
+    mmio_region_t soc_ctrl = mmio_region_from_addr((uintptr_t)SOC_CTRL_START_ADDRESS);
+
+    call.op     = op;
+    call.arg[0] = arg0;
+    call.arg[1] = arg1;
+    call.arg[2] = arg2;
+    call.ret    = HOST_CALL_UNSERVED;
+
+    mmio_region_write32(soc_ctrl, (ptrdiff_t)(SOC_CTRL_HOST_CALL_REG_OFFSET), (uint32_t)&call);
+    // the testbench serves the call on the clock edge of the write, reading
+    // the register back keeps the following loads after it
+    mmio_region_read32(soc_ctrl, (ptrdiff_t)(SOC_CTRL_HOST_CALL_REG_OFFSET));
+
+    return call.ret;
+}
+
+int32_t host_read(void *buf, uint32_t len)
+{
+    return host_call(kHostCallRead, HOST_CALL_FD_INPUT, (uint32_t)buf, len);
+}
+
+int32_t host_write(const void *buf, uint32_t len)
+{
+    return host_call(kHostCallWrite, HOST_CALL_FD_OUTPUT, (uint32_t)buf, len);
+}
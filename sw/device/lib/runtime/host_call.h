@@ -0,0 +1,95 @@
+// Copyright 2024 EPFL
+// Solderpad Hardware License, Version 2.1, see LICENSE.md for details.
+// SPDX-License-Identifier: Apache-2.0 WITH SHL-2.1
+
+#ifndef _RUNTIME_HOST_CALL_H_
+#define _RUNTIME_HOST_CALL_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Host calls are services of the simulation testbench (tb/tb_hostcall.cpp).
+ * The software fills a descriptor in the SRAM and writes its address to the
+ * HOST_CALL register of soc_ctrl; the testbench serves the call directly from
+ * the memory and writes the result back in the descriptor, in a few cycles.
+ * Without a testbench serving them (FPGA, other simulators) the calls return
+ * HOST_CALL_UNSERVED and the caller falls back to the hardware.
+ */
+
+/**
+ * Returned when no testbench served the call.
+ */
+#define HOST_CALL_UNSERVED ((int32_t)0x80000000)
+
+/**
+ * Host file descriptors of the data streams of host_read() and host_write(),
+ * backed by the files given to the testbench with +host_in= and +host_out=.
+ */
+#define HOST_CALL_FD_INPUT 0
+#define HOST_CALL_FD_OUTPUT 3
+
+/**
+ * Services of the testbench. The numbering is shared with tb/tb_hostcall.h.
+ */
+typedef enum host_call_op {
+  /**
+   * Writes arg[2] bytes at address arg[1] to the host file descriptor arg[0]
+   * (1 = stdout, 2 = stderr, HOST_CALL_FD_OUTPUT), returns the number of
+   * bytes written.
+   */
+  kHostCallWrite = 1,
+  /**
+   * Reads up to arg[2] bytes of the host file descriptor arg[0]
+   * (HOST_CALL_FD_INPUT) to address arg[1], returns the number of bytes read,
+   * 0 at the end of the file.
+   */
+  kHostCallRead = 2,
+} host_call_op_t;
+
+/**
+ * Descriptor of a host call, read and written by the testbench.
+ */
+typedef struct host_call {
+  uint32_t op;
+  uint32_t arg[3];
+  int32_t ret;
+} host_call_t;
+
+/**
+ * Requests a service from the simulation testbench.
+ * @param op Service to request.
+ * @param arg0 First argument of the service.
+ * @param arg1 Second argument of the service.
+ * @param arg2 Third argument of the service.
+ * @return The result of the service, or HOST_CALL_UNSERVED.
+ */
+int32_t host_call(host_call_op_t op, uint32_t arg0, uint32_t arg1, uint32_t arg2);
+
+/**
+ * Reads the next bytes of the input data stream of the testbench, without
+ * any bus cycle: a firmware image can process a whole dataset instead of
+ * data compiled in its headers.
+ * @param buf Destination, in the SRAM.
+ * @param len Number of bytes to read.
+ * @return The number of bytes read, 0 at the end of the stream, -1 on error
+ * or HOST_CALL_UNSERVED.
+ */
+int32_t host_read(void *buf, uint32_t len);
+
+/**
+ * Appends bytes to the output data stream of the testbench.
+ * @param buf Source, in the SRAM.
+ * @param len Number of bytes to write.
+ * @return The number of bytes written, -1 on error or HOST_CALL_UNSERVED.
+ */
+int32_t host_write(const void *buf, uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // _RUNTIME_HOST_CALL_H_
@@ -0,0 +1,32 @@
+// Copyright EPFL contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Verilator shim of the I2S microphone: the model lives in tb/tb_audio.cpp
+// (I2sMic) and keeps the timing of i2s_microphone, the word select is sampled
+// on the rising edges of SCK and the data driven on the falling edges.
+module i2smicdpi (
+    input logic rst_ni,
+
+    input  logic i2s_sck_i,
+    input  logic i2s_ws_i,
+    output logic i2s_sd_o
+);
+
+  import "DPI-C" function void i2smicdpi_sck_rise(input bit ws);
+  import "DPI-C" function bit i2smicdpi_sck_fall(input bit ws);
+  import "DPI-C" function void i2smicdpi_reset();
+
+  always_ff @(posedge i2s_sck_i or negedge rst_ni) begin
+    if (~rst_ni) begin
+      i2smicdpi_reset();
+    end else begin
+      i2smicdpi_sck_rise(i2s_ws_i);
+    end
+  end
+
+  always_ff @(negedge i2s_sck_i) begin
+    i2s_sd_o <= i2smicdpi_sck_fall(i2s_ws_i);
+  end
+
+endmodule
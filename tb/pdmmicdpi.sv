@@ -0,0 +1,34 @@
+// Copyright EPFL contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Verilator shim of the PDM microphone: the model lives in tb/tb_audio.cpp
+// (PdmMic) and keeps the timing of pdm2pcm_dummy, the data line is registered
+// on the system clock after each rising edge of the PDM clock.
+module pdmmicdpi (
+    input logic clk_i,
+    input logic rst_ni,
+
+    input  logic pdm_clk_i,
+    output logic pdm_data_o
+);
+
+  import "DPI-C" function bit pdmmicdpi_tick(
+    input longint cycle,
+    input bit pdm_clk
+  );
+  import "DPI-C" function void pdmmicdpi_reset();
+
+  longint unsigned cycles = 0;
+
+  always_ff @(posedge clk_i or negedge rst_ni) begin
+    if (~rst_ni) begin
+      pdmmicdpi_reset();
+      pdm_data_o <= 1'b0;
+    end else begin
+      cycles <= cycles + 1;
+      pdm_data_o <= pdmmicdpi_tick(cycles, pdm_clk_i);
+    end
+  end
+
+endmodule
@@ -0,0 +1,46 @@
+// Copyright EPFL contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Verilator shim of the boot flash: the W25Q128JW model lives in
+// tb/tb_spiflash.cpp. SCK toggles at most once per clock cycle, so the bus is
+// sampled on the falling edge of the system clock, where it is stable, and the
+// data driven by the flash is ready for the next rising edge.
+module spiflashdpi (
+    input logic clk_i,
+
+    input logic csb,
+    input logic sck,
+    inout wire  io0,
+    inout wire  io1,
+    inout wire  io2,
+    inout wire  io3
+);
+
+  import "DPI-C" function void spiflashdpi_tick(
+    input longint cycle,
+    input bit csb,
+    input bit sck,
+    input bit [3:0] io_i,
+    output bit [3:0] io_o,
+    output bit [3:0] io_oe
+  );
+
+  longint unsigned cycles = 0;
+  bit [3:0] io_o = '0;
+  bit [3:0] io_oe = '0;
+
+  always_ff @(posedge clk_i) begin
+    cycles <= cycles + 1;
+  end
+
+  always @(negedge clk_i) begin
+    spiflashdpi_tick(cycles, csb, sck, {io3, io2, io1, io0}, io_o, io_oe);
+  end
+
+  assign io0 = io_oe[0] ? io_o[0] : 1'bz;
+  assign io1 = io_oe[1] ? io_o[1] : 1'bz;
+  assign io2 = io_oe[2] ? io_o[2] : 1'bz;
+  assign io3 = io_oe[3] ? io_o[3] : 1'bz;
+
+endmodule
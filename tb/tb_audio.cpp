@@ -0,0 +1,407 @@
+// Copyright EPFL contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "tb_audio.h"
+
+#include <inttypes.h>
+#include <string.h>
+#include <fstream>
+#include <iostream>
+
+PdmMic tb_pdm_mic;
+I2sMic tb_i2s_mic;
+
+namespace {
+
+uint32_t le(const uint8_t *p, unsigned int bytes)
+{
+  uint32_t v = 0;
+  for(unsigned int i = 0; i < bytes; i++)
+    v |= (uint32_t)p[i] << (8 * i);
+  return v;
+}
+
+bool endsWith(const std::string &s, const std::string &suffix)
+{
+  return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+FILE *openCapture(const std::string &file, const char *tag, const char *header)
+{
+  FILE *f = fopen(file.c_str(), "w");
+  if(f == NULL) {
+    std::cout<<"["<<tag<<"]: ERROR: Cannot open the capture file "<<file<<std::endl;
+    return NULL;
+  }
+  fprintf(f, "%s\n", header);
+  return f;
+}
+
+}  // namespace
+
+AudioSource::AudioSource()
+  : channels_(1), rate_(0)
+{
+}
+
+bool AudioSource::open(const std::string &file)
+{
+  FILE *f = fopen(file.c_str(), "rb");
+  if(f == NULL) {
+    std::cout<<"[AUDIO]: ERROR: Cannot open "<<file<<std::endl;
+    return false;
+  }
+  samples_.clear();
+  channels_ = 1;
+  rate_     = 0;
+  bool ok = endsWith(file, ".wav") ? readWav(f, file) : readRaw(f);
+  fclose(f);
+  if(ok && samples_.empty()) {
+    std::cout<<"[AUDIO]: ERROR: No samples in "<<file<<std::endl;
+    ok = false;
+  }
+  return ok;
+}
+
+bool AudioSource::readWav(FILE *f, const std::string &file)
+{
+  uint8_t hdr[12];
+  if(fread(hdr, 1, 12, f) != 12 || memcmp(hdr, "RIFF", 4) != 0 || memcmp(hdr + 8, "WAVE", 4) != 0) {
+    std::cout<<"[AUDIO]: ERROR: "<<file<<" is not a WAV file"<<std::endl;
+    return false;
+  }
+
+  unsigned int bits = 0;
+  uint8_t chunk[8];
+  while(fread(chunk, 1, 8, f) == 8) {
+    uint32_t size = le(chunk + 4, 4);
+    if(memcmp(chunk, "fmt ", 4) == 0) {
+      uint8_t fmt[16];
+      if(size < 16 || fread(fmt, 1, 16, f) != 16)
+        break;
+      uint32_t format = le(fmt, 2);
+      channels_ = le(fmt + 2, 2);
+      rate_     = le(fmt + 4, 4);
+      bits      = le(fmt + 14, 2);
+      // 0xfffe is WAVE_FORMAT_EXTENSIBLE, whose sub-format is not checked
+      if((format != 1 && format != 0xfffe) || channels_ == 0 || bits == 0 || bits > 32 || bits % 8 != 0) {
+        std::cout<<"[AUDIO]: ERROR: "<<file<<" is not an integer PCM WAV file"<<std::endl;
+        return false;
+      }
+      fseek(f, (size - 16) + (size & 1), SEEK_CUR);
+    } else if(memcmp(chunk, "data", 4) == 0) {
+      if(bits == 0)
+        break;
+      unsigned int bytes = bits / 8;
+      std::vector<uint8_t> data(size);
+      size = fread(data.data(), 1, size, f);
+      samples_.reserve(size / bytes);
+      for(uint32_t i = 0; i + bytes <= size; i += bytes) {
+        uint32_t v = le(&data[i], bytes) << (32 - bits);
+        // 8-bit WAV samples are unsigned
+        if(bits == 8)
+          v ^= 0x80000000;
+        samples_.push_back((int32_t)v);
+      }
+      samples_.resize(samples_.size() - samples_.size() % channels_);
+      return true;
+    } else {
+      fseek(f, size + (size & 1), SEEK_CUR);
+    }
+  }
+  std::cout<<"[AUDIO]: ERROR: No fmt or data chunk in "<<file<<std::endl;
+  return false;
+}
+
+bool AudioSource::readRaw(FILE *f)
+{
+  uint8_t buf[4096];
+  size_t n;
+  while((n = fread(buf, 1, sizeof(buf), f)) >= 2) {
+    for(size_t i = 0; i + 2 <= n; i += 2)
+      samples_.push_back((int32_t)(le(buf + i, 2) << 16));
+  }
+  return true;
+}
+
+int32_t AudioSource::sample(size_t n, unsigned int ch) const
+{
+  if(ch >= channels_)
+    ch = channels_ - 1;
+  return samples_[n * channels_ + ch];
+}
+
+const char *const PdmMic::kDefaultFile = "../../../hw/ip/pdm2pcm/tb/signals/pdm.txt";
+
+PdmMic::PdmMic()
+  : file_(kDefaultFile), opened_(false), ratio_(64), capture_(NULL), captured_(0)
+{
+  reset();
+}
+
+PdmMic::~PdmMic()
+{
+  if(capture_ != NULL)
+    fclose(capture_);
+}
+
+bool PdmMic::open(const std::string &file)
+{
+  file_   = file;
+  opened_ = true;
+  bits_.clear();
+  if(endsWith(file, ".txt")) {
+    std::ifstream in(file.c_str());
+    if(!in) {
+      std::cout<<"[PDM]: ERROR: Cannot open "<<file<<std::endl;
+      return false;
+    }
+    std::string line;
+    while(std::getline(in, line))
+      bits_.push_back(!line.empty() && line[0] == '1');
+    return true;
+  }
+  if(!pcm_.open(file))
+    return false;
+  if(pcm_.channels() > 1)
+    std::cout<<"[PDM]: "<<file<<" has "<<pcm_.channels()<<" channels, playing the first one"<<std::endl;
+  return true;
+}
+
+bool PdmMic::setCapture(const std::string &file)
+{
+  capture_ = openCapture(file, "PDM", "frame,cycle,sample");
+  return capture_ != NULL;
+}
+
+void PdmMic::reset()
+{
+  started_    = false;
+  clk_q_      = false;
+  data_q_     = false;
+  pdm_clocks_ = 0;
+  ended_      = false;
+  frame_      = 0;
+  integ_[0] = integ_[1] = 0.0;
+  memset(cic_integ_, 0, sizeof(cic_integ_));
+  memset(cic_comb_, 0, sizeof(cic_comb_));
+}
+
+bool PdmMic::update(uint64_t cycle, bool pdm_clk)
+{
+  // Same timing as pdm2pcm_dummy: the first bit is out after reset, the next
+  // one is registered on each rising edge of the PDM clock
+  if(!started_) {
+    started_ = true;
+    if(!opened_ && !open(file_)) {
+      std::cout<<"[PDM]: The default bitstream is found when the simulation is launched"<<std::endl;
+      std::cout<<"       from the build folder, e.g. with `make verilator-run`"<<std::endl;
+    }
+    data_q_ = nextBit();
+    capture(cycle, data_q_);
+  }
+  if(pdm_clk && !clk_q_) {
+    data_q_ = nextBit();
+    capture(cycle, data_q_);
+  }
+  clk_q_ = pdm_clk;
+  return data_q_;
+}
+
+bool PdmMic::nextBit()
+{
+  uint64_t n = pdm_clocks_++;
+  bool bit;
+
+  if(!pcm_.empty()) {
+    uint64_t frame = n / ratio_;
+    if(frame < pcm_.frames()) {
+      double x = pcm_.sample(frame, 0) / 2147483648.0;
+      bit = integ_[1] >= 0.0;
+      double y = bit ? 1.0 : -1.0;
+      integ_[0] += x - y;
+      integ_[1] += integ_[0] - y;
+      // keeps the modulator stable on full scale inputs
+      for(unsigned int i = 0; i < 2; i++) {
+        if(integ_[i] > 4.0)
+          integ_[i] = 4.0;
+        else if(integ_[i] < -4.0)
+          integ_[i] = -4.0;
+      }
+      return bit;
+    }
+  } else if(n < bits_.size()) {
+    return bits_[n] != 0;
+  }
+
+  if(!ended_ && (!pcm_.empty() || !bits_.empty()))
+    std::cout<<"[PDM]: End of "<<file_<<" after "<<n<<" PDM clocks, playing silence"<<std::endl;
+  ended_ = true;
+  // density of one half
+  return (n & 1) != 0;
+}
+
+void PdmMic::capture(uint64_t cycle, bool bit)
+{
+  if(capture_ == NULL || ended_)
+    return;
+
+  uint64_t n = pdm_clocks_ - 1;
+  if(!pcm_.empty()) {
+    if(n % ratio_ == 0) {
+      fprintf(capture_, "%" PRIu64 ",%" PRIu64 ",%d\n", frame_++, cycle, pcm_.sample(n / ratio_, 0) >> 16);
+      captured_++;
+    }
+    return;
+  }
+
+  // 4th order CIC, the gain of ratio^4 is scaled to 16 bits
+  int64_t v = bit ? 1 : -1;
+  for(unsigned int i = 0; i < 4; i++) {
+    cic_integ_[i] += v;
+    v = cic_integ_[i];
+  }
+  if(n % ratio_ != ratio_ - 1)
+    return;
+  for(unsigned int i = 0; i < 4; i++) {
+    int64_t d = v - cic_comb_[i];
+    cic_comb_[i] = v;
+    v = d;
+  }
+  double gain = (double)ratio_ * ratio_ * ratio_ * ratio_;
+  int32_t s = (int32_t)(v * 32767.0 / gain);
+  // the first three outputs are the transient of the combs
+  if(frame_ >= 3) {
+    fprintf(capture_, "%" PRIu64 ",%" PRIu64 ",%d\n", frame_, cycle, s);
+    captured_++;
+  }
+  frame_++;
+}
+
+void PdmMic::printStats() const
+{
+  if(pdm_clocks_ <= 1)
+    return;
+  std::cout<<"[PDM]: "<<pdm_clocks_ - 1<<" PDM clocks";
+  if(captured_ != 0)
+    std::cout<<", "<<captured_<<" PCM samples captured";
+  std::cout<<std::endl;
+}
+
+I2sMic::I2sMic()
+  : bits_(32), capture_(NULL)
+{
+  reset();
+}
+
+I2sMic::~I2sMic()
+{
+  if(capture_ != NULL)
+    fclose(capture_);
+}
+
+bool I2sMic::open(const std::string &file)
+{
+  file_ = file;
+  return pcm_.open(file);
+}
+
+bool I2sMic::setCapture(const std::string &file)
+{
+  capture_ = openCapture(file, "I2S", "frame,left,right");
+  return capture_ != NULL;
+}
+
+void I2sMic::reset()
+{
+  ws_q_      = false;
+  bit_count_ = 0;
+  frame_     = 0;
+  ended_     = false;
+  loadFrame();
+}
+
+void I2sMic::loadFrame()
+{
+  int32_t sample[2] = { (int32_t)kDefaultLeft, (int32_t)kDefaultRight };
+
+  if(!pcm_.empty()) {
+    if(frame_ < pcm_.frames()) {
+      sample[0] = pcm_.sample(frame_, 0);
+      sample[1] = pcm_.sample(frame_, 1);
+    } else {
+      if(!ended_)
+        std::cout<<"[I2S]: End of "<<file_<<" after "<<frame_<<" frames, playing silence"<<std::endl;
+      ended_ = true;
+      sample[0] = sample[1] = 0;
+    }
+  }
+
+  for(unsigned int ch = 0; ch < 2; ch++)
+    words_[ch] = (uint32_t)(sample[ch] >> (32 - bits_));
+
+  if(capture_ != NULL && !ended_) {
+    int32_t l = (int32_t)(words_[0] << (32 - bits_)) >> (32 - bits_);
+    int32_t r = (int32_t)(words_[1] << (32 - bits_)) >> (32 - bits_);
+    fprintf(capture_, "%" PRIu64 ",%d,%d\n", frame_, l, r);
+  }
+}
+
+void I2sMic::sckRise(bool ws)
+{
+  if(ws != ws_q_) {
+    bit_count_ = 0;
+    ws_q_      = ws;
+    // a frame starts with its left word
+    if(!ws) {
+      frame_++;
+      loadFrame();
+    }
+  } else {
+    // 6-bit counter of i2s_microphone
+    bit_count_ = (bit_count_ + 1) & 0x3f;
+  }
+}
+
+bool I2sMic::sckFall(bool ws) const
+{
+  if(bit_count_ >= bits_)
+    return false;
+  return (words_[ws ? 1 : 0] >> (bits_ - 1 - bit_count_)) & 1;
+}
+
+void I2sMic::printStats() const
+{
+  if(frame_ == 0)
+    return;
+  std::cout<<"[I2S]: "<<frame_<<" frames";
+  if(!file_.empty())
+    std::cout<<" from "<<file_;
+  std::cout<<std::endl;
+}
+
+extern "C" unsigned char pdmmicdpi_tick(long long cycle, unsigned char pdm_clk)
+{
+  return tb_pdm_mic.update(cycle, pdm_clk != 0);
+}
+
+extern "C" void pdmmicdpi_reset()
+{
+  tb_pdm_mic.reset();
+}
+
+extern "C" void i2smicdpi_sck_rise(unsigned char ws)
+{
+  tb_i2s_mic.sckRise(ws != 0);
+}
+
+extern "C" unsigned char i2smicdpi_sck_fall(unsigned char ws)
+{
+  return tb_i2s_mic.sckFall(ws != 0);
+}
+
+extern "C" void i2smicdpi_reset()
+{
+  tb_i2s_mic.reset();
+}
@@ -0,0 +1,135 @@
+// Copyright EPFL contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef TB_AUDIO_H_
+#define TB_AUDIO_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+// Audio samples of a WAV file (PCM, 8 to 32 bits) or of a raw file of mono
+// signed 16-bit little-endian samples. The samples are left-justified to 32
+// bits and interleaved by channel.
+class AudioSource {
+ public:
+  AudioSource();
+
+  bool open(const std::string &file);
+  bool empty() const { return samples_.empty(); }
+  unsigned int channels() const { return channels_; }
+  unsigned int rate() const { return rate_; }
+  size_t frames() const { return samples_.size() / channels_; }
+  // Sample of channel ch in frame n, the last channel if the source has less
+  int32_t sample(size_t n, unsigned int ch) const;
+
+ private:
+  bool readWav(FILE *f, const std::string &file);
+  bool readRaw(FILE *f);
+
+  std::vector<int32_t> samples_;
+  unsigned int channels_;
+  unsigned int rate_;
+};
+
+// PDM microphone on gpio[18] (data) and gpio[19] (clock from pdm2pcm),
+// replaces hw/ip_examples/pdm2pcm_dummy in the Verilator testharness.
+//
+// A .txt file holds one bit per line ("1" is a one, anything else a zero) and
+// is played as is, by default the bitstream the groundtruth of
+// example_pdm2pcm was computed from. PCM sources go through a second order
+// sigma-delta modulator, each sample lasts ratio PDM clocks. The capture file
+// gets one "frame,cycle,sample" line every ratio PDM clocks with the 16-bit
+// reference PCM the pdm2pcm filter chain should reproduce: the source sample,
+// or for a bitstream the output of a 4th order CIC decimator.
+class PdmMic {
+ public:
+  static const char *const kDefaultFile;
+
+  PdmMic();
+  ~PdmMic();
+
+  bool open(const std::string &file);
+  void setRatio(unsigned int ratio) { ratio_ = ratio; }
+  bool setCapture(const std::string &file);
+
+  // Called on every rising edge of the system clock with the PDM clock,
+  // returns the data line registered by the microphone
+  bool update(uint64_t cycle, bool pdm_clk);
+  void reset();
+
+  void printStats() const;
+
+ private:
+  bool nextBit();
+  void capture(uint64_t cycle, bool bit);
+
+  std::string file_;
+  bool opened_;
+  std::vector<uint8_t> bits_;
+  AudioSource pcm_;
+  unsigned int ratio_;
+
+  bool started_;
+  bool clk_q_;
+  bool data_q_;
+  uint64_t pdm_clocks_;
+  bool ended_;
+  // Sigma-delta modulator
+  double integ_[2];
+  // Reference decimator of the capture
+  FILE *capture_;
+  uint64_t frame_;
+  int64_t cic_integ_[4];
+  int64_t cic_comb_[4];
+  uint64_t captured_;
+};
+
+// I2S microphone on gpio[20] (SCK), gpio[21] (WS) and gpio[22] (SD), replaces
+// hw/ip_examples/i2s_microphone in the Verilator testharness.
+//
+// Without a file the words are the constants expected by example_i2s. A
+// source frame is played from each falling edge of WS, left word while WS is
+// low and right word while it is high, MSB first on the falling edges of SCK
+// with the timing of i2s_microphone. Mono sources go to both channels. The
+// samples are cut to their bits most significant bits. The capture file gets
+// one "frame,left,right" line per frame played, with the words sent.
+class I2sMic {
+ public:
+  static const uint32_t kDefaultLeft  = 0x8765431;
+  static const uint32_t kDefaultRight = 0xfedcba9;
+
+  I2sMic();
+  ~I2sMic();
+
+  bool open(const std::string &file);
+  void setBits(unsigned int bits) { bits_ = bits; }
+  bool setCapture(const std::string &file);
+
+  void sckRise(bool ws);
+  bool sckFall(bool ws) const;
+  void reset();
+
+  void printStats() const;
+
+ private:
+  void loadFrame();
+
+  AudioSource pcm_;
+  std::string file_;
+  unsigned int bits_;
+
+  bool ws_q_;
+  unsigned int bit_count_;
+  uint64_t frame_;
+  uint32_t words_[2];
+  bool ended_;
+  FILE *capture_;
+};
+
+extern PdmMic tb_pdm_mic;
+extern I2sMic tb_i2s_mic;
+
+#endif  // TB_AUDIO_H_
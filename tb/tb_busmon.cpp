@@ -0,0 +1,243 @@
+// Copyright EPFL contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "tb_busmon.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+// Names of the masters and of the slaves of core_v_mini_mcu_pkg
+static const char *const kMasterNames[] = {
+  "core_instr", "core_data", "debug", "dma_read", "dma_write", "dma_addr"
+};
+static const unsigned int kNumIntMasters = sizeof(kMasterNames) / sizeof(kMasterNames[0]);
+
+BusMonitor tb_busmon;
+
+static std::string jsonArray(const std::vector<uint64_t> &v)
+{
+  std::ostringstream os;
+  os<<"[";
+  for(size_t i = 0; i < v.size(); i++)
+    os<<(i ? ", " : "")<<v[i];
+  os<<"]";
+  return os.str();
+}
+
+static std::string jsonMatrix(const std::vector<std::vector<uint64_t> > &m)
+{
+  std::ostringstream os;
+  os<<"[";
+  for(size_t i = 0; i < m.size(); i++)
+    os<<(i ? ", " : "")<<jsonArray(m[i]);
+  os<<"]";
+  return os.str();
+}
+
+// Non-empty bins as "cycles:count", the last bin is open
+static std::string histogram(const std::vector<uint64_t> &h)
+{
+  std::ostringstream os;
+  for(size_t i = 0; i < h.size(); i++) {
+    if(h[i] != 0)
+      os<<" "<<i<<(i + 1 == h.size() ? "+" : "")<<":"<<h[i];
+  }
+  return os.str();
+}
+
+static void bin(std::vector<uint64_t> &h, uint64_t cycles)
+{
+  h[std::min<uint64_t>(cycles, h.size() - 1)]++;
+}
+
+BusMonitor::BusMonitor() {}
+
+void BusMonitor::init(unsigned int num_masters, unsigned int num_slaves, unsigned int num_banks)
+{
+  masters_.assign(num_masters, Master());
+  for(unsigned int m = 0; m < num_masters; m++) {
+    std::ostringstream name;
+    if(m < kNumIntMasters)
+      name<<kMasterNames[m];
+    else
+      name<<"ext"<<m - kNumIntMasters;
+    masters_[m].name           = name.str();
+    masters_[m].reads          = 0;
+    masters_[m].writes         = 0;
+    masters_[m].bytes          = 0;
+    masters_[m].wait_cycles    = 0;
+    masters_[m].latency_cycles = 0;
+    masters_[m].responses      = 0;
+    masters_[m].req_gnt.assign(kHistBins, 0);
+    masters_[m].gnt_rvalid.assign(kHistBins, 0);
+  }
+
+  slaves_.clear();
+  slaves_.push_back("error");
+  for(unsigned int b = 0; b < num_banks; b++) {
+    std::ostringstream name;
+    name<<"ram"<<b;
+    slaves_.push_back(name.str());
+  }
+  slaves_.push_back("debug");
+  slaves_.push_back("ao_periph");
+  slaves_.push_back("periph");
+  slaves_.push_back("flash");
+  slaves_.resize(num_slaves, "?");
+
+  transactions_.assign(num_masters, std::vector<uint64_t>(num_slaves, 0));
+  waits_.assign(num_masters, std::vector<uint64_t>(num_slaves, 0));
+  stalls_.assign(num_masters, std::vector<uint64_t>(num_masters, 0));
+}
+
+void BusMonitor::grant(unsigned int master, unsigned int slave, bool we, unsigned int bytes,
+                       unsigned int wait_cycles, uint64_t cycle)
+{
+  Master &m = masters_[master];
+
+  if(we)
+    m.writes++;
+  else
+    m.reads++;
+  m.bytes += bytes;
+  m.wait_cycles += wait_cycles;
+  bin(m.req_gnt, wait_cycles);
+  m.pending.push_back(std::make_pair(slave, cycle));
+  transactions_[master][slave]++;
+  waits_[master][slave] += wait_cycles;
+}
+
+// OBI responses come back in the order of the grants
+void BusMonitor::response(unsigned int master, uint64_t cycle)
+{
+  Master &m = masters_[master];
+
+  if(m.pending.empty())
+    return;
+  uint64_t latency = cycle - m.pending.front().second;
+  m.pending.pop_front();
+  m.latency_cycles += latency;
+  m.responses++;
+  bin(m.gnt_rvalid, latency);
+}
+
+void BusMonitor::stall(unsigned int master, unsigned int winner)
+{
+  stalls_[master][winner]++;
+}
+
+void BusMonitor::printStats(uint64_t cycles) const
+{
+  std::vector<unsigned int> active_masters, active_slaves;
+
+  if(!enabled())
+    return;
+  for(unsigned int m = 0; m < masters_.size(); m++) {
+    if(masters_[m].reads + masters_[m].writes != 0)
+      active_masters.push_back(m);
+  }
+  for(unsigned int s = 0; s < slaves_.size(); s++) {
+    for(unsigned int m = 0; m < masters_.size(); m++) {
+      if(transactions_[m][s] != 0) {
+        active_slaves.push_back(s);
+        break;
+      }
+    }
+  }
+
+  std::cout<<std::fixed<<std::setprecision(3);
+  std::cout<<"[BUSMON]: master          reads     writes  bytes/cycle  wait/req  latency"<<std::endl;
+  for(size_t i = 0; i < active_masters.size(); i++) {
+    const Master &m = masters_[active_masters[i]];
+    uint64_t requests = m.reads + m.writes;
+    std::cout<<"[BUSMON]: "<<std::left<<std::setw(10)<<m.name<<std::right<<std::setw(11)<<m.reads
+             <<std::setw(11)<<m.writes<<std::setw(13)<<(cycles ? (double)m.bytes / cycles : 0.0)
+             <<std::setw(10)<<(double)m.wait_cycles / requests
+             <<std::setw(9)<<(m.responses ? (double)m.latency_cycles / m.responses : 0.0)<<std::endl;
+  }
+  std::cout.unsetf(std::ios::fixed);
+  std::cout<<std::setprecision(6);
+
+  for(size_t i = 0; i < active_masters.size(); i++) {
+    const Master &m = masters_[active_masters[i]];
+    std::cout<<"[BUSMON]: "<<m.name<<" req->gnt"<<histogram(m.req_gnt)<<std::endl;
+    std::cout<<"[BUSMON]: "<<m.name<<" gnt->rvalid"<<histogram(m.gnt_rvalid)<<std::endl;
+  }
+
+  // grant-wait cycles and transactions of every master/slave pair
+  std::cout<<"[BUSMON]: wait/transactions"<<std::setw(2)<<"";
+  for(size_t j = 0; j < active_slaves.size(); j++)
+    std::cout<<std::setw(16)<<slaves_[active_slaves[j]];
+  std::cout<<std::endl;
+  for(size_t i = 0; i < active_masters.size(); i++) {
+    unsigned int m = active_masters[i];
+    std::cout<<"[BUSMON]: "<<std::left<<std::setw(19)<<masters_[m].name<<std::right;
+    for(size_t j = 0; j < active_slaves.size(); j++) {
+      std::ostringstream cell;
+      cell<<waits_[m][active_slaves[j]]<<"/"<<transactions_[m][active_slaves[j]];
+      std::cout<<std::setw(16)<<cell.str();
+    }
+    std::cout<<std::endl;
+  }
+
+  // cycles each master waited while the others were granted
+  std::cout<<"[BUSMON]: stalled by"<<std::setw(9)<<"";
+  for(size_t j = 0; j < active_masters.size(); j++)
+    std::cout<<std::setw(12)<<masters_[active_masters[j]].name;
+  std::cout<<std::endl;
+  for(size_t i = 0; i < active_masters.size(); i++) {
+    unsigned int m = active_masters[i];
+    std::cout<<"[BUSMON]: "<<std::left<<std::setw(19)<<masters_[m].name<<std::right;
+    for(size_t j = 0; j < active_masters.size(); j++)
+      std::cout<<std::setw(12)<<stalls_[m][active_masters[j]];
+    std::cout<<std::endl;
+  }
+}
+
+bool BusMonitor::writeReport(const std::string &file, uint64_t cycles) const
+{
+  std::ofstream os(file.c_str());
+
+  os<<"{\"cycles\": "<<cycles<<", \"masters\": [";
+  for(size_t m = 0; m < masters_.size(); m++) {
+    const Master &mst = masters_[m];
+    os<<(m ? ", " : "")<<"{\"name\": \""<<mst.name<<"\", \"reads\": "<<mst.reads
+      <<", \"writes\": "<<mst.writes<<", \"bytes\": "<<mst.bytes
+      <<", \"wait_cycles\": "<<mst.wait_cycles<<", \"latency_cycles\": "<<mst.latency_cycles
+      <<", \"req_gnt_hist\": "<<jsonArray(mst.req_gnt)
+      <<", \"gnt_rvalid_hist\": "<<jsonArray(mst.gnt_rvalid)<<"}";
+  }
+  os<<"], \"slaves\": [";
+  for(size_t s = 0; s < slaves_.size(); s++)
+    os<<(s ? ", " : "")<<"\""<<slaves_[s]<<"\"";
+  os<<"], \"transactions\": "<<jsonMatrix(transactions_)
+    <<", \"wait_cycles\": "<<jsonMatrix(waits_)
+    <<", \"stalled_by\": "<<jsonMatrix(stalls_)<<"}"<<std::endl;
+
+  os.close();
+  if(!os) {
+    std::cout<<"[BUSMON]: ERROR: cannot write "<<file<<std::endl;
+    return false;
+  }
+  std::cout<<"[BUSMON]: Report written to "<<file<<std::endl;
+  return true;
+}
+
+extern "C" void tb_bus_grant(int master, int slave, int we, int bytes, int wait_cycles, long long cycle)
+{
+  tb_busmon.grant(master, slave, we != 0, bytes, wait_cycles, cycle);
+}
+
+extern "C" void tb_bus_response(int master, long long cycle)
+{
+  tb_busmon.response(master, cycle);
+}
+
+extern "C" void tb_bus_stall(int master, int winner)
+{
+  tb_busmon.stall(master, winner);
+}
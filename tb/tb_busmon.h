@@ -0,0 +1,69 @@
+// Copyright EPFL contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef TB_BUSMON_H_
+#define TB_BUSMON_H_
+
+#include <stdint.h>
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Passive monitor of the system crossbar.
+//
+// tb_util.svh reports every request granted by the crossbar with the slave it
+// targets and the cycles it waited for the grant, every response, and every
+// cycle a master waits while another one is granted (on the same slave with
+// the NtoM bus, on any slave with the onetoM bus). The masters and the slaves
+// are numbered as in core_v_mini_mcu_pkg, the external masters come last.
+class BusMonitor {
+ public:
+  // Latency histograms: one bin per cycle, the last bin counts the longer ones
+  static const unsigned int kHistBins = 17;
+
+  BusMonitor();
+
+  void init(unsigned int num_masters, unsigned int num_slaves, unsigned int num_banks);
+  bool enabled() const { return !masters_.empty(); }
+
+  void grant(unsigned int master, unsigned int slave, bool we, unsigned int bytes,
+             unsigned int wait_cycles, uint64_t cycle);
+  void response(unsigned int master, uint64_t cycle);
+  // master waited one cycle while winner was granted
+  void stall(unsigned int master, unsigned int winner);
+
+  // Prints the per-master statistics and the contention matrices of a run of
+  // cycles clock cycles
+  void printStats(uint64_t cycles) const;
+  bool writeReport(const std::string &file, uint64_t cycles) const;
+
+ private:
+  struct Master {
+    std::string name;
+    uint64_t reads;
+    uint64_t writes;
+    uint64_t bytes;
+    uint64_t wait_cycles;
+    uint64_t latency_cycles;
+    uint64_t responses;
+    std::vector<uint64_t> req_gnt;
+    std::vector<uint64_t> gnt_rvalid;
+    // slave and grant cycle of the requests waiting for their response
+    std::deque<std::pair<unsigned int, uint64_t> > pending;
+  };
+
+  std::vector<Master> masters_;
+  std::vector<std::string> slaves_;
+  // [master][slave]
+  std::vector<std::vector<uint64_t> > transactions_;
+  std::vector<std::vector<uint64_t> > waits_;
+  // [waiting master][granted master]
+  std::vector<std::vector<uint64_t> > stalls_;
+};
+
+// Instance fed by the tb_bus_grant, tb_bus_response and tb_bus_stall DPI functions
+extern BusMonitor tb_busmon;
+
+#endif  // TB_BUSMON_H_
@@ -0,0 +1,141 @@
+// Copyright EPFL contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "tb_elfloader.h"
+
+#include <elf.h>
+#include <string.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#ifndef EM_RISCV
+#define EM_RISCV 243
+#endif
+
+// Reads the whole file and checks that it is a 32-bit RISC-V ELF
+static bool elfRead(const std::string &file, std::vector<uint8_t> &img, Elf32_Ehdr &ehdr)
+{
+  std::ifstream f(file.c_str(), std::ios::binary);
+  if(!f) {
+    std::cout<<"[ELF]: ERROR: cannot open "<<file<<std::endl;
+    return false;
+  }
+  img.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+
+  if(img.size() < sizeof(ehdr)) {
+    std::cout<<"[ELF]: ERROR: "<<file<<" is too small to be an ELF file"<<std::endl;
+    return false;
+  }
+  memcpy(&ehdr, &img[0], sizeof(ehdr));
+
+  if(memcmp(ehdr.e_ident, ELFMAG, SELFMAG) != 0 ||
+     ehdr.e_ident[EI_CLASS] != ELFCLASS32 ||
+     ehdr.e_ident[EI_DATA] != ELFDATA2LSB ||
+     ehdr.e_machine != EM_RISCV) {
+    std::cout<<"[ELF]: ERROR: "<<file<<" is not a 32-bit little-endian RISC-V ELF file"<<std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool elfLoadSegments(const std::string &file, std::vector<ElfSegment> &segments)
+{
+  std::vector<uint8_t> img;
+  Elf32_Ehdr ehdr;
+  if(!elfRead(file, img, ehdr))
+    return false;
+
+  segments.clear();
+  for(unsigned int i = 0; i < ehdr.e_phnum; i++) {
+    Elf32_Phdr phdr;
+    size_t off = ehdr.e_phoff + (size_t)i * ehdr.e_phentsize;
+    if(off + sizeof(phdr) > img.size()) {
+      std::cout<<"[ELF]: ERROR: truncated program header table in "<<file<<std::endl;
+      return false;
+    }
+    memcpy(&phdr, &img[off], sizeof(phdr));
+
+    if(phdr.p_type != PT_LOAD || phdr.p_memsz == 0)
+      continue;
+    if(phdr.p_offset + phdr.p_filesz > img.size() || phdr.p_filesz > phdr.p_memsz) {
+      std::cout<<"[ELF]: ERROR: malformed segment "<<i<<" in "<<file<<std::endl;
+      return false;
+    }
+
+    // Segments are placed at their load (physical) address
+    ElfSegment seg;
+    seg.addr = phdr.p_paddr;
+    seg.data.assign(phdr.p_memsz, 0);
+    if(phdr.p_filesz != 0)
+      memcpy(&seg.data[0], &img[phdr.p_offset], phdr.p_filesz);
+    segments.push_back(seg);
+  }
+
+  return true;
+}
+
+bool elfReadEntry(const std::string &file, uint32_t &entry)
+{
+  std::vector<uint8_t> img;
+  Elf32_Ehdr ehdr;
+  if(!elfRead(file, img, ehdr))
+    return false;
+  entry = ehdr.e_entry;
+  return true;
+}
+
+static bool symbolBefore(const ElfSymbol &a, const ElfSymbol &b)
+{
+  return a.addr < b.addr;
+}
+
+bool elfLoadSymbols(const std::string &file, std::vector<ElfSymbol> &symbols)
+{
+  std::vector<uint8_t> img;
+  Elf32_Ehdr ehdr;
+  if(!elfRead(file, img, ehdr))
+    return false;
+
+  symbols.clear();
+  for(unsigned int i = 0; i < ehdr.e_shnum; i++) {
+    Elf32_Shdr shdr, strtab;
+    size_t off = ehdr.e_shoff + (size_t)i * ehdr.e_shentsize;
+    if(off + sizeof(shdr) > img.size()) {
+      std::cout<<"[ELF]: ERROR: truncated section header table in "<<file<<std::endl;
+      return false;
+    }
+    memcpy(&shdr, &img[off], sizeof(shdr));
+    if(shdr.sh_type != SHT_SYMTAB)
+      continue;
+
+    off = ehdr.e_shoff + (size_t)shdr.sh_link * ehdr.e_shentsize;
+    if(shdr.sh_link >= ehdr.e_shnum || off + sizeof(strtab) > img.size()) {
+      std::cout<<"[ELF]: ERROR: malformed symbol table in "<<file<<std::endl;
+      return false;
+    }
+    memcpy(&strtab, &img[off], sizeof(strtab));
+    if(shdr.sh_offset + shdr.sh_size > img.size() || strtab.sh_offset + strtab.sh_size > img.size()) {
+      std::cout<<"[ELF]: ERROR: malformed symbol table in "<<file<<std::endl;
+      return false;
+    }
+
+    for(size_t s = 0; s + sizeof(Elf32_Sym) <= shdr.sh_size; s += sizeof(Elf32_Sym)) {
+      Elf32_Sym sym;
+      memcpy(&sym, &img[shdr.sh_offset + s], sizeof(sym));
+      if(ELF32_ST_TYPE(sym.st_info) != STT_FUNC || sym.st_name >= strtab.sh_size)
+        continue;
+      ElfSymbol es;
+      es.addr = sym.st_value;
+      es.size = sym.st_size;
+      es.name.assign((const char *)&img[strtab.sh_offset + sym.st_name],
+                     strnlen((const char *)&img[strtab.sh_offset + sym.st_name], strtab.sh_size - sym.st_name));
+      symbols.push_back(es);
+    }
+  }
+
+  std::sort(symbols.begin(), symbols.end(), symbolBefore);
+  return true;
+}
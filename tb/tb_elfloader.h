@@ -0,0 +1,36 @@
+// Copyright EPFL contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef TB_ELFLOADER_H_
+#define TB_ELFLOADER_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Loadable segment of an ELF file. The data is already padded with zeros up
+// to the in-memory size of the segment (e.g. for .bss).
+struct ElfSegment {
+  uint32_t addr;
+  std::vector<uint8_t> data;
+};
+
+// Parses the PT_LOAD segments of a 32-bit little-endian RISC-V ELF file.
+// Returns false and prints the reason if the file cannot be used.
+bool elfLoadSegments(const std::string &file, std::vector<ElfSegment> &segments);
+
+// Reads the entry point of an ELF file
+bool elfReadEntry(const std::string &file, uint32_t &entry);
+
+// Function symbol of an ELF file
+struct ElfSymbol {
+  uint32_t addr;
+  uint32_t size;
+  std::string name;
+};
+
+// Reads the function symbols of the symbol table, sorted by address
+bool elfLoadSymbols(const std::string &file, std::vector<ElfSymbol> &symbols);
+
+#endif  // TB_ELFLOADER_H_
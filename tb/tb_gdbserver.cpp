@@ -0,0 +1,857 @@
+// Copyright EPFL contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "tb_gdbserver.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <iostream>
+#include <vector>
+
+// JTAG instructions of dmi_jtag_tap
+static const uint32_t kIrLength    = 5;
+static const uint32_t kIrIdcode    = 0x01;
+static const uint32_t kIrDtmcs     = 0x10;
+static const uint32_t kIrDmiAccess = 0x11;
+
+static const uint32_t kDmiOpNop   = 0;
+static const uint32_t kDmiOpRead  = 1;
+static const uint32_t kDmiOpWrite = 2;
+static const uint32_t kDmiBusy    = 3;
+
+// Debug module registers, RISC-V debug specification 0.13
+static const uint32_t kDmData0      = 0x04;
+static const uint32_t kDmControl    = 0x10;
+static const uint32_t kDmStatus     = 0x11;
+static const uint32_t kDmAbstractcs = 0x16;
+static const uint32_t kDmCommand    = 0x17;
+static const uint32_t kDmSbcs       = 0x38;
+static const uint32_t kDmSbaddress0 = 0x39;
+static const uint32_t kDmSbdata0    = 0x3c;
+
+static const uint32_t kDmcontrolHaltreq      = 1u << 31;
+static const uint32_t kDmcontrolResumereq    = 1u << 30;
+static const uint32_t kDmcontrolAckhavereset = 1u << 28;
+static const uint32_t kDmcontrolNdmreset     = 1u << 1;
+static const uint32_t kDmcontrolDmactive     = 1u << 0;
+
+static const uint32_t kDmstatusAllresumeack = 1u << 17;
+static const uint32_t kDmstatusAllhalted    = 1u << 9;
+
+static const uint32_t kAbstractcsBusy   = 1u << 12;
+static const uint32_t kAbstractcsCmderr = 7u << 8;
+static const uint32_t kCommandSize32    = 2u << 20;
+static const uint32_t kCommandTransfer  = 1u << 17;
+static const uint32_t kCommandWrite     = 1u << 16;
+
+static const uint32_t kSbcsBusyerror  = 1u << 22;
+static const uint32_t kSbcsBusy       = 1u << 21;
+static const uint32_t kSbcsReadonaddr = 1u << 20;
+static const uint32_t kSbcsError      = 7u << 12;
+
+static const uint32_t kDcsrEbreakm = 1u << 15;
+static const uint32_t kDcsrStep    = 1u << 2;
+
+// Trigger module: the first trigger matches the address of an instruction
+static const uint32_t kCsrTselect = 0x7a0;
+static const uint32_t kCsrTdata1  = 0x7a1;
+static const uint32_t kCsrTdata2  = 0x7a2;
+static const uint32_t kMcontrolDisabled = (2u << 28) | (1u << 27);
+static const uint32_t kMcontrolExecute  = kMcontrolDisabled | (1u << 12) | (1u << 6) | (1u << 2);
+
+static const unsigned int kMaxIdle  = 256;
+static const unsigned int kMaxPolls = 1000;
+
+// GDB register numbers of the RISC-V target
+static const uint32_t kGdbPc   = 32;
+static const uint32_t kGdbFpr  = 33;
+static const uint32_t kGdbCsr  = 65;
+
+static std::string hexWord(uint32_t value)
+{
+  char buf[9];
+  //registers are sent in target byte order
+  snprintf(buf, sizeof(buf), "%02x%02x%02x%02x", value & 0xff, (value >> 8) & 0xff, (value >> 16) & 0xff,
+           value >> 24);
+  return buf;
+}
+
+static std::string hexEncode(const uint8_t *data, size_t len)
+{
+  static const char digits[] = "0123456789abcdef";
+  std::string out;
+  for(size_t i = 0; i < len; i++) {
+    out += digits[data[i] >> 4];
+    out += digits[data[i] & 0xf];
+  }
+  return out;
+}
+
+static int hexDigit(char c)
+{
+  if(c >= '0' && c <= '9')
+    return c - '0';
+  if(c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  if(c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  return -1;
+}
+
+static bool hexDecode(const std::string &hex, std::vector<uint8_t> &data)
+{
+  data.clear();
+  for(size_t i = 0; i + 1 < hex.size(); i += 2) {
+    int hi = hexDigit(hex[i]), lo = hexDigit(hex[i + 1]);
+    if(hi < 0 || lo < 0)
+      return false;
+    data.push_back(hi << 4 | lo);
+  }
+  return hex.size() % 2 == 0;
+}
+
+// Value of a register in target byte order
+static bool hexToWord(const std::string &hex, uint32_t &value)
+{
+  std::vector<uint8_t> data;
+  if(!hexDecode(hex, data) || data.size() != 4)
+    return false;
+  value = data[0] | data[1] << 8 | data[2] << 16 | (uint32_t)data[3] << 24;
+  return true;
+}
+
+DebugModule::DebugModule(XHeepSim &sim) : sim_(sim), ir_(kIrIdcode), idle_(8), dmi_accesses_(0) {}
+
+bool DebugModule::jtagClock(bool tms, bool tdi)
+{
+  Vtestharness *dut = sim_.dut();
+
+  //the TAP samples on the rising edge of TCK and drives TDO on the falling one
+  dut->jtag_tms_i = tms;
+  dut->jtag_tdi_i = tdi;
+  dut->jtag_tck_i = 0;
+  sim_.tick(2);
+  bool tdo = dut->jtag_tdo_o;
+  dut->jtag_tck_i = 1;
+  sim_.tick(2);
+  return tdo;
+}
+
+void DebugModule::jtagIdle(unsigned int tcks)
+{
+  for(unsigned int i = 0; i < tcks; i++)
+    jtagClock(0, 0);
+}
+
+// Test-Logic-Reset, then Run-Test/Idle where every operation starts and ends
+void DebugModule::jtagReset()
+{
+  sim_.dut()->jtag_trst_ni = 0;
+  jtagIdle(2);
+  sim_.dut()->jtag_trst_ni = 1;
+  for(int i = 0; i < 5; i++)
+    jtagClock(1, 0);
+  jtagClock(0, 0);
+  ir_ = kIrIdcode;
+}
+
+void DebugModule::selectIr(uint32_t ir)
+{
+  if(ir == ir_)
+    return;
+  //Select-DR, Select-IR, Capture-IR, Shift-IR
+  jtagClock(1, 0);
+  jtagClock(1, 0);
+  jtagClock(0, 0);
+  jtagClock(0, 0);
+  for(uint32_t i = 0; i < kIrLength; i++)
+    jtagClock(i == kIrLength - 1, (ir >> i) & 1);
+  //Update-IR, Run-Test/Idle
+  jtagClock(1, 0);
+  jtagClock(0, 0);
+  ir_ = ir;
+}
+
+uint64_t DebugModule::shiftDr(uint64_t value, unsigned int bits)
+{
+  uint64_t out = 0;
+
+  //Select-DR, Capture-DR, Shift-DR
+  jtagClock(1, 0);
+  jtagClock(0, 0);
+  jtagClock(0, 0);
+  for(unsigned int i = 0; i < bits; i++)
+    out |= (uint64_t)jtagClock(i == bits - 1, (value >> i) & 1) << i;
+  //Update-DR, Run-Test/Idle
+  jtagClock(1, 0);
+  jtagClock(0, 0);
+  return out;
+}
+
+bool DebugModule::init()
+{
+  jtagReset();
+  uint32_t idcode = shiftDr(0, 32);
+  selectIr(kIrDtmcs);
+  uint32_t dtmcs = shiftDr(0, 32);
+
+  //version 0.13 with 7 address bits
+  if((dtmcs & 0xf) != 1 || ((dtmcs >> 4) & 0x3f) != 7) {
+    std::cout<<"[GDB]: ERROR: no debug transport module on the JTAG pins (dtmcs 0x"<<std::hex<<dtmcs<<std::dec
+             <<"), the model must be built with JTAG_DPI=0"<<std::endl;
+    return false;
+  }
+
+  uint32_t dmstatus;
+  if(!dmiWrite(kDmControl, kDmcontrolDmactive) || !dmiRead(kDmStatus, dmstatus))
+    return false;
+  std::cout<<"[GDB]: JTAG IDCODE 0x"<<std::hex<<idcode<<", debug module version "<<(dmstatus & 0xf)<<std::dec
+           <<std::endl;
+  return true;
+}
+
+// One DMI operation, then NOP scans until its result is out. The request is
+// never repeated: a busy status only means the scan came too early.
+bool DebugModule::dmiAccess(uint32_t op, uint32_t addr, uint32_t wdata, uint32_t &rdata)
+{
+  selectIr(kIrDmiAccess);
+  shiftDr((uint64_t)addr << 34 | (uint64_t)wdata << 2 | op, 41);
+
+  for(unsigned int i = 0; i < kMaxPolls; i++) {
+    jtagIdle(idle_);
+    uint64_t result = shiftDr(kDmiOpNop, 41);
+    uint32_t status = result & 3;
+    if(status == 0) {
+      rdata = result >> 2;
+      dmi_accesses_++;
+      return true;
+    }
+    //clears the sticky error of dmi_jtag
+    selectIr(kIrDtmcs);
+    shiftDr(1u << 16, 32);
+    selectIr(kIrDmiAccess);
+    if(status != kDmiBusy) {
+      std::cout<<"[GDB]: ERROR: DMI access to 0x"<<std::hex<<addr<<std::dec<<" failed"<<std::endl;
+      return false;
+    }
+    if(idle_ < kMaxIdle)
+      idle_ *= 2;
+  }
+  std::cout<<"[GDB]: ERROR: DMI access to 0x"<<std::hex<<addr<<std::dec<<" timed out"<<std::endl;
+  return false;
+}
+
+bool DebugModule::dmiRead(uint32_t addr, uint32_t &data)
+{
+  return dmiAccess(kDmiOpRead, addr, 0, data);
+}
+
+bool DebugModule::dmiWrite(uint32_t addr, uint32_t data)
+{
+  uint32_t unused;
+  return dmiAccess(kDmiOpWrite, addr, data, unused);
+}
+
+bool DebugModule::waitStatus(uint32_t mask, uint32_t &dmstatus)
+{
+  for(unsigned int i = 0; i < kMaxPolls; i++) {
+    if(!dmiRead(kDmStatus, dmstatus))
+      return false;
+    if((dmstatus & mask) == mask)
+      return true;
+  }
+  std::cout<<"[GDB]: ERROR: the hart does not respond (dmstatus 0x"<<std::hex<<dmstatus<<std::dec<<")"<<std::endl;
+  return false;
+}
+
+bool DebugModule::halt()
+{
+  uint32_t dmstatus;
+  return dmiWrite(kDmControl, kDmcontrolDmactive | kDmcontrolHaltreq) && waitStatus(kDmstatusAllhalted, dmstatus) &&
+         dmiWrite(kDmControl, kDmcontrolDmactive);
+}
+
+bool DebugModule::resume(bool step)
+{
+  uint32_t dcsr, dmstatus;
+
+  if(!readReg(kCsrDcsr, dcsr))
+    return false;
+  dcsr = step ? dcsr | kDcsrStep : dcsr & ~kDcsrStep;
+  return writeReg(kCsrDcsr, dcsr) && dmiWrite(kDmControl, kDmcontrolDmactive | kDmcontrolResumereq) &&
+         waitStatus(kDmstatusAllresumeack, dmstatus) && dmiWrite(kDmControl, kDmcontrolDmactive);
+}
+
+bool DebugModule::halted(bool &is_halted)
+{
+  uint32_t dmstatus;
+  if(!dmiRead(kDmStatus, dmstatus))
+    return false;
+  is_halted = (dmstatus & kDmstatusAllhalted) != 0;
+  return true;
+}
+
+bool DebugModule::command(uint32_t cmd)
+{
+  uint32_t abstractcs;
+
+  if(!dmiWrite(kDmCommand, cmd))
+    return false;
+  for(unsigned int i = 0; i < kMaxPolls; i++) {
+    if(!dmiRead(kDmAbstractcs, abstractcs))
+      return false;
+    if((abstractcs & kAbstractcsBusy) == 0)
+      break;
+  }
+  if(abstractcs & (kAbstractcsBusy | kAbstractcsCmderr)) {
+    dmiWrite(kDmAbstractcs, kAbstractcsCmderr);
+    return false;
+  }
+  return true;
+}
+
+bool DebugModule::readReg(uint32_t regno, uint32_t &value)
+{
+  return command(kCommandSize32 | kCommandTransfer | regno) && dmiRead(kDmData0, value);
+}
+
+bool DebugModule::writeReg(uint32_t regno, uint32_t value)
+{
+  return dmiWrite(kDmData0, value) && command(kCommandSize32 | kCommandTransfer | kCommandWrite | regno);
+}
+
+// Waits for the bus access and clears its errors
+bool DebugModule::sbaCheck()
+{
+  uint32_t sbcs;
+
+  for(unsigned int i = 0; i < kMaxPolls; i++) {
+    if(!dmiRead(kDmSbcs, sbcs))
+      return false;
+    if((sbcs & kSbcsBusy) == 0)
+      break;
+  }
+  if(sbcs & (kSbcsBusy | kSbcsBusyerror | kSbcsError)) {
+    dmiWrite(kDmSbcs, kSbcsBusyerror | kSbcsError);
+    return false;
+  }
+  return true;
+}
+
+bool DebugModule::sbaRead(uint32_t addr, unsigned int size, uint32_t &data)
+{
+  uint32_t sbaccess = size == 4 ? 2 : 0;
+  return dmiWrite(kDmSbcs, sbaccess << 17 | kSbcsReadonaddr) && dmiWrite(kDmSbaddress0, addr) && sbaCheck() &&
+         dmiRead(kDmSbdata0, data);
+}
+
+bool DebugModule::sbaWrite(uint32_t addr, unsigned int size, uint32_t data)
+{
+  uint32_t sbaccess = size == 4 ? 2 : 0;
+  return dmiWrite(kDmSbcs, sbaccess << 17) && dmiWrite(kDmSbaddress0, addr) && dmiWrite(kDmSbdata0, data) &&
+         sbaCheck();
+}
+
+bool DebugModule::readMem(uint32_t addr, uint8_t *data, size_t len)
+{
+  if(sim_.readMem(addr, data, len))
+    return true;
+  while(len > 0) {
+    uint32_t word;
+    unsigned int size = (addr & 3) == 0 && len >= 4 ? 4 : 1;
+    if(!sbaRead(addr, size, word))
+      return false;
+    for(unsigned int i = 0; i < size; i++)
+      data[i] = word >> (8 * i);
+    addr += size;
+    data += size;
+    len  -= size;
+  }
+  return true;
+}
+
+bool DebugModule::writeMem(uint32_t addr, const uint8_t *data, size_t len)
+{
+  if(sim_.writeMem(addr, data, len))
+    return true;
+  while(len > 0) {
+    uint32_t word = 0;
+    unsigned int size = (addr & 3) == 0 && len >= 4 ? 4 : 1;
+    for(unsigned int i = 0; i < size; i++)
+      word |= (uint32_t)data[i] << (8 * i);
+    if(!sbaWrite(addr, size, word))
+      return false;
+    addr += size;
+    data += size;
+    len  -= size;
+  }
+  return true;
+}
+
+bool DebugModule::resetHalt()
+{
+  uint32_t dmstatus;
+
+  if(!dmiWrite(kDmControl, kDmcontrolDmactive | kDmcontrolHaltreq | kDmcontrolNdmreset))
+    return false;
+  jtagIdle(16);
+  return dmiWrite(kDmControl, kDmcontrolDmactive | kDmcontrolHaltreq) && waitStatus(kDmstatusAllhalted, dmstatus) &&
+         dmiWrite(kDmControl, kDmcontrolDmactive | kDmcontrolAckhavereset);
+}
+
+GdbServer::GdbServer(XHeepSim &sim)
+    : sim_(sim), dm_(sim), listen_fd_(-1), fd_(-1), no_ack_(false), rx_pos_(0), hw_break_used_(false),
+      hw_break_addr_(0)
+{
+}
+
+GdbServer::~GdbServer()
+{
+  if(fd_ >= 0)
+    close(fd_);
+  if(listen_fd_ >= 0)
+    close(listen_fd_);
+}
+
+bool GdbServer::accept(int port)
+{
+  struct sockaddr_in addr;
+  int one = 1;
+
+  listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+  if(listen_fd_ < 0) {
+    std::cout<<"[GDB]: ERROR: cannot create the socket"<<std::endl;
+    return false;
+  }
+  setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family      = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port        = htons(port);
+  if(bind(listen_fd_, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(listen_fd_, 1) < 0) {
+    std::cout<<"[GDB]: ERROR: cannot listen on port "<<port<<std::endl;
+    return false;
+  }
+
+  std::cout<<"[GDB]: Listening on port "<<port<<", connect with: target remote localhost:"<<port<<std::endl;
+  fd_ = ::accept(listen_fd_, NULL, NULL);
+  if(fd_ < 0) {
+    std::cout<<"[GDB]: ERROR: accept failed"<<std::endl;
+    return false;
+  }
+  //the packets are small and latency bound
+  setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  close(listen_fd_);
+  listen_fd_ = -1;
+  return true;
+}
+
+int GdbServer::getChar()
+{
+  if(rx_pos_ == rx_.size()) {
+    char buf[4096];
+    ssize_t n = recv(fd_, buf, sizeof(buf), 0);
+    if(n <= 0)
+      return -1;
+    rx_.assign(buf, n);
+    rx_pos_ = 0;
+  }
+  return (unsigned char)rx_[rx_pos_++];
+}
+
+bool GdbServer::getPacket(std::string &packet)
+{
+  while(true) {
+    int c = getChar();
+    if(c < 0)
+      return false;
+    //acks and interrupts while the hart is already halted
+    if(c != '$')
+      continue;
+
+    unsigned int sum = 0;
+    packet.clear();
+    while((c = getChar()) >= 0 && c != '#') {
+      packet += (char)c;
+      sum += c;
+    }
+    int hi = getChar(), lo = getChar();
+    if(c < 0 || hi < 0 || lo < 0)
+      return false;
+    if(no_ack_)
+      return true;
+    bool ok = hexDigit(hi) * 16 + hexDigit(lo) == (int)(sum & 0xff);
+    if(send(fd_, ok ? "+" : "-", 1, MSG_NOSIGNAL) != 1)
+      return false;
+    if(ok)
+      return true;
+  }
+}
+
+bool GdbServer::putPacket(const std::string &packet)
+{
+  unsigned int sum = 0;
+  char checksum[4];
+
+  for(size_t i = 0; i < packet.size(); i++)
+    sum += (unsigned char)packet[i];
+  snprintf(checksum, sizeof(checksum), "#%02x", sum & 0xff);
+  std::string frame = "$" + packet + checksum;
+
+  while(true) {
+    if(send(fd_, frame.c_str(), frame.size(), MSG_NOSIGNAL) != (ssize_t)frame.size())
+      return false;
+    if(no_ack_)
+      return true;
+    int c;
+    while((c = getChar()) >= 0 && c != '+' && c != '-')
+      ;
+    if(c != '-')
+      return c == '+';
+  }
+}
+
+// Ctrl-C of GDB while the hart runs
+bool GdbServer::interrupted()
+{
+  struct pollfd pfd = {fd_, POLLIN, 0};
+
+  if(rx_pos_ == rx_.size() && poll(&pfd, 1, 0) <= 0)
+    return false;
+  int c = getChar();
+  return c == 0x03 || c < 0;
+}
+
+bool GdbServer::run(int port)
+{
+  uint32_t dcsr, pc;
+  std::string packet;
+  bool keep_running = true;
+
+  if(!dm_.init() || !accept(port))
+    return false;
+
+  //ebreak enters debug mode, this is how the software breakpoints stop
+  if(!dm_.halt() || !dm_.readReg(DebugModule::kCsrDcsr, dcsr) ||
+     !dm_.writeReg(DebugModule::kCsrDcsr, dcsr | kDcsrEbreakm) || !dm_.readReg(DebugModule::kCsrDpc, pc))
+    return false;
+  std::cout<<"[GDB]: GDB connected, hart halted at 0x"<<std::hex<<pc<<std::dec<<" (cycle "<<sim_.cycles()<<")"
+           <<std::endl;
+
+  while(getPacket(packet) && handle(packet, keep_running))
+    ;
+
+  //a lost connection leaves the hart running, as a detach
+  bool is_halted;
+  if(keep_running && !sim_.exited() && dm_.halted(is_halted) && is_halted) {
+    for(std::map<uint32_t, std::string>::iterator it = sw_breaks_.begin(); it != sw_breaks_.end(); ++it)
+      dm_.writeMem(it->first, (const uint8_t *)it->second.data(), it->second.size());
+    dm_.resume(false);
+  }
+  std::cout<<"[GDB]: GDB disconnected at cycle "<<sim_.cycles()<<", "<<dm_.dmiAccesses()<<" DMI accesses"
+           <<std::endl;
+  return keep_running;
+}
+
+std::string GdbServer::stopReply(bool interrupted)
+{
+  uint32_t dcsr;
+
+  if(interrupted)
+    return "T02";
+  if(!dm_.readReg(DebugModule::kCsrDcsr, dcsr))
+    return "T05";
+  switch((dcsr >> 6) & 7) {
+    case DebugModule::kCauseEbreak:
+      return "T05swbreak:;";
+    case DebugModule::kCauseTrigger:
+      return "T05hwbreak:;";
+    default:
+      return "T05";
+  }
+}
+
+// Runs the hart until it halts, GDB interrupts it or the firmware exits.
+// Returns false when the firmware exited.
+bool GdbServer::runHart(bool step, std::string &reply)
+{
+  bool is_halted = false;
+
+  if(!dm_.resume(step)) {
+    reply = "E01";
+    return true;
+  }
+  while(true) {
+    //a single step is over by the time the status is read
+    if(!step)
+      sim_.step(kPollCycles);
+    if(sim_.exited()) {
+      char buf[8];
+      snprintf(buf, sizeof(buf), "W%02x", sim_.exitValue() & 0xff);
+      reply = buf;
+      return false;
+    }
+    if(!step && interrupted()) {
+      reply = dm_.halt() ? stopReply(true) : "E01";
+      return true;
+    }
+    if(!dm_.halted(is_halted)) {
+      reply = "E01";
+      return true;
+    }
+    if(is_halted) {
+      reply = stopReply(false);
+      return true;
+    }
+  }
+}
+
+std::string GdbServer::readRegs()
+{
+  std::string regs;
+  uint32_t value;
+
+  for(uint32_t i = 0; i < 32; i++) {
+    if(!dm_.readReg(DebugModule::kRegGpr + i, value))
+      return "E01";
+    regs += hexWord(value);
+  }
+  if(!dm_.readReg(DebugModule::kCsrDpc, value))
+    return "E01";
+  return regs + hexWord(value);
+}
+
+// Z0/z0 patch an ebreak into the memory, Z1/z1 use the trigger module
+bool GdbServer::breakpoint(bool insert, const std::string &args, std::string &reply)
+{
+  unsigned int type, addr, kind;
+
+  if(sscanf(args.c_str(), "%u,%x,%x", &type, &addr, &kind) != 3)
+    return false;
+
+  if(type == 0) {
+    static const uint8_t ebreak[4]   = {0x73, 0x00, 0x10, 0x00};
+    static const uint8_t c_ebreak[2] = {0x02, 0x90};
+    std::map<uint32_t, std::string>::iterator it = sw_breaks_.find(addr);
+    if(insert) {
+      uint8_t orig[4];
+      if(it != sw_breaks_.end()) {
+        reply = "OK";
+        return true;
+      }
+      if((kind != 2 && kind != 4) || !dm_.readMem(addr, orig, kind) ||
+         !dm_.writeMem(addr, kind == 2 ? c_ebreak : ebreak, kind)) {
+        reply = "E01";
+        return true;
+      }
+      sw_breaks_[addr] = std::string((const char *)orig, kind);
+    } else if(it != sw_breaks_.end()) {
+      if(!dm_.writeMem(addr, (const uint8_t *)it->second.data(), it->second.size())) {
+        reply = "E01";
+        return true;
+      }
+      sw_breaks_.erase(it);
+    }
+    reply = "OK";
+    return true;
+  }
+
+  if(type == 1) {
+    bool ok;
+    if(insert) {
+      if(hw_break_used_ && hw_break_addr_ != addr) {
+        //a single trigger
+        reply = "E01";
+        return true;
+      }
+      ok = dm_.writeReg(kCsrTselect, 0) && dm_.writeReg(kCsrTdata2, addr) && dm_.writeReg(kCsrTdata1, kMcontrolExecute);
+    } else {
+      ok = !hw_break_used_ || hw_break_addr_ != addr ||
+           (dm_.writeReg(kCsrTselect, 0) && dm_.writeReg(kCsrTdata1, kMcontrolDisabled));
+    }
+    if(ok && (insert || hw_break_addr_ == addr)) {
+      hw_break_used_ = insert;
+      hw_break_addr_ = addr;
+    }
+    reply = ok ? "OK" : "E01";
+    return true;
+  }
+
+  //watchpoints are not supported
+  return false;
+}
+
+std::string GdbServer::monitor(const std::string &cmd)
+{
+  std::string out;
+
+  if(cmd == "reset halt" || cmd == "reset") {
+    uint32_t dcsr;
+    bool ok = dm_.resetHalt() && dm_.readReg(DebugModule::kCsrDcsr, dcsr) &&
+              dm_.writeReg(DebugModule::kCsrDcsr, dcsr | kDcsrEbreakm);
+    if(ok && cmd == "reset")
+      ok = dm_.resume(false);
+    if(!ok)
+      return "E01";
+    out = "System reset at cycle " + std::to_string(sim_.cycles()) + "\n";
+  } else if(cmd == "cycles") {
+    out = std::to_string(sim_.cycles()) + "\n";
+  } else {
+    out = "Commands: reset, reset halt, cycles\n";
+  }
+  return hexEncode((const uint8_t *)out.data(), out.size());
+}
+
+bool GdbServer::handle(const std::string &packet, bool &keep_running)
+{
+  std::string reply;
+  std::string args = packet.size() > 1 ? packet.substr(1) : "";
+  unsigned int addr, len, regno;
+  uint32_t value;
+  std::vector<uint8_t> data;
+  bool session = true;
+
+  switch(packet.empty() ? 0 : packet[0]) {
+    case '?':
+      reply = "S05";
+      break;
+
+    case 'g':
+      reply = readRegs();
+      break;
+
+    case 'G':
+      reply = "OK";
+      for(uint32_t i = 0; i <= kGdbPc && reply == "OK"; i++) {
+        if(args.size() < 8 * (i + 1) || !hexToWord(args.substr(8 * i, 8), value) ||
+           !dm_.writeReg(i == kGdbPc ? DebugModule::kCsrDpc : DebugModule::kRegGpr + i, value))
+          reply = "E01";
+      }
+      break;
+
+    case 'p':
+    case 'P': {
+      size_t eq = args.find('=');
+      regno     = strtoul(args.c_str(), NULL, 16);
+      if(regno < kGdbPc)
+        regno += DebugModule::kRegGpr;
+      else if(regno == kGdbPc)
+        regno = DebugModule::kCsrDpc;
+      else if(regno < kGdbCsr)
+        regno = DebugModule::kRegFpr + regno - kGdbFpr;
+      else
+        regno -= kGdbCsr;
+      if(packet[0] == 'p')
+        reply = dm_.readReg(regno, value) ? hexWord(value) : "E01";
+      else
+        reply = eq != std::string::npos && hexToWord(args.substr(eq + 1), value) && dm_.writeReg(regno, value) ? "OK"
+                                                                                                                : "E01";
+      break;
+    }
+
+    case 'm':
+      if(sscanf(args.c_str(), "%x,%x", &addr, &len) != 2) {
+        reply = "E01";
+        break;
+      }
+      data.resize(len);
+      reply = dm_.readMem(addr, data.data(), len) ? hexEncode(data.data(), len) : "E01";
+      break;
+
+    case 'M':
+    case 'X': {
+      size_t colon = args.find(':');
+      if(colon == std::string::npos || sscanf(args.c_str(), "%x,%x", &addr, &len) != 2) {
+        reply = "E01";
+        break;
+      }
+      if(packet[0] == 'M') {
+        if(!hexDecode(args.substr(colon + 1), data)) {
+          reply = "E01";
+          break;
+        }
+      } else {
+        //binary data, '}' escapes the next byte
+        for(size_t i = colon + 1; i < args.size(); i++)
+          data.push_back(args[i] == '}' && i + 1 < args.size() ? args[++i] ^ 0x20 : args[i]);
+      }
+      reply = data.size() == len && (len == 0 || dm_.writeMem(addr, data.data(), len)) ? "OK" : "E01";
+      break;
+    }
+
+    case 'c':
+    case 's':
+      if(!args.empty() && (sscanf(args.c_str(), "%x", &addr) != 1 || !dm_.writeReg(DebugModule::kCsrDpc, addr))) {
+        reply = "E01";
+        break;
+      }
+      session = runHart(packet[0] == 's', reply);
+      break;
+
+    case 'Z':
+    case 'z':
+      breakpoint(packet[0] == 'Z', args, reply);
+      break;
+
+    case 'D':
+      for(std::map<uint32_t, std::string>::iterator it = sw_breaks_.begin(); it != sw_breaks_.end(); ++it)
+        dm_.writeMem(it->first, (const uint8_t *)it->second.data(), it->second.size());
+      sw_breaks_.clear();
+      reply   = dm_.resume(false) ? "OK" : "E01";
+      session = false;
+      break;
+
+    case 'k':
+      keep_running = false;
+      return false;
+
+    case 'H':
+    case 'T':
+      reply = "OK";
+      break;
+
+    case 'q':
+      if(packet.compare(0, 11, "qSupported:") == 0 || packet == "qSupported")
+        reply = "PacketSize=4000;QStartNoAckMode+;swbreak+;hwbreak+";
+      else if(packet == "qAttached")
+        reply = "1";
+      else if(packet == "qC")
+        reply = "QC1";
+      else if(packet == "qfThreadInfo")
+        reply = "m1";
+      else if(packet == "qsThreadInfo")
+        reply = "l";
+      else if(packet.compare(0, 6, "qRcmd,") == 0 && hexDecode(packet.substr(6), data))
+        reply = monitor(std::string(data.begin(), data.end()));
+      break;
+
+    case 'Q':
+      if(packet == "QStartNoAckMode") {
+        putPacket("OK");
+        no_ack_ = true;
+        return true;
+      }
+      break;
+
+    case 'v':
+      if(packet.compare(0, 5, "vKill") == 0) {
+        putPacket("OK");
+        keep_running = false;
+        return false;
+      }
+      break;
+
+    default:
+      break;
+  }
+
+  return putPacket(reply) && session;
+}
@@ -0,0 +1,120 @@
+// Copyright EPFL contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef TB_GDBSERVER_H_
+#define TB_GDBSERVER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <map>
+#include <string>
+
+#include "tb_sim.h"
+
+// RISC-V debug module (dm_obi_top) reached through the JTAG pins of the
+// testharness. The TAP is clocked from C++ at half the system clock, one JTAG
+// bit costs two cycles instead of a socket round trip of remote_bitbang.
+// Needs a model built with JTAG_DPI=0, the default.
+class DebugModule {
+ public:
+  // Registers of the abstract commands
+  static const uint32_t kRegGpr  = 0x1000;
+  static const uint32_t kRegFpr  = 0x1020;
+  static const uint32_t kCsrDcsr = 0x7b0;
+  static const uint32_t kCsrDpc  = 0x7b1;
+
+  // dcsr.cause
+  enum HaltCause { kCauseEbreak = 1, kCauseTrigger = 2, kCauseHaltReq = 3, kCauseStep = 4 };
+
+  explicit DebugModule(XHeepSim &sim);
+
+  // Resets the TAP and activates the debug module
+  bool init();
+
+  bool halt();
+  // Resumes the hart, which halts again after one instruction with step
+  bool resume(bool step);
+  bool halted(bool &is_halted);
+
+  bool readReg(uint32_t regno, uint32_t &value);
+  bool writeReg(uint32_t regno, uint32_t value);
+
+  // The SRAM goes through the backdoor, the rest through the system bus
+  // access of the debug module
+  bool readMem(uint32_t addr, uint8_t *data, size_t len);
+  bool writeMem(uint32_t addr, const uint8_t *data, size_t len);
+
+  // Resets the system with ndmreset and halts the hart on its first instruction
+  bool resetHalt();
+
+  uint64_t dmiAccesses() const { return dmi_accesses_; }
+
+ private:
+  bool jtagClock(bool tms, bool tdi);
+  void jtagIdle(unsigned int tcks);
+  void jtagReset();
+  void selectIr(uint32_t ir);
+  uint64_t shiftDr(uint64_t value, unsigned int bits);
+
+  bool dmiRead(uint32_t addr, uint32_t &data);
+  bool dmiWrite(uint32_t addr, uint32_t data);
+  bool dmiAccess(uint32_t op, uint32_t addr, uint32_t wdata, uint32_t &rdata);
+  bool waitStatus(uint32_t mask, uint32_t &dmstatus);
+  bool command(uint32_t cmd);
+  bool sbaRead(uint32_t addr, unsigned int size, uint32_t &data);
+  bool sbaWrite(uint32_t addr, unsigned int size, uint32_t data);
+  bool sbaCheck();
+
+  XHeepSim &sim_;
+  uint32_t ir_;
+  unsigned int idle_;
+  uint64_t dmi_accesses_;
+};
+
+// GDB remote serial protocol server, replaces the OpenOCD and remote_bitbang
+// chain of docs/source/How_to/Debug.md. It owns the simulation while GDB is
+// connected: the model only runs between a continue or a step and the next
+// halt.
+class GdbServer {
+ public:
+  explicit GdbServer(XHeepSim &sim);
+  ~GdbServer();
+
+  // Waits for GDB on port and serves it until it detaches, kills the
+  // simulation or the firmware exits. Returns false if the simulation has
+  // to stop.
+  bool run(int port);
+
+ private:
+  // Cycles run between two checks of the hart and of the socket
+  static const vluint64_t kPollCycles = 2000;
+
+  bool accept(int port);
+  int getChar();
+  bool getPacket(std::string &packet);
+  bool putPacket(const std::string &packet);
+  bool interrupted();
+
+  // Returns false once the session is over
+  bool handle(const std::string &packet, bool &keep_running);
+  bool runHart(bool step, std::string &reply);
+  std::string stopReply(bool interrupted);
+  std::string readRegs();
+  bool breakpoint(bool insert, const std::string &args, std::string &reply);
+  std::string monitor(const std::string &cmd);
+
+  XHeepSim &sim_;
+  DebugModule dm_;
+  int listen_fd_;
+  int fd_;
+  bool no_ack_;
+  std::string rx_;
+  size_t rx_pos_;
+  // Software breakpoints and the instructions they replaced
+  std::map<uint32_t, std::string> sw_breaks_;
+  bool hw_break_used_;
+  uint32_t hw_break_addr_;
+};
+
+#endif  // TB_GDBSERVER_H_
@@ -0,0 +1,178 @@
+// Copyright EPFL contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "tb_hostcall.h"
+
+#include <iostream>
+#include <vector>
+
+// Layout of host_call_t
+static const uint32_t kDescOp   = 0;
+static const uint32_t kDescArg  = 4;
+static const uint32_t kDescRet  = 16;
+static const uint32_t kDescSize = 20;
+
+// Same value as HOST_CALL_UNSERVED, also returned for unknown services
+static const int32_t kUnserved = (int32_t)0x80000000;
+
+HostCall tb_hostcall;
+
+std::string HostCall::input_file_;
+std::string HostCall::output_file_;
+
+// Chunk of the copies between the streams and the SRAM
+static const uint32_t kChunk = 4096;
+
+static uint32_t word(const uint8_t *p)
+{
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+HostCall::HostCall()
+    : mem_(NULL), output_(true), input_(NULL), output_stream_(NULL), calls_(0), bytes_written_(0), bytes_read_(0),
+      bytes_streamed_(0)
+{
+}
+
+HostCall::~HostCall()
+{
+  restartStreams("");
+}
+
+void HostCall::setStreams(const std::string &input, const std::string &output)
+{
+  input_file_  = input;
+  output_file_ = output;
+}
+
+void HostCall::restartStreams(const std::string &output_suffix)
+{
+  if(input_ != NULL)
+    fclose(input_);
+  if(output_stream_ != NULL)
+    fclose(output_stream_);
+  input_         = NULL;
+  output_stream_ = NULL;
+  output_suffix_ = output_suffix;
+}
+
+// Opened on the first access, so that the workers of the batch mode do not
+// share the file offsets
+FILE *HostCall::stream(uint32_t fd)
+{
+  if(fd == kFdInput && input_ == NULL && !input_file_.empty()) {
+    input_ = fopen(input_file_.c_str(), "rb");
+    if(input_ == NULL)
+      std::cout<<"[HOSTCALL]: ERROR: cannot open the input stream "<<input_file_<<std::endl;
+  }
+  if(fd == kFdOutput && output_stream_ == NULL && !output_file_.empty()) {
+    std::string file = output_file_ + output_suffix_;
+    output_stream_   = fopen(file.c_str(), "wb");
+    if(output_stream_ == NULL)
+      std::cout<<"[HOSTCALL]: ERROR: cannot open the output stream "<<file<<std::endl;
+  }
+  return fd == kFdInput ? input_ : output_stream_;
+}
+
+bool HostCall::init(MemoryPort *mem)
+{
+  mem_ = mem;
+  return mem_ != NULL;
+}
+
+void HostCall::serve(uint32_t desc)
+{
+  uint8_t call[kDescSize];
+  int32_t ret;
+
+  if(mem_ == NULL || !mem_->read(desc, call, kDescSize)) {
+    std::cout<<"[HOSTCALL]: WARNING: descriptor at 0x"<<std::hex<<desc<<std::dec<<" is not in the SRAM"<<std::endl;
+    return;
+  }
+  calls_++;
+
+  switch(word(call + kDescOp)) {
+    case kWrite:
+      ret = write(word(call + kDescArg), word(call + kDescArg + 4), word(call + kDescArg + 8));
+      break;
+    case kRead:
+      ret = read(word(call + kDescArg), word(call + kDescArg + 4), word(call + kDescArg + 8));
+      break;
+    default:
+      ret = kUnserved;
+      break;
+  }
+
+  for(int i = 0; i < 4; i++)
+    call[kDescRet + i] = (uint32_t)ret >> (8 * i);
+  mem_->write(desc + kDescRet, call + kDescRet, 4);
+}
+
+// Buffers outside of the SRAM (e.g. strings in flash) are refused, the
+// software then falls back to the UART
+int32_t HostCall::write(uint32_t fd, uint32_t buf, uint32_t len)
+{
+  if(fd == kFdOutput) {
+    uint8_t data[kChunk];
+    FILE *f = output_ ? stream(fd) : NULL;
+    if(output_ && f == NULL)
+      return -1;
+    for(uint32_t done = 0; done < len; done += kChunk) {
+      uint32_t n = len - done < kChunk ? len - done : kChunk;
+      if(!mem_->read(buf + done, data, n) || (f != NULL && fwrite(data, 1, n, f) != n))
+        return -1;
+    }
+    bytes_streamed_ += len;
+    return len;
+  }
+
+  std::vector<char> data(len);
+
+  if((fd != 1 && fd != 2) || !mem_->read(buf, (uint8_t *)data.data(), len))
+    return -1;
+  if(!output_)
+    return len;
+
+  std::ostream &os = fd == 1 ? std::cout : std::cerr;
+  os.write(data.data(), len);
+  os.flush();
+  bytes_written_ += len;
+  return len;
+}
+
+// Returns 0 at the end of the input
+int32_t HostCall::read(uint32_t fd, uint32_t buf, uint32_t len)
+{
+  uint8_t data[kChunk];
+  uint32_t done = 0;
+  FILE *f = fd == kFdInput ? stream(fd) : NULL;
+
+  if(f == NULL)
+    return -1;
+  while(done < len) {
+    size_t n = fread(data, 1, len - done < kChunk ? len - done : kChunk, f);
+    if(n == 0)
+      break;
+    if(!mem_->write(buf + done, data, n))
+      return -1;
+    done += n;
+  }
+  bytes_read_ += done;
+  return done;
+}
+
+void HostCall::printStats() const
+{
+  if(calls_ == 0)
+    return;
+  std::cout<<"[HOSTCALL]: "<<calls_<<" host calls, "<<bytes_written_<<" bytes written";
+  if(bytes_read_ != 0 || bytes_streamed_ != 0)
+    std::cout<<", "<<bytes_read_<<" bytes read from and "<<bytes_streamed_<<" bytes written to the data streams";
+  std::cout<<std::endl;
+}
+
+extern "C" void tb_host_call(int desc)
+{
+  tb_hostcall.serve((uint32_t)desc);
+}
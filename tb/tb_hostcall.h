@@ -0,0 +1,78 @@
+// Copyright EPFL contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef TB_HOSTCALL_H_
+#define TB_HOSTCALL_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+
+#include "tb_sram.h"
+
+// Host calls requested by the software (sw/device/lib/runtime/host_call.h).
+//
+// The software writes the address of a descriptor {op, arg[3], ret} to the
+// HOST_CALL register of soc_ctrl, tb_util.svh calls serve() on the clock edge
+// of the write. The arguments and the buffers are accessed straight in the
+// SRAM banks, so a call costs a handful of cycles whatever its size. The
+// instruction set simulator (tb_iss_soc.h) serves them from its own memory.
+//
+// host_read and host_write stream the data of the firmware from and to host
+// files, set with setStreams for all the instances. Each instance opens them
+// on its first call, so that the ISS of the lockstep check reads the same
+// data as the model.
+class HostCall {
+ public:
+  // Services, numbered as host_call_op_t
+  enum Op { kWrite = 1, kRead = 2 };
+  // File descriptors of the data streams, as HOST_CALL_FD_INPUT/OUTPUT
+  static const uint32_t kFdInput  = 0;
+  static const uint32_t kFdOutput = 3;
+
+  HostCall();
+  ~HostCall();
+
+  // Files behind the input and output streams, empty for none
+  static void setStreams(const std::string &input, const std::string &output);
+  // Starts the input again and appends suffix to the name of the output,
+  // between the images of the batch mode
+  void restartStreams(const std::string &output_suffix);
+
+  // Memory of the descriptors and of the buffers
+  bool init(MemoryPort *mem);
+  // Without output the calls still return as if served, e.g. for the ISS
+  // running in lockstep with the model that prints
+  void setOutput(bool enable) { output_ = enable; }
+
+  void serve(uint32_t desc);
+
+  void printStats() const;
+
+ private:
+  int32_t write(uint32_t fd, uint32_t buf, uint32_t len);
+  int32_t read(uint32_t fd, uint32_t buf, uint32_t len);
+  FILE *stream(uint32_t fd);
+
+  static std::string input_file_;
+  static std::string output_file_;
+
+  MemoryPort *mem_;
+  bool output_;
+  FILE *input_;
+  FILE *output_stream_;
+  std::string output_suffix_;
+  uint64_t calls_;
+  uint64_t bytes_written_;
+  uint64_t bytes_read_;
+  uint64_t bytes_streamed_;
+
+  HostCall(const HostCall &);
+  HostCall &operator=(const HostCall &);
+};
+
+// Instance served by the tb_host_call DPI function
+extern HostCall tb_hostcall;
+
+#endif  // TB_HOSTCALL_H_
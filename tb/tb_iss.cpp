@@ -0,0 +1,899 @@
+// Copyright EPFL contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "tb_iss.h"
+
+#include <fenv.h>
+#include <inttypes.h>
+#include <math.h>
+#include <string.h>
+#include <iostream>
+
+// Control and status registers
+enum {
+  kCsrFflags        = 0x001,
+  kCsrFrm           = 0x002,
+  kCsrFcsr          = 0x003,
+  kCsrMstatus       = 0x300,
+  kCsrMisa          = 0x301,
+  kCsrMie           = 0x304,
+  kCsrMtvec         = 0x305,
+  kCsrMcountinhibit = 0x320,
+  kCsrMscratch      = 0x340,
+  kCsrMepc          = 0x341,
+  kCsrMcause        = 0x342,
+  kCsrMtval         = 0x343,
+  kCsrMip           = 0x344,
+  kCsrMcycle        = 0xb00,
+  kCsrMinstret      = 0xb02,
+  kCsrMcycleh       = 0xb80,
+  kCsrMinstreth     = 0xb82,
+  kCsrCycle         = 0xc00,
+  kCsrInstret       = 0xc02,
+  kCsrCycleh        = 0xc80,
+  kCsrInstreth      = 0xc82,
+};
+
+static const uint32_t kMstatusMie  = 1u << 3;
+static const uint32_t kMstatusMpie = 1u << 7;
+static const uint32_t kMstatusMpp  = 3u << 11;
+static const uint32_t kMstatusFs   = 3u << 13;
+// software, timer, external and fast interrupts
+static const uint32_t kMieMask     = 0xffff0888;
+
+static const uint32_t kCauseFetchFault = 1;
+static const uint32_t kCauseIllegal    = 2;
+static const uint32_t kCauseBreakpoint = 3;
+static const uint32_t kCauseEcall      = 11;
+static const uint32_t kCauseIrq        = 0x80000000;
+
+static const uint32_t kCanonicalNan = 0x7fc00000;
+// fflags
+static const uint32_t kFlagNX = 1, kFlagUF = 2, kFlagOF = 4, kFlagDZ = 8, kFlagNV = 16;
+
+static inline int32_t sext(uint32_t value, int bits)
+{
+  return (int32_t)(value << (32 - bits)) >> (32 - bits);
+}
+
+static inline float toFloat(uint32_t bits)
+{
+  float f;
+  memcpy(&f, &bits, 4);
+  return f;
+}
+
+static inline uint32_t toBits(float f)
+{
+  uint32_t bits;
+  memcpy(&bits, &f, 4);
+  return bits;
+}
+
+static inline bool isNan(uint32_t bits)
+{
+  return (bits & 0x7f800000) == 0x7f800000 && (bits & 0x7fffff) != 0;
+}
+
+static inline bool isSignalingNan(uint32_t bits)
+{
+  return isNan(bits) && (bits & 0x400000) == 0;
+}
+
+// The NaN results of RISC-V are always the canonical one
+static inline uint32_t canonical(float f)
+{
+  uint32_t bits = toBits(f);
+  return isNan(bits) ? kCanonicalNan : bits;
+}
+
+IssCore::IssCore(IssSoc &soc, bool has_f)
+    : soc_(soc), ram_(soc.ram()), ram_start_(soc.ramStart()), ram_size_(soc.ramSize()), has_f_(has_f),
+      irq_enabled_(true), trace_(NULL), cycle_(0), sleep_cycles_(0), wfi_(false), deadlock_(false)
+{
+  reset(0);
+}
+
+void IssCore::reset(uint32_t pc)
+{
+  memset(x_, 0, sizeof(x_));
+  memset(f_, 0, sizeof(f_));
+  pc_            = pc;
+  instr_         = 0;
+  mstatus_       = kMstatusMpp;
+  mie_           = 0;
+  mtvec_         = 0;
+  mscratch_      = 0;
+  mepc_          = 0;
+  mcause_        = 0;
+  mtval_         = 0;
+  mcountinhibit_ = 0;
+  fflags_        = 0;
+  frm_           = 0;
+  mcycle_        = 0;
+  instret_       = 0;
+  wfi_           = false;
+  deadlock_      = false;
+}
+
+bool IssCore::pendingIrq(uint32_t &cause) const
+{
+  uint32_t pending = soc_.irqs() & mie_;
+
+  if(!(mstatus_ & kMstatusMie) || pending == 0)
+    return false;
+  //fast interrupts first, lowest line first, then external, software and timer
+  if(pending >> 16)
+    cause = 16 + __builtin_ctz(pending >> 16);
+  else if(pending & (1u << 11))
+    cause = 11;
+  else if(pending & (1u << 3))
+    cause = 3;
+  else
+    cause = 7;
+  return true;
+}
+
+void IssCore::trap(uint32_t cause, uint32_t tval)
+{
+  mepc_   = pc_;
+  mcause_ = cause;
+  mtval_  = tval;
+  mstatus_ = (mstatus_ & ~(kMstatusMie | kMstatusMpie)) | ((mstatus_ & kMstatusMie) ? kMstatusMpie : 0);
+  pc_ = mtvec_ & ~3u;
+  if((cause & kCauseIrq) && (mtvec_ & 3) == 1)
+    pc_ += 4 * (cause & ~kCauseIrq);
+}
+
+// Jumps to the next event of the SoC until an enabled interrupt is pending,
+// false if nothing will ever wake the hart
+bool IssCore::sleep()
+{
+  while(!(soc_.irqs() & mie_)) {
+    uint64_t next = soc_.nextEvent();
+    if(next == IssSoc::kNever)
+      return false;
+    sleep_cycles_ += next - cycle_;
+    cycle_ = next;
+    soc_.advance(cycle_);
+  }
+  return true;
+}
+
+IssCore::Result IssCore::step()
+{
+  uint32_t insn, len, cause;
+  uint32_t pc = pc_;
+  Result result;
+
+  if(irq_enabled_ && pendingIrq(cause)) {
+    trap(cause | kCauseIrq, 0);
+    result = kTrapped;
+  } else if(!fetch(insn, len)) {
+    trap(kCauseFetchFault, pc_);
+    result = kTrapped;
+  } else {
+    result = execute(insn, len);
+  }
+
+  if(result == kStalled || result == kReplayMismatch)
+    return result;
+
+  if(result == kRetired) {
+    if(!(mcountinhibit_ & 4))
+      instret_++;
+    if(trace_ != NULL)
+      fprintf(trace_, "%" PRIu64 " %08x %08x\n", cycle_, pc, instr_);
+  }
+  if(!(mcountinhibit_ & 1))
+    mcycle_++;
+  if(++cycle_ >= soc_.nextEvent())
+    soc_.advance(cycle_);
+
+  if(wfi_) {
+    wfi_ = false;
+    if(irq_enabled_ && !soc_.exited() && !sleep())
+      deadlock_ = true;
+  }
+  return result;
+}
+
+IssCore::StopReason IssCore::run(uint64_t max_instr)
+{
+  for(uint64_t n = 0; max_instr == 0 || n < max_instr; n++) {
+    Result result = step();
+    if(soc_.exited())
+      return kExit;
+    if(deadlock_)
+      return kDeadlock;
+    if(result == kStalled || result == kReplayMismatch)
+      return kStop;
+  }
+  return kMaxInstr;
+}
+
+bool IssCore::fetch(uint32_t &insn, uint32_t &len)
+{
+  uint32_t offset = pc_ - ram_start_;
+  uint16_t half;
+
+  if(offset < ram_size_ - 3) {
+    memcpy(&insn, ram_ + offset, 4);
+  } else {
+    if(!soc_.fetch(pc_, half))
+      return false;
+    insn = half;
+    if((half & 3) == 3) {
+      if(!soc_.fetch(pc_ + 2, half))
+        return false;
+      insn |= (uint32_t)half << 16;
+    }
+  }
+
+  if((insn & 3) == 3) {
+    len    = 4;
+    instr_ = insn;
+  } else {
+    len    = 2;
+    instr_ = insn & 0xffff;
+    insn   = expand(instr_);
+  }
+  return true;
+}
+
+inline IssSoc::Access IssCore::load(uint32_t addr, unsigned int size, uint32_t &value)
+{
+  uint32_t offset = addr - ram_start_;
+
+  if(offset < ram_size_ && size <= ram_size_ - offset) {
+    value = 0;
+    memcpy(&value, ram_ + offset, size);
+    return IssSoc::kOk;
+  }
+  soc_.advance(cycle_);
+  return soc_.load(addr, size, value);
+}
+
+inline void IssCore::store(uint32_t addr, unsigned int size, uint32_t value)
+{
+  uint32_t offset = addr - ram_start_;
+
+  if(store_hook_)
+    store_hook_(addr, size, value);
+  if(offset < ram_size_ && size <= ram_size_ - offset) {
+    memcpy(ram_ + offset, &value, size);
+    return;
+  }
+  soc_.advance(cycle_);
+  soc_.store(addr, size, value);
+}
+
+// Encoders of the expanded compressed instructions
+static inline uint32_t encI(int32_t imm, uint32_t rs1, uint32_t f3, uint32_t rd, uint32_t op)
+{
+  return ((uint32_t)imm & 0xfff) << 20 | rs1 << 15 | f3 << 12 | rd << 7 | op;
+}
+
+static inline uint32_t encS(int32_t imm, uint32_t rs2, uint32_t rs1, uint32_t f3, uint32_t op)
+{
+  return (((uint32_t)imm >> 5) & 0x7f) << 25 | rs2 << 20 | rs1 << 15 | f3 << 12 | ((uint32_t)imm & 0x1f) << 7 | op;
+}
+
+static inline uint32_t encR(uint32_t f7, uint32_t rs2, uint32_t rs1, uint32_t f3, uint32_t rd, uint32_t op)
+{
+  return f7 << 25 | rs2 << 20 | rs1 << 15 | f3 << 12 | rd << 7 | op;
+}
+
+static inline uint32_t encB(int32_t imm, uint32_t rs2, uint32_t rs1, uint32_t f3)
+{
+  uint32_t i = (uint32_t)imm;
+  return ((i >> 12) & 1) << 31 | ((i >> 5) & 0x3f) << 25 | rs2 << 20 | rs1 << 15 | f3 << 12 |
+         ((i >> 1) & 0xf) << 8 | ((i >> 11) & 1) << 7 | 0x63;
+}
+
+static inline uint32_t encJ(int32_t imm, uint32_t rd)
+{
+  uint32_t i = (uint32_t)imm;
+  return ((i >> 20) & 1) << 31 | ((i >> 1) & 0x3ff) << 21 | ((i >> 11) & 1) << 20 |
+         ((i >> 12) & 0xff) << 12 | rd << 7 | 0x6f;
+}
+
+// RV32C to RV32I(F), 0 for the illegal encodings
+uint32_t IssCore::expand(uint16_t c)
+{
+  uint32_t f3   = (c >> 13) & 7;
+  uint32_t rd   = (c >> 7) & 31;
+  uint32_t rs2  = (c >> 2) & 31;
+  uint32_t rdp  = 8 + ((c >> 2) & 7);
+  uint32_t rs1p = 8 + ((c >> 7) & 7);
+  int32_t imm6  = sext(((c >> 7) & 0x20) | ((c >> 2) & 0x1f), 6);
+  int32_t imm;
+
+  switch(c & 3) {
+    case 0: {
+      uint32_t uimm = ((c >> 7) & 0x38) | ((c >> 4) & 4) | ((c << 1) & 0x40);
+      switch(f3) {
+        case 0:
+          imm = ((c >> 7) & 0x30) | ((c >> 1) & 0x3c0) | ((c >> 4) & 4) | ((c >> 2) & 8);
+          return imm == 0 ? 0 : encI(imm, 2, 0, rdp, 0x13);
+        case 2: return encI(uimm, rs1p, 2, rdp, 0x03);
+        case 3: return encI(uimm, rs1p, 2, rdp, 0x07);
+        case 6: return encS(uimm, rdp, rs1p, 2, 0x23);
+        case 7: return encS(uimm, rdp, rs1p, 2, 0x27);
+        default: return 0;
+      }
+    }
+    case 1:
+      switch(f3) {
+        case 0: return encI(imm6, rd, 0, rd, 0x13);
+        case 1:
+        case 5:
+          imm = sext(((c >> 1) & 0x800) | ((c << 2) & 0x400) | ((c >> 1) & 0x300) | ((c << 1) & 0x80) |
+                     ((c >> 1) & 0x40) | ((c << 3) & 0x20) | ((c >> 7) & 0x10) | ((c >> 2) & 0xe), 12);
+          return encJ(imm, f3 == 1 ? 1 : 0);
+        case 2: return encI(imm6, 0, 0, rd, 0x13);
+        case 3:
+          if(rd == 2) {
+            imm = sext(((c >> 3) & 0x200) | ((c >> 2) & 0x10) | ((c << 1) & 0x40) | ((c << 4) & 0x180) |
+                       ((c << 3) & 0x20), 10);
+            return imm == 0 ? 0 : encI(imm, 2, 0, 2, 0x13);
+          }
+          return imm6 == 0 ? 0 : ((uint32_t)imm6 << 12) | rd << 7 | 0x37;
+        case 4: {
+          uint32_t shamt = ((c >> 7) & 0x20) | ((c >> 2) & 0x1f);
+          switch((c >> 10) & 3) {
+            case 0: return (shamt & 0x20) ? 0 : encR(0x00, shamt, rs1p, 5, rs1p, 0x13);
+            case 1: return (shamt & 0x20) ? 0 : encR(0x20, shamt, rs1p, 5, rs1p, 0x13);
+            case 2: return encI(imm6, rs1p, 7, rs1p, 0x13);
+            default: {
+              static const uint32_t f3s[4] = {0, 4, 6, 7};
+              if(c & 0x1000)
+                return 0;
+              return encR(((c >> 5) & 3) == 0 ? 0x20 : 0x00, rdp, rs1p, f3s[(c >> 5) & 3], rs1p, 0x33);
+            }
+          }
+        }
+        case 6:
+        case 7:
+          imm = sext(((c >> 4) & 0x100) | ((c << 1) & 0xc0) | ((c << 3) & 0x20) | ((c >> 7) & 0x18) |
+                     ((c >> 2) & 6), 9);
+          return encB(imm, 0, rs1p, f3 == 6 ? 0 : 1);
+      }
+      return 0;
+    default: {
+      uint32_t lwsp = ((c >> 7) & 0x20) | ((c >> 2) & 0x1c) | ((c << 4) & 0xc0);
+      uint32_t swsp = ((c >> 7) & 0x3c) | ((c >> 1) & 0xc0);
+      switch(f3) {
+        case 0: return (c & 0x1000) ? 0 : encR(0x00, rs2, rd, 1, rd, 0x13);
+        case 2: return rd == 0 ? 0 : encI(lwsp, 2, 2, rd, 0x03);
+        case 3: return encI(lwsp, 2, 2, rd, 0x07);
+        case 4:
+          if(!(c & 0x1000)) {
+            if(rs2 == 0)
+              return rd == 0 ? 0 : encI(0, rd, 0, 0, 0x67);
+            return encR(0x00, rs2, 0, 0, rd, 0x33);
+          }
+          if(rs2 == 0)
+            return rd == 0 ? 0x00100073 : encI(0, rd, 0, 1, 0x67);
+          return encR(0x00, rs2, rd, 0, rd, 0x33);
+        case 6: return encS(swsp, rs2, 2, 2, 0x23);
+        case 7: return encS(swsp, rs2, 2, 2, 0x27);
+        default: return 0;
+      }
+    }
+  }
+}
+
+IssCore::Result IssCore::execute(uint32_t insn, uint32_t len)
+{
+  uint32_t op   = insn & 0x7f;
+  uint32_t rd   = (insn >> 7) & 31;
+  uint32_t f3   = (insn >> 12) & 7;
+  uint32_t rs1  = (insn >> 15) & 31;
+  uint32_t rs2  = (insn >> 20) & 31;
+  uint32_t f7   = insn >> 25;
+  uint32_t a    = x_[rs1];
+  uint32_t b    = x_[rs2];
+  uint32_t next = pc_ + len;
+  uint32_t value = 0;
+  bool write_rd = true;
+
+  switch(op) {
+    case 0x37:  // lui
+      value = insn & 0xfffff000;
+      break;
+    case 0x17:  // auipc
+      value = pc_ + (insn & 0xfffff000);
+      break;
+    case 0x6f: {  // jal
+      int32_t imm = sext(((insn >> 31) & 1) << 20 | ((insn >> 12) & 0xff) << 12 | ((insn >> 20) & 1) << 11 |
+                         ((insn >> 21) & 0x3ff) << 1, 21);
+      value = next;
+      next  = pc_ + imm;
+      break;
+    }
+    case 0x67:  // jalr
+      if(f3 != 0)
+        goto illegal;
+      value = next;
+      next  = (a + sext(insn >> 20, 12)) & ~1u;
+      break;
+    case 0x63: {  // branches
+      int32_t imm = sext(((insn >> 31) & 1) << 12 | ((insn >> 7) & 1) << 11 | ((insn >> 25) & 0x3f) << 5 |
+                         ((insn >> 8) & 0xf) << 1, 13);
+      bool taken;
+      switch(f3) {
+        case 0: taken = a == b; break;
+        case 1: taken = a != b; break;
+        case 4: taken = (int32_t)a < (int32_t)b; break;
+        case 5: taken = (int32_t)a >= (int32_t)b; break;
+        case 6: taken = a < b; break;
+        case 7: taken = a >= b; break;
+        default: goto illegal;
+      }
+      if(taken)
+        next = pc_ + imm;
+      write_rd = false;
+      break;
+    }
+    case 0x03: {  // loads
+      static const unsigned int sizes[8] = {1, 2, 4, 0, 1, 2, 0, 0};
+      IssSoc::Access access;
+      if(sizes[f3] == 0)
+        goto illegal;
+      access = load(a + sext(insn >> 20, 12), sizes[f3], value);
+      if(access == IssSoc::kStall)
+        return kStalled;
+      if(access == IssSoc::kReplayMismatch)
+        return kReplayMismatch;
+      if(f3 == 0)
+        value = sext(value, 8);
+      else if(f3 == 1)
+        value = sext(value, 16);
+      break;
+    }
+    case 0x07: {  // flw
+      IssSoc::Access access;
+      if(!has_f_ || f3 != 2)
+        goto illegal;
+      access = load(a + sext(insn >> 20, 12), 4, value);
+      if(access == IssSoc::kStall)
+        return kStalled;
+      if(access == IssSoc::kReplayMismatch)
+        return kReplayMismatch;
+      f_[rd]   = value;
+      write_rd = false;
+      break;
+    }
+    case 0x23:  // stores
+      if(f3 > 2)
+        goto illegal;
+      store(a + sext(f7 << 5 | rd, 12), 1u << f3, b);
+      write_rd = false;
+      break;
+    case 0x27:  // fsw
+      if(!has_f_ || f3 != 2)
+        goto illegal;
+      store(a + sext(f7 << 5 | rd, 12), 4, f_[rs2]);
+      write_rd = false;
+      break;
+    case 0x13: {  // register-immediate
+      int32_t imm = sext(insn >> 20, 12);
+      switch(f3) {
+        case 0: value = a + imm; break;
+        case 2: value = (int32_t)a < imm; break;
+        case 3: value = a < (uint32_t)imm; break;
+        case 4: value = a ^ imm; break;
+        case 6: value = a | imm; break;
+        case 7: value = a & imm; break;
+        case 1:
+          if(f7 != 0)
+            goto illegal;
+          value = a << rs2;
+          break;
+        default:
+          if(f7 == 0x00)
+            value = a >> rs2;
+          else if(f7 == 0x20)
+            value = (int32_t)a >> rs2;
+          else
+            goto illegal;
+          break;
+      }
+      break;
+    }
+    case 0x33:  // register-register
+      if(f7 == 0x01) {
+        switch(f3) {
+          case 0: value = a * b; break;
+          case 1: value = ((int64_t)(int32_t)a * (int64_t)(int32_t)b) >> 32; break;
+          case 2: value = ((int64_t)(int32_t)a * (int64_t)(uint64_t)b) >> 32; break;
+          case 3: value = ((uint64_t)a * (uint64_t)b) >> 32; break;
+          case 4:
+            if(b == 0)
+              value = ~0u;
+            else if(a == 0x80000000 && b == ~0u)
+              value = a;
+            else
+              value = (int32_t)a / (int32_t)b;
+            break;
+          case 5: value = b == 0 ? ~0u : a / b; break;
+          case 6:
+            if(b == 0)
+              value = a;
+            else if(a == 0x80000000 && b == ~0u)
+              value = 0;
+            else
+              value = (int32_t)a % (int32_t)b;
+            break;
+          default: value = b == 0 ? a : a % b; break;
+        }
+      } else if(f7 == 0x00) {
+        switch(f3) {
+          case 0: value = a + b; break;
+          case 1: value = a << (b & 31); break;
+          case 2: value = (int32_t)a < (int32_t)b; break;
+          case 3: value = a < b; break;
+          case 4: value = a ^ b; break;
+          case 5: value = a >> (b & 31); break;
+          case 6: value = a | b; break;
+          default: value = a & b; break;
+        }
+      } else if(f7 == 0x20 && f3 == 0) {
+        value = a - b;
+      } else if(f7 == 0x20 && f3 == 5) {
+        value = (int32_t)a >> (b & 31);
+      } else {
+        goto illegal;
+      }
+      break;
+    case 0x0f:  // fence, fence.i
+      write_rd = false;
+      break;
+    case 0x73:  // system
+      if(f3 == 0) {
+        write_rd = false;
+        if(insn == 0x00000073) {
+          trap(kCauseEcall, 0);
+          return kTrapped;
+        } else if(insn == 0x00100073) {
+          trap(kCauseBreakpoint, pc_);
+          return kTrapped;
+        } else if(insn == 0x30200073) {  // mret
+          mstatus_ = (mstatus_ & ~kMstatusMie) | ((mstatus_ & kMstatusMpie) ? kMstatusMie : 0) | kMstatusMpie;
+          next = mepc_;
+        } else if(insn == 0x10500073) {  // wfi
+          wfi_ = true;
+        } else {
+          goto illegal;
+        }
+      } else if(f3 != 4) {
+        uint32_t csr = insn >> 20;
+        uint32_t src = (f3 & 4) ? rs1 : a;
+        uint32_t old;
+        if(!csrRead(csr, old))
+          goto illegal;
+        //csrrs and csrrc with no bits to change do not write
+        if((f3 & 3) == 1) {
+          if(!csrWrite(csr, src))
+            goto illegal;
+        } else if(rs1 != 0) {
+          if(!csrWrite(csr, (f3 & 3) == 2 ? old | src : old & ~src))
+            goto illegal;
+        }
+        value = old;
+      } else {
+        goto illegal;
+      }
+      break;
+    case 0x43:
+    case 0x47:
+    case 0x4b:
+    case 0x4f:
+    case 0x53:
+      if(!has_f_)
+        goto illegal;
+      return executeFp(insn);
+    default:
+      goto illegal;
+  }
+
+  if(write_rd && rd != 0)
+    x_[rd] = value;
+  pc_ = next;
+  return kRetired;
+
+illegal:
+  trap(kCauseIllegal, instr_);
+  return kTrapped;
+}
+
+// Rounding mode of the instruction, the dynamic one comes from frm
+uint32_t IssCore::readFrm(uint32_t rm, bool &ok) const
+{
+  if(rm == 7)
+    rm = frm_;
+  ok = rm <= 4;
+  return rm;
+}
+
+void IssCore::setFlags()
+{
+  int except = fetestexcept(FE_ALL_EXCEPT);
+
+  if(except & FE_INEXACT)   fflags_ |= kFlagNX;
+  if(except & FE_UNDERFLOW) fflags_ |= kFlagUF;
+  if(except & FE_OVERFLOW)  fflags_ |= kFlagOF;
+  if(except & FE_DIVBYZERO) fflags_ |= kFlagDZ;
+  if(except & FE_INVALID)   fflags_ |= kFlagNV;
+}
+
+IssCore::Result IssCore::executeFp(uint32_t insn)
+{
+  // RNE, RTZ, RDN, RUP, RMM (approximated by RNE)
+  static const int kRound[5] = {FE_TONEAREST, FE_TOWARDZERO, FE_DOWNWARD, FE_UPWARD, FE_TONEAREST};
+  uint32_t op  = insn & 0x7f;
+  uint32_t rd  = (insn >> 7) & 31;
+  uint32_t f3  = (insn >> 12) & 7;
+  uint32_t rs1 = (insn >> 15) & 31;
+  uint32_t rs2 = (insn >> 20) & 31;
+  uint32_t f7  = insn >> 25;
+  uint32_t fa  = f_[rs1];
+  uint32_t fb  = f_[rs2];
+  float a      = toFloat(fa);
+  float b      = toFloat(fb);
+  uint32_t rm;
+  bool ok;
+
+  //single precision only
+  if((f7 & 3) != 0)
+    goto illegal;
+
+  rm = readFrm(f3, ok);
+  if(op != 0x53) {
+    float c = toFloat(f_[insn >> 27]);
+    float r;
+    if(!ok)
+      goto illegal;
+    fesetround(kRound[rm]);
+    feclearexcept(FE_ALL_EXCEPT);
+    switch(op) {
+      case 0x43: r = fmaf(a, b, c); break;    // fmadd
+      case 0x47: r = fmaf(a, b, -c); break;   // fmsub
+      case 0x4b: r = fmaf(-a, b, c); break;   // fnmsub
+      default:   r = fmaf(-a, b, -c); break;  // fnmadd
+    }
+    setFlags();
+    fesetround(FE_TONEAREST);
+    f_[rd] = canonical(r);
+    pc_ += 4;
+    return kRetired;
+  }
+
+  switch(f7) {
+    case 0x00:
+    case 0x04:
+    case 0x08:
+    case 0x0c:
+    case 0x2c: {
+      float r;
+      if(!ok || (f7 == 0x2c && rs2 != 0))
+        goto illegal;
+      fesetround(kRound[rm]);
+      feclearexcept(FE_ALL_EXCEPT);
+      switch(f7) {
+        case 0x00: r = a + b; break;
+        case 0x04: r = a - b; break;
+        case 0x08: r = a * b; break;
+        case 0x0c: r = a / b; break;
+        default:   r = sqrtf(a); break;
+      }
+      setFlags();
+      fesetround(FE_TONEAREST);
+      f_[rd] = canonical(r);
+      break;
+    }
+    case 0x10:  // fsgnj, fsgnjn, fsgnjx
+      if(f3 > 2)
+        goto illegal;
+      f_[rd] = (fa & 0x7fffffff) |
+               (f3 == 0 ? fb & 0x80000000 : f3 == 1 ? ~fb & 0x80000000 : (fa ^ fb) & 0x80000000);
+      break;
+    case 0x14: {  // fmin, fmax
+      if(f3 > 1)
+        goto illegal;
+      if(isSignalingNan(fa) || isSignalingNan(fb))
+        fflags_ |= kFlagNV;
+      if(isNan(fa) && isNan(fb))
+        f_[rd] = kCanonicalNan;
+      else if(isNan(fa))
+        f_[rd] = fb;
+      else if(isNan(fb))
+        f_[rd] = fa;
+      else if(a == b)  // -0 is below +0
+        f_[rd] = f3 == 0 ? fa | fb : fa & fb;
+      else
+        f_[rd] = (f3 == 0 ? a < b : a > b) ? fa : fb;
+      break;
+    }
+    case 0x50: {  // fle, flt, feq
+      uint32_t r = 0;
+      if(f3 > 2)
+        goto illegal;
+      if(isNan(fa) || isNan(fb)) {
+        if(f3 != 2 || isSignalingNan(fa) || isSignalingNan(fb))
+          fflags_ |= kFlagNV;
+      } else {
+        r = f3 == 0 ? a <= b : f3 == 1 ? a < b : a == b;
+      }
+      if(rd != 0)
+        x_[rd] = r;
+      break;
+    }
+    case 0x60: {  // fcvt.w.s, fcvt.wu.s
+      uint32_t r;
+      float t;
+      if(!ok || rs2 > 1)
+        goto illegal;
+      fesetround(kRound[rm]);
+      t = rm == 4 ? roundf(a) : nearbyintf(a);
+      fesetround(FE_TONEAREST);
+      if(rs2 == 0) {
+        if(isNan(fa) || t >= 2147483648.0f) {
+          r = 0x7fffffff;
+          fflags_ |= kFlagNV;
+        } else if(t < -2147483648.0f) {
+          r = 0x80000000;
+          fflags_ |= kFlagNV;
+        } else {
+          r = (uint32_t)(int32_t)t;
+          if(t != a)
+            fflags_ |= kFlagNX;
+        }
+      } else {
+        if(isNan(fa) || t >= 4294967296.0f) {
+          r = 0xffffffff;
+          fflags_ |= kFlagNV;
+        } else if(t < 0.0f) {
+          r = 0;
+          fflags_ |= kFlagNV;
+        } else {
+          r = (uint32_t)t;
+          if(t != a)
+            fflags_ |= kFlagNX;
+        }
+      }
+      if(rd != 0)
+        x_[rd] = r;
+      break;
+    }
+    case 0x68: {  // fcvt.s.w, fcvt.s.wu
+      float r;
+      if(!ok || rs2 > 1)
+        goto illegal;
+      fesetround(kRound[rm]);
+      feclearexcept(FE_ALL_EXCEPT);
+      r = rs2 == 0 ? (float)(int32_t)x_[rs1] : (float)x_[rs1];
+      setFlags();
+      fesetround(FE_TONEAREST);
+      f_[rd] = toBits(r);
+      break;
+    }
+    case 0x70:  // fmv.x.w, fclass
+      if(rs2 != 0 || f3 > 1)
+        goto illegal;
+      if(rd != 0) {
+        if(f3 == 0) {
+          x_[rd] = fa;
+        } else {
+          uint32_t sign = fa >> 31, exp = (fa >> 23) & 0xff, frac = fa & 0x7fffff;
+          if(exp == 0xff)
+            x_[rd] = frac == 0 ? (sign ? 1u << 0 : 1u << 7) : (frac & 0x400000 ? 1u << 9 : 1u << 8);
+          else if(exp == 0)
+            x_[rd] = frac == 0 ? (sign ? 1u << 3 : 1u << 4) : (sign ? 1u << 2 : 1u << 5);
+          else
+            x_[rd] = sign ? 1u << 1 : 1u << 6;
+        }
+      }
+      break;
+    case 0x78:  // fmv.w.x
+      if(rs2 != 0 || f3 != 0)
+        goto illegal;
+      f_[rd] = x_[rs1];
+      break;
+    default:
+      goto illegal;
+  }
+
+  pc_ += 4;
+  return kRetired;
+
+illegal:
+  trap(kCauseIllegal, instr_);
+  return kTrapped;
+}
+
+bool IssCore::csrRead(uint32_t csr, uint32_t &value)
+{
+  switch(csr) {
+    case kCsrFflags:
+    case kCsrFrm:
+    case kCsrFcsr:
+      if(!has_f_)
+        return false;
+      value = csr == kCsrFflags ? fflags_ : csr == kCsrFrm ? frm_ : (frm_ << 5) | fflags_;
+      return true;
+    case kCsrMstatus:       value = mstatus_; return true;
+    case kCsrMisa:
+      // MXL = 32, I, M, C and F
+      value = 0x40000000 | (1u << 8) | (1u << 12) | (1u << 2) | (has_f_ ? 1u << 5 : 0);
+      return true;
+    case kCsrMie:           value = mie_; return true;
+    case kCsrMtvec:         value = mtvec_; return true;
+    case kCsrMcountinhibit: value = mcountinhibit_; return true;
+    case kCsrMscratch:      value = mscratch_; return true;
+    case kCsrMepc:          value = mepc_; return true;
+    case kCsrMcause:        value = mcause_; return true;
+    case kCsrMtval:         value = mtval_; return true;
+    case kCsrMip:           value = soc_.irqs() & kMieMask; return true;
+    case kCsrMcycle:
+    case kCsrCycle:         value = (uint32_t)mcycle_; return true;
+    case kCsrMcycleh:
+    case kCsrCycleh:        value = (uint32_t)(mcycle_ >> 32); return true;
+    case kCsrMinstret:
+    case kCsrInstret:       value = (uint32_t)instret_; return true;
+    case kCsrMinstreth:
+    case kCsrInstreth:      value = (uint32_t)(instret_ >> 32); return true;
+    default:
+      break;
+  }
+
+  value = 0;
+  //the hardware performance counters and their events, and the ids
+  if((csr >= 0xb03 && csr <= 0xb1f) || (csr >= 0xb83 && csr <= 0xb9f) || (csr >= 0x323 && csr <= 0x33f) ||
+     (csr >= 0xc03 && csr <= 0xc1f) || (csr >= 0xc83 && csr <= 0xc9f) || (csr >= 0xf11 && csr <= 0xf15))
+    return true;
+  if(warned_csrs_.insert(csr).second)
+    std::cout<<"[ISS]: WARNING: CSR 0x"<<std::hex<<csr<<std::dec<<" is not modelled, it reads as 0"<<std::endl;
+  return true;
+}
+
+bool IssCore::csrWrite(uint32_t csr, uint32_t value)
+{
+  //read-only CSRs
+  if(((csr >> 10) & 3) == 3)
+    return false;
+
+  switch(csr) {
+    case kCsrFflags:
+    case kCsrFrm:
+    case kCsrFcsr:
+      if(!has_f_)
+        return false;
+      if(csr == kCsrFflags)
+        fflags_ = value & 0x1f;
+      else if(csr == kCsrFrm)
+        frm_ = value & 7;
+      else {
+        fflags_ = value & 0x1f;
+        frm_    = (value >> 5) & 7;
+      }
+      return true;
+    case kCsrMstatus:       mstatus_ = (value & (kMstatusMie | kMstatusMpie | kMstatusFs)) | kMstatusMpp; return true;
+    case kCsrMie:           mie_ = value & kMieMask; return true;
+    case kCsrMtvec:         mtvec_ = value & ~2u; return true;
+    case kCsrMcountinhibit: mcountinhibit_ = value & 5; return true;
+    case kCsrMscratch:      mscratch_ = value; return true;
+    case kCsrMepc:          mepc_ = value & ~1u; return true;
+    case kCsrMcause:        mcause_ = value; return true;
+    case kCsrMtval:         mtval_ = value; return true;
+    case kCsrMcycle:        mcycle_ = (mcycle_ & ~0xffffffffULL) | value; return true;
+    case kCsrMcycleh:       mcycle_ = (mcycle_ & 0xffffffffULL) | ((uint64_t)value << 32); return true;
+    case kCsrMinstret:      instret_ = (instret_ & ~0xffffffffULL) | value; return true;
+    case kCsrMinstreth:     instret_ = (instret_ & 0xffffffffULL) | ((uint64_t)value << 32); return true;
+    default:
+      //misa, mip and the unmodelled ones ignore the writes
+      return true;
+  }
+}
@@ -0,0 +1,120 @@
+// Copyright EPFL contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef TB_ISS_H_
+#define TB_ISS_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <functional>
+#include <set>
+
+#include "tb_iss_soc.h"
+
+// Instruction set simulator of the x-heep CPU.
+//
+// Functional RV32IMC hart in machine mode, with the Zicsr registers used by
+// the runtime (traps, vectored mtvec, counters) and optionally the F
+// extension computed with the floats of the host. Every instruction takes one
+// cycle; a WFI with nothing pending jumps to the next event of the SoC, and
+// mcycle does not count the skipped cycles, as the core clock is gated.
+//
+//   IssSoc soc;
+//   IssCore core(soc, true);
+//   soc.loadElf("main.elf", entry);
+//   core.reset(entry);
+//   core.run(0);
+//
+// The custom extensions of the cores (COREV_PULP, CORE-V-XIF, Zfinx) are not
+// modelled and raise illegal instruction exceptions.
+class IssCore {
+ public:
+  enum Result {
+    kRetired,         // the instruction was executed
+    kTrapped,         // it raised an exception, or an interrupt was taken first
+    kStalled,         // a replayed read is not there yet, nothing changed
+    kReplayMismatch,  // the replayed read is for another address
+  };
+
+  enum StopReason { kExit, kMaxInstr, kDeadlock, kStop };
+
+  IssCore(IssSoc &soc, bool has_f);
+
+  void reset(uint32_t pc);
+  Result step();
+  // Runs until the software exits, for at most max_instr instructions
+  // (0 = no limit)
+  StopReason run(uint64_t max_instr);
+
+  // Takes the trap of cause (bit 31 set for the interrupts) as the hardware
+  // would before the instruction at pc()
+  void trap(uint32_t cause, uint32_t tval);
+  // Without the interrupts of the SoC the hart only traps on exceptions and
+  // a WFI does not wait, e.g. when the traps come from the RTL in lockstep
+  void setIrqEnabled(bool enable) { irq_enabled_ = enable; }
+  // Commit trace, one "cycle pc instr" line per retired instruction
+  void setTrace(FILE *trace) { trace_ = trace; }
+  // Called with every data store of the hart, RAM included
+  void setStoreHook(const std::function<void(uint32_t, unsigned int, uint32_t)> &hook) { store_hook_ = hook; }
+
+  uint32_t pc() const { return pc_; }
+  uint32_t reg(unsigned int i) const { return x_[i]; }
+  uint32_t mtvec() const { return mtvec_; }
+  uint32_t instr() const { return instr_; }
+  uint64_t instret() const { return instret_; }
+  uint64_t cycles() const { return cycle_; }
+  uint64_t sleepCycles() const { return sleep_cycles_; }
+
+ private:
+  Result execute(uint32_t insn, uint32_t len);
+  Result executeFp(uint32_t insn);
+  static uint32_t expand(uint16_t c);
+
+  bool fetch(uint32_t &insn, uint32_t &len);
+  IssSoc::Access load(uint32_t addr, unsigned int size, uint32_t &value);
+  void store(uint32_t addr, unsigned int size, uint32_t value);
+
+  bool csrRead(uint32_t csr, uint32_t &value);
+  bool csrWrite(uint32_t csr, uint32_t value);
+  bool pendingIrq(uint32_t &cause) const;
+  bool sleep();
+
+  uint32_t readFrm(uint32_t rm, bool &ok) const;
+  void setFlags();
+
+  IssSoc &soc_;
+  uint8_t *ram_;
+  uint32_t ram_start_;
+  uint32_t ram_size_;
+  bool has_f_;
+  bool irq_enabled_;
+  FILE *trace_;
+  std::function<void(uint32_t, unsigned int, uint32_t)> store_hook_;
+
+  uint32_t x_[32];
+  uint32_t f_[32];
+  uint32_t pc_;
+  uint32_t instr_;
+  uint64_t cycle_;
+  uint64_t sleep_cycles_;
+  // a WFI retired, the hart sleeps at the end of the step
+  bool wfi_;
+  bool deadlock_;
+
+  uint32_t mstatus_;
+  uint32_t mie_;
+  uint32_t mtvec_;
+  uint32_t mscratch_;
+  uint32_t mepc_;
+  uint32_t mcause_;
+  uint32_t mtval_;
+  uint32_t mcountinhibit_;
+  uint32_t fflags_;
+  uint32_t frm_;
+  uint64_t mcycle_;
+  uint64_t instret_;
+  std::set<uint32_t> warned_csrs_;
+};
+
+#endif  // TB_ISS_H_
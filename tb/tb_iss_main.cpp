@@ -0,0 +1,112 @@
+// Copyright EPFL contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Standalone instruction set simulator of x-heep, see tb_iss.h.
+//
+//   iss-sim +elf=main.elf [+max_instr=N] [+iss_trace=trace.log] [+fpu=0]
+//           [+host_in=data.bin] [+host_out=results.bin]
+//           [+dump_mem=<addr>:<len>:<file>] [+golden=<file>]
+//
+// The UART output goes to uart0.log, as with the RTL simulation, and the run
+// fails when the firmware does not exit.
+
+#include "tb_iss.h"
+#include "tb_iss_soc.h"
+#include "tb_memdump.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <iostream>
+#include <string>
+
+static std::string getCmdOption(int argc, char* argv[], const std::string& option)
+{
+  std::string cmd;
+  for(int i = 0; i < argc; ++i) {
+    std::string arg = argv[i];
+    if(arg.find(option) == 0)
+      cmd = arg.substr(option.length());
+  }
+  return cmd;
+}
+
+int main(int argc, char * argv[])
+{
+  std::string elf, arg_max_instr, trace_file, arg_fpu;
+  uint64_t max_instr = 0;
+  uint32_t entry;
+  FILE *trace = NULL;
+
+  elf = getCmdOption(argc, argv, "+elf=");
+  if(elf.empty()) {
+    std::cout<<"[ISS]: ERROR: No firmware specified, use +elf=<file>"<<std::endl;
+    return EXIT_FAILURE;
+  }
+
+  arg_max_instr = getCmdOption(argc, argv, "+max_instr=");
+  if(!arg_max_instr.empty()) {
+    max_instr = stoull(arg_max_instr);
+    std::cout<<"[ISS]: Max instructions is "<<max_instr<<std::endl;
+  }
+
+  arg_fpu = getCmdOption(argc, argv, "+fpu=");
+  bool has_f = arg_fpu.compare("0") != 0;
+
+  IssSoc soc;
+  IssCore core(soc, has_f);
+
+  if(!soc.loadElf(elf, entry) || !soc.setUartLog("uart0.log"))
+    return EXIT_FAILURE;
+  std::cout<<"[ISS]: loading ELF firmware  "<<elf<<", entry 0x"<<std::hex<<entry<<std::dec
+           <<(has_f ? "" : ", no FPU")<<std::endl;
+
+  //data streams of host_read and host_write
+  HostCall::setStreams(getCmdOption(argc, argv, "+host_in="), getCmdOption(argc, argv, "+host_out="));
+
+  //SRAM regions written at exit, compared with +golden=
+  MemDump mem_dump;
+  if(!getCmdOption(argc, argv, "+dump_mem=").empty()) {
+    if(!mem_dump.parse(getCmdOption(argc, argv, "+dump_mem=")) ||
+       !mem_dump.setGolden(getCmdOption(argc, argv, "+golden=")))
+      return EXIT_FAILURE;
+  }
+
+  trace_file = getCmdOption(argc, argv, "+iss_trace=");
+  if(!trace_file.empty()) {
+    trace = fopen(trace_file.c_str(), "w");
+    if(trace == NULL) {
+      std::cout<<"[ISS]: ERROR: cannot open "<<trace_file<<std::endl;
+      return EXIT_FAILURE;
+    }
+    core.setTrace(trace);
+  }
+
+  core.reset(entry);
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  IssCore::StopReason reason = core.run(max_instr);
+  double run_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  if(trace != NULL)
+    fclose(trace);
+
+  if(reason == IssCore::kMaxInstr)
+    std::cout<<"[ISS]: Stopped after "<<max_instr<<" instructions"<<std::endl;
+  else if(reason == IssCore::kDeadlock)
+    std::cout<<"[ISS]: ERROR: WFI at 0x"<<std::hex<<core.pc()<<std::dec
+             <<" with no interrupt that can wake the hart"<<std::endl;
+
+  soc.printStats();
+  std::cout<<"[ISS]: Executed "<<core.instret()<<" instructions in "<<core.cycles()<<" cycles ("
+           <<core.sleepCycles()<<" sleeping) in "<<run_time<<" s ("
+           <<(run_time > 0 ? core.instret() / run_time / 1e6 : 0)<<" MIPS)"<<std::endl;
+
+  bool dump_ok = !mem_dump.enabled() || mem_dump.dump(soc);
+
+  if(!soc.exited())
+    return EXIT_FAILURE;
+  std::cout<<"Program Finished with value "<<soc.exitValue()<<std::endl;
+  return dump_ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,729 @@
+// Copyright EPFL contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "tb_iss_soc.h"
+
+#include "tb_elfloader.h"
+
+#include "core_v_mini_mcu.h"
+#include "dma_regs.h"
+#include "fast_intr_ctrl_regs.h"
+#include "rv_plic_regs.h"
+#include "rv_timer_regs.h"
+#include "soc_ctrl_regs.h"
+#include "uart_regs.h"
+
+#include <string.h>
+#include <algorithm>
+#include <iostream>
+
+// Registers of one rv_timer hart, relative to its CFG register
+static const uint32_t kTimerStride  = RV_TIMER_CFG1_REG_OFFSET - RV_TIMER_CFG0_REG_OFFSET;
+static const uint32_t kTimerCfg     = 0;
+static const uint32_t kTimerVLower  = RV_TIMER_TIMER_V_LOWER0_REG_OFFSET - RV_TIMER_CFG0_REG_OFFSET;
+static const uint32_t kTimerVUpper  = RV_TIMER_TIMER_V_UPPER0_REG_OFFSET - RV_TIMER_CFG0_REG_OFFSET;
+static const uint32_t kTimerCmpLow  = RV_TIMER_COMPARE_LOWER0_0_REG_OFFSET - RV_TIMER_CFG0_REG_OFFSET;
+static const uint32_t kTimerCmpHigh = RV_TIMER_COMPARE_UPPER0_0_REG_OFFSET - RV_TIMER_CFG0_REG_OFFSET;
+static const uint32_t kTimerIntrEn  = RV_TIMER_INTR_ENABLE0_REG_OFFSET - RV_TIMER_CFG0_REG_OFFSET;
+static const uint32_t kTimerIntrSt  = RV_TIMER_INTR_STATE0_REG_OFFSET - RV_TIMER_CFG0_REG_OFFSET;
+static const uint32_t kTimerIntrTst = RV_TIMER_INTR_TEST0_REG_OFFSET - RV_TIMER_CFG0_REG_OFFSET;
+
+// Fast interrupt lines, see the fast_intr vector of core_v_mini_mcu.sv
+static const unsigned int kFastTimer1 = 0;
+static const unsigned int kFastDma    = 3;
+
+IssSoc::IssSoc()
+    : ram_start_(RAM_START_ADDRESS), ram_(RAM_SIZE, 0), cycle_(0), next_event_(kNever), irqs_(0),
+      exit_valid_(false), exit_value_(0), uart_log_(NULL), uart_bytes_(0), fast_enable_(0),
+      fast_pending_(0), replay_enabled_(false)
+{
+  memset(soc_ctrl_, 0, sizeof(soc_ctrl_));
+  memset(timers_, 0, sizeof(timers_));
+  memset(&plic_, 0, sizeof(plic_));
+  memset(dma_, 0, sizeof(dma_));
+  for(int i = 0; i < DMA_CH_NUM; i++)
+    dma_[i].done_cycle = kNever;
+  hostcall_.init(this);
+}
+
+IssSoc::~IssSoc()
+{
+  if(uart_log_ != NULL)
+    fclose(uart_log_);
+}
+
+bool IssSoc::loadElf(const std::string &file, uint32_t &entry)
+{
+  std::vector<ElfSegment> segments;
+
+  if(!elfLoadSegments(file, segments) || !elfReadEntry(file, entry))
+    return false;
+
+  for(size_t i = 0; i < segments.size(); i++) {
+    uint32_t addr = segments[i].addr;
+    size_t len = segments[i].data.size();
+    if(flash_.empty() && inRange(addr, FLASH_MEM_START_ADDRESS, FLASH_MEM_SIZE))
+      flash_.assign(FLASH_MEM_SIZE, 0xff);
+    uint8_t *mem = memory(addr, len);
+    if(mem == NULL) {
+      std::cout<<"[ISS]: ERROR: ELF segment at 0x"<<std::hex<<addr<<std::dec<<" ("<<len
+               <<" bytes) is neither in the RAM nor in the flash"<<std::endl;
+      return false;
+    }
+    memcpy(mem, &segments[i].data[0], len);
+  }
+  return true;
+}
+
+uint8_t *IssSoc::memory(uint32_t addr, size_t len)
+{
+  if(inRange(addr, ram_start_, ram_.size()) && len <= ram_.size() - (addr - ram_start_))
+    return &ram_[addr - ram_start_];
+  if(inRange(addr, FLASH_MEM_START_ADDRESS, flash_.size()) &&
+     len <= flash_.size() - (addr - FLASH_MEM_START_ADDRESS))
+    return &flash_[addr - FLASH_MEM_START_ADDRESS];
+  return NULL;
+}
+
+bool IssSoc::write(uint32_t addr, const uint8_t *data, size_t len)
+{
+  if(!inRange(addr, ram_start_, ram_.size()) || len > ram_.size() - (addr - ram_start_))
+    return false;
+  memcpy(&ram_[addr - ram_start_], data, len);
+  return true;
+}
+
+bool IssSoc::read(uint32_t addr, uint8_t *data, size_t len) const
+{
+  const uint8_t *mem = const_cast<IssSoc *>(this)->memory(addr, len);
+  if(mem == NULL)
+    return false;
+  memcpy(data, mem, len);
+  return true;
+}
+
+bool IssSoc::isMemory(uint32_t addr) const
+{
+  return inRange(addr, ram_start_, ram_.size()) || inRange(addr, FLASH_MEM_START_ADDRESS, flash_.size());
+}
+
+bool IssSoc::fetch(uint32_t addr, uint16_t &half) const
+{
+  if(!read(addr, (uint8_t *)&half, 2))
+    return false;
+  return true;
+}
+
+IssSoc::Access IssSoc::load(uint32_t addr, unsigned int size, uint32_t &value)
+{
+  uint32_t word;
+
+  if(isMemory(addr)) {
+    value = 0;
+    read(addr, (uint8_t *)&value, size);
+    return kOk;
+  }
+
+  if(replay_enabled_) {
+    if(replay_.empty())
+      return kStall;
+    if(replay_.front().first != (addr & ~3u))
+      return kReplayMismatch;
+    word = replay_.front().second;
+    replay_.pop_front();
+  } else {
+    word = regRead(addr & ~3u);
+  }
+
+  value = word >> (8 * (addr & 3));
+  if(size < 4)
+    value &= (1u << (8 * size)) - 1;
+  return kOk;
+}
+
+void IssSoc::store(uint32_t addr, unsigned int size, uint32_t value)
+{
+  uint8_t *mem = memory(addr, size);
+
+  if(mem != NULL) {
+    //the flash is read-only
+    if(inRange(addr, ram_start_, ram_.size()))
+      memcpy(mem, &value, size);
+    return;
+  }
+  regWrite(addr & ~3u, value << (8 * (addr & 3)));
+}
+
+void IssSoc::setExtIrq(unsigned int line, bool level)
+{
+  unsigned int src = EXT_INTR_0 + line;
+  bool prev;
+
+  if(src >= QTY_INTR)
+    return;
+  prev = plic_.level[src];
+  plic_.level[src] = level;
+  if((plic_.le >> src) & 1) {
+    if(level && !prev && !plic_.claimed[src])
+      plic_.ip[src] = true;
+  } else {
+    plicGateway(src);
+  }
+  updateIrqs();
+}
+
+bool IssSoc::setUartLog(const std::string &file)
+{
+  if(uart_log_ != NULL)
+    fclose(uart_log_);
+  uart_log_ = NULL;
+  if(file.empty())
+    return true;
+  uart_log_ = fopen(file.c_str(), "w");
+  if(uart_log_ == NULL) {
+    std::cout<<"[ISS]: ERROR: cannot open "<<file<<std::endl;
+    return false;
+  }
+  return true;
+}
+
+void IssSoc::setReplay(bool enable)
+{
+  replay_enabled_ = enable;
+  replay_.clear();
+  //the model that prints is the one the reads are replayed from
+  hostcall_.setOutput(!enable);
+}
+
+bool IssSoc::replayPending(uint32_t &addr) const
+{
+  if(replay_.empty())
+    return false;
+  addr = replay_.front().first;
+  return true;
+}
+
+// Timers and DMA, called on the events and after the register writes
+void IssSoc::update()
+{
+  uint64_t event = kNever;
+
+  for(int i = 0; i < 4; i++) {
+    Timer &t = timers_[i];
+    if(!t.intr_state && t.active && timerValue(t) >= t.compare)
+      t.intr_state = true;
+    if(!t.intr_state)
+      event = std::min(event, timerExpiry(t));
+  }
+
+  //the channels share the interrupt lines
+  for(int i = 0; i < DMA_CH_NUM; i++) {
+    Dma &d = dma_[i];
+    if(d.done_cycle == kNever)
+      continue;
+    if(cycle_ >= d.done_cycle) {
+      uint32_t window = d.regs[DMA_WINDOW_SIZE_REG_OFFSET / 4];
+      uint32_t units  = d.regs[DMA_WINDOW_COUNT_REG_OFFSET / 4];
+      d.done_cycle = kNever;
+      d.transaction_done = true;
+      //all the windows end together, the count holds the units until then
+      d.regs[DMA_WINDOW_COUNT_REG_OFFSET / 4] = window != 0 ? units / window : 0;
+      if(window != 0 && units >= window) {
+        d.window_done = true;
+        if((d.regs[DMA_INTERRUPT_EN_REG_OFFSET / 4] >> DMA_INTERRUPT_EN_WINDOW_DONE_BIT) & 1) {
+          plic_.level[DMA_WINDOW_INTR] = true;
+          plicGateway(DMA_WINDOW_INTR);
+          plic_.level[DMA_WINDOW_INTR] = false;
+        }
+      }
+      if((d.regs[DMA_INTERRUPT_EN_REG_OFFSET / 4] >> DMA_INTERRUPT_EN_TRANSACTION_DONE_BIT) & 1)
+        fast_pending_ |= fast_enable_ & (1u << kFastDma);
+    } else {
+      event = std::min(event, d.done_cycle);
+    }
+  }
+
+  //levels of the timers 1 to 3, the pending bits stay until cleared
+  for(int i = 1; i < 4; i++)
+    if(timers_[i].intr_state && timers_[i].intr_enable)
+      fast_pending_ |= fast_enable_ & (1u << (kFastTimer1 + i - 1));
+
+  next_event_ = event;
+  updateIrqs();
+}
+
+void IssSoc::updateIrqs()
+{
+  irqs_ = ((uint32_t)plic_.msip << 3) |
+          ((uint32_t)(timers_[0].intr_state && timers_[0].intr_enable) << 7) |
+          ((uint32_t)plicIrq() << 11) |
+          (fast_pending_ << 16);
+}
+
+uint64_t IssSoc::timerValue(const Timer &t) const
+{
+  if(!t.active)
+    return t.value;
+  return t.value + (uint64_t)t.step * ((cycle_ - t.base_cycle) / (t.prescale + 1));
+}
+
+// Moves the value to the last tick, keeping the phase of the prescaler
+void IssSoc::timerSync(Timer &t)
+{
+  if(!t.active) {
+    t.base_cycle = cycle_;
+    return;
+  }
+  uint64_t ticks = (cycle_ - t.base_cycle) / (t.prescale + 1);
+  t.value += (uint64_t)t.step * ticks;
+  t.base_cycle += ticks * (t.prescale + 1);
+}
+
+uint64_t IssSoc::timerExpiry(const Timer &t) const
+{
+  uint64_t ticks;
+
+  if(!t.active)
+    return kNever;
+  if(t.value >= t.compare)
+    return cycle_;
+  if(t.step == 0)
+    return kNever;
+  ticks = (t.compare - t.value + t.step - 1) / t.step;
+  if(ticks > (kNever - t.base_cycle) / (t.prescale + 1))
+    return kNever;
+  return t.base_cycle + ticks * (t.prescale + 1);
+}
+
+uint32_t IssSoc::timerRead(Timer *harts, uint32_t offset)
+{
+  if(offset == RV_TIMER_CTRL_REG_OFFSET)
+    return (uint32_t)harts[0].active | ((uint32_t)harts[1].active << 1);
+  if(offset < RV_TIMER_CFG0_REG_OFFSET || offset >= RV_TIMER_CFG0_REG_OFFSET + 2 * kTimerStride)
+    return 0;
+
+  Timer &t = harts[(offset - RV_TIMER_CFG0_REG_OFFSET) / kTimerStride];
+  switch((offset - RV_TIMER_CFG0_REG_OFFSET) % kTimerStride) {
+    case kTimerCfg:     return t.prescale | (t.step << RV_TIMER_CFG0_STEP_OFFSET);
+    case kTimerVLower:  return (uint32_t)timerValue(t);
+    case kTimerVUpper:  return (uint32_t)(timerValue(t) >> 32);
+    case kTimerCmpLow:  return (uint32_t)t.compare;
+    case kTimerCmpHigh: return (uint32_t)(t.compare >> 32);
+    case kTimerIntrEn:  return t.intr_enable;
+    case kTimerIntrSt:  return t.intr_state;
+    default:            return 0;
+  }
+}
+
+void IssSoc::timerWrite(Timer *harts, uint32_t offset, uint32_t value)
+{
+  if(offset == RV_TIMER_CTRL_REG_OFFSET) {
+    for(int h = 0; h < 2; h++) {
+      timerSync(harts[h]);
+      harts[h].active = (value >> h) & 1;
+    }
+    return;
+  }
+  if(offset < RV_TIMER_CFG0_REG_OFFSET || offset >= RV_TIMER_CFG0_REG_OFFSET + 2 * kTimerStride)
+    return;
+
+  Timer &t = harts[(offset - RV_TIMER_CFG0_REG_OFFSET) / kTimerStride];
+  timerSync(t);
+  switch((offset - RV_TIMER_CFG0_REG_OFFSET) % kTimerStride) {
+    case kTimerCfg:
+      t.prescale = value & RV_TIMER_CFG0_PRESCALE_MASK;
+      t.step     = (value >> RV_TIMER_CFG0_STEP_OFFSET) & RV_TIMER_CFG0_STEP_MASK;
+      break;
+    case kTimerVLower:  t.value = (t.value & ~0xffffffffULL) | value; break;
+    case kTimerVUpper:  t.value = (t.value & 0xffffffffULL) | ((uint64_t)value << 32); break;
+    case kTimerCmpLow:  t.compare = (t.compare & ~0xffffffffULL) | value; break;
+    case kTimerCmpHigh: t.compare = (t.compare & 0xffffffffULL) | ((uint64_t)value << 32); break;
+    case kTimerIntrEn:  t.intr_enable = value & 1; break;
+    case kTimerIntrSt:  if(value & 1) t.intr_state = false; break;
+    case kTimerIntrTst: if(value & 1) t.intr_state = true; break;
+    default: break;
+  }
+}
+
+// Level sources are pending while high, once claimed they wait for the
+// completion
+void IssSoc::plicGateway(unsigned int src)
+{
+  if(plic_.level[src] && !plic_.claimed[src])
+    plic_.ip[src] = true;
+}
+
+bool IssSoc::plicIrq() const
+{
+  for(unsigned int i = 1; i < QTY_INTR; i++)
+    if(plic_.ip[i] && ((plic_.ie >> i) & 1) && plic_.prio[i] > plic_.threshold)
+      return true;
+  return false;
+}
+
+uint32_t IssSoc::plicRead(uint32_t offset)
+{
+  uint32_t value = 0;
+
+  if(offset >= RV_PLIC_PRIO0_REG_OFFSET && offset < RV_PLIC_PRIO0_REG_OFFSET + 4 * QTY_INTR)
+    return plic_.prio[(offset - RV_PLIC_PRIO0_REG_OFFSET) / 4];
+
+  switch(offset) {
+    case RV_PLIC_IP_0_REG_OFFSET:
+    case RV_PLIC_IP_1_REG_OFFSET:
+      for(int i = 0; i < 32; i++)
+        value |= (uint32_t)plic_.ip[i + 8 * (offset - RV_PLIC_IP_0_REG_OFFSET)] << i;
+      return value;
+    case RV_PLIC_LE_0_REG_OFFSET:    return (uint32_t)plic_.le;
+    case RV_PLIC_LE_1_REG_OFFSET:    return (uint32_t)(plic_.le >> 32);
+    case RV_PLIC_IE0_0_REG_OFFSET:   return (uint32_t)plic_.ie;
+    case RV_PLIC_IE0_1_REG_OFFSET:   return (uint32_t)(plic_.ie >> 32);
+    case RV_PLIC_THRESHOLD0_REG_OFFSET: return plic_.threshold;
+    case RV_PLIC_MSIP0_REG_OFFSET:   return plic_.msip;
+    case RV_PLIC_CC0_REG_OFFSET: {
+      //highest priority, then lowest id
+      unsigned int id = 0;
+      for(unsigned int i = 1; i < QTY_INTR; i++)
+        if(plic_.ip[i] && ((plic_.ie >> i) & 1) && plic_.prio[i] > plic_.prio[id])
+          id = i;
+      if(id != 0) {
+        plic_.ip[id]      = false;
+        plic_.claimed[id] = true;
+        updateIrqs();
+      }
+      return id;
+    }
+    default:
+      return 0;
+  }
+}
+
+void IssSoc::plicWrite(uint32_t offset, uint32_t value)
+{
+  if(offset >= RV_PLIC_PRIO0_REG_OFFSET && offset < RV_PLIC_PRIO0_REG_OFFSET + 4 * QTY_INTR) {
+    plic_.prio[(offset - RV_PLIC_PRIO0_REG_OFFSET) / 4] = value & ((1 << RV_PLIC_PARAM_PRIO_WIDTH) - 1);
+    return;
+  }
+
+  switch(offset) {
+    case RV_PLIC_LE_0_REG_OFFSET:  plic_.le = (plic_.le & ~0xffffffffULL) | value; break;
+    case RV_PLIC_LE_1_REG_OFFSET:  plic_.le = (plic_.le & 0xffffffffULL) | ((uint64_t)value << 32); break;
+    case RV_PLIC_IE0_0_REG_OFFSET: plic_.ie = (plic_.ie & ~0xffffffffULL) | value; break;
+    case RV_PLIC_IE0_1_REG_OFFSET: plic_.ie = (plic_.ie & 0xffffffffULL) | ((uint64_t)value << 32); break;
+    case RV_PLIC_THRESHOLD0_REG_OFFSET: plic_.threshold = value & ((1 << RV_PLIC_PARAM_PRIO_WIDTH) - 1); break;
+    case RV_PLIC_MSIP0_REG_OFFSET: plic_.msip = value & 1; break;
+    case RV_PLIC_CC0_REG_OFFSET:
+      if(value < QTY_INTR && plic_.claimed[value]) {
+        plic_.claimed[value] = false;
+        plicGateway(value);
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+uint32_t IssSoc::dmaRead(uint32_t offset)
+{
+  uint32_t value;
+
+  if(offset / DMA_CH_SIZE >= DMA_CH_NUM)
+    return 0;
+  Dma &d = dma_[offset / DMA_CH_SIZE];
+  offset %= DMA_CH_SIZE;
+
+  if(offset == DMA_STATUS_REG_OFFSET) {
+    value = ((uint32_t)(d.done_cycle == kNever) << DMA_STATUS_READY_BIT) |
+            ((uint32_t)d.window_done << DMA_STATUS_WINDOW_DONE_BIT) |
+            ((uint32_t)d.transaction_done << DMA_STATUS_TRANSACTION_DONE_BIT);
+    d.window_done = false;
+    d.transaction_done = false;
+    return value;
+  }
+  //the count only shows the windows once the transfer is over
+  if(offset == DMA_WINDOW_COUNT_REG_OFFSET && d.done_cycle != kNever)
+    return 0;
+  if(offset / 4 >= sizeof(d.regs) / sizeof(d.regs[0]))
+    return 0;
+  return d.regs[offset / 4];
+}
+
+void IssSoc::dmaWrite(uint32_t offset, uint32_t value)
+{
+  if(offset / DMA_CH_SIZE >= DMA_CH_NUM)
+    return;
+  Dma &d = dma_[offset / DMA_CH_SIZE];
+  uint32_t base = DMA_START_ADDRESS + offset / DMA_CH_SIZE * DMA_CH_SIZE;
+  offset %= DMA_CH_SIZE;
+
+  if(offset == DMA_STATUS_REG_OFFSET || offset == DMA_WINDOW_COUNT_REG_OFFSET ||
+     offset / 4 >= sizeof(d.regs) / sizeof(d.regs[0]))
+    return;
+  d.regs[offset / 4] = value;
+  if(offset == DMA_SIZE_REG_OFFSET && value != 0) {
+    if(d.done_cycle != kNever)
+      warnOnce(base, "DMA launched while busy, the transfer is done anyway");
+    dmaLaunch(d, base);
+  }
+  if(offset == DMA_DESC_PTR_REG_OFFSET && value != 0) {
+    if(d.done_cycle != kNever)
+      warnOnce(base, "DMA list launched while busy, the transfers are done anyway");
+    dmaList(d, base);
+  }
+}
+
+// The descriptors of a linked list are loaded into the registers and run one
+// after the other, the list is over once all of them would be, plus one cycle
+// per descriptor word fetched. Only the end of the list raises the interrupt.
+void IssSoc::dmaList(Dma &d, uint32_t base)
+{
+  uint32_t *r     = d.regs;
+  uint32_t head   = r[DMA_DESC_PTR_REG_OFFSET / 4];
+  uint32_t desc   = head;
+  uint64_t cycles = 0;
+  uint32_t w[11];
+
+  for(;;) {
+    read(desc, (uint8_t *)w, sizeof(w));
+    r[DMA_SRC_PTR_REG_OFFSET / 4]       = w[1];
+    r[DMA_DST_PTR_REG_OFFSET / 4]       = w[2];
+    r[DMA_SIZE_REG_OFFSET / 4]          = w[3];
+    r[DMA_PTR_INC_REG_OFFSET / 4]       = w[4] & 0xffff;
+    r[DMA_DATA_TYPE_REG_OFFSET / 4]     = (w[4] >> 16) & 3;
+    r[DMA_SLOT_REG_OFFSET / 4]          = w[5];
+    r[DMA_SIZE_D2_REG_OFFSET / 4]       = w[6] & 0xffff;
+    r[DMA_SIZE_D3_REG_OFFSET / 4]       = w[6] >> 16;
+    r[DMA_SRC_STRIDE_D2_REG_OFFSET / 4] = w[7];
+    r[DMA_DST_STRIDE_D2_REG_OFFSET / 4] = w[8];
+    r[DMA_SRC_STRIDE_D3_REG_OFFSET / 4] = w[9];
+    r[DMA_DST_STRIDE_D3_REG_OFFSET / 4] = w[10];
+    r[DMA_DESC_PTR_REG_OFFSET / 4]      = desc;
+    dmaLaunch(d, base);
+    cycles += d.done_cycle - cycle_ + sizeof(w) / 4;
+    if(w[0] == 0)
+      break;
+    if(w[0] == r[DMA_DESC_PTR_REG_OFFSET / 4] || w[0] == head) {
+      warnOnce(base + DMA_DESC_PTR_REG_OFFSET, "DMA circular lists run a single pass");
+      break;
+    }
+    desc = w[0];
+  }
+  d.done_cycle = cycle_ + cycles;
+}
+
+// The data is moved at once, the transfer is over one cycle per unit later.
+// The channels do not share any bandwidth, each one runs at one unit per cycle.
+// 2D/3D transfers move SIZE_D3 planes of SIZE_D2 rows of SIZE bytes, the
+// pointers jump by the strides from the start of the row/plane.
+void IssSoc::dmaLaunch(Dma &d, uint32_t base)
+{
+  uint32_t *r       = d.regs;
+  uint32_t type     = r[DMA_DATA_TYPE_REG_OFFSET / 4] & 3;
+  uint32_t unit     = type == DMA_DATA_TYPE_DATA_TYPE_VALUE_DMA_32BIT_WORD ? 4 :
+                      type == DMA_DATA_TYPE_DATA_TYPE_VALUE_DMA_16BIT_WORD ? 2 : 1;
+  uint32_t units    = (r[DMA_SIZE_REG_OFFSET / 4] + unit - 1) / unit;
+  uint32_t src      = r[DMA_SRC_PTR_REG_OFFSET / 4];
+  uint32_t dst      = r[DMA_DST_PTR_REG_OFFSET / 4];
+  uint32_t addr     = r[DMA_ADDR_PTR_REG_OFFSET / 4];
+  uint32_t src_inc  = (r[DMA_PTR_INC_REG_OFFSET / 4] >> DMA_PTR_INC_SRC_PTR_INC_OFFSET) & 0xff;
+  uint32_t dst_inc  = (r[DMA_PTR_INC_REG_OFFSET / 4] >> DMA_PTR_INC_DST_PTR_INC_OFFSET) & 0xff;
+  uint32_t mode     = r[DMA_MODE_REG_OFFSET / 4] & 3;
+  uint32_t rows     = r[DMA_SIZE_D2_REG_OFFSET / 4] & 0xffff;
+  uint32_t planes   = r[DMA_SIZE_D3_REG_OFFSET / 4] & 0xffff;
+  uint32_t data     = 0;
+
+  uint32_t src_row  = src, src_plane = src;
+  uint32_t dst_row  = dst, dst_plane = dst;
+
+  if(rows == 0 || mode == DMA_MODE_MODE_VALUE_ADDRESS_MODE)
+    rows = 1;
+  if(planes == 0 || mode == DMA_MODE_MODE_VALUE_ADDRESS_MODE)
+    planes = 1;
+
+  if(r[DMA_SLOT_REG_OFFSET / 4] != 0)
+    warnOnce(base + DMA_SLOT_REG_OFFSET, "DMA trigger slots are not modelled, the transfers do not wait");
+  if(mode == DMA_MODE_MODE_VALUE_CIRCULAR_MODE)
+    warnOnce(base + DMA_MODE_REG_OFFSET, "DMA circular mode runs a single pass");
+
+  for(uint32_t i = 0; i < units * rows * planes; i++) {
+    if(isMemory(src))
+      read(src, (uint8_t *)&data, unit);
+    else
+      data = regRead(src & ~3u) >> (8 * (src & 3));
+    if(mode == DMA_MODE_MODE_VALUE_ADDRESS_MODE) {
+      read(addr, (uint8_t *)&dst, 4);
+      addr += 4;
+    }
+    store(dst, unit, data);
+    src += src_inc;
+    if(mode != DMA_MODE_MODE_VALUE_ADDRESS_MODE)
+      dst += dst_inc;
+    //end of a row, or of a plane
+    if((i + 1) % units == 0) {
+      uint32_t row = (i + 1) / units;
+      bool plane = row % rows == 0;
+      uint32_t src_stride = r[(plane ? DMA_SRC_STRIDE_D3_REG_OFFSET : DMA_SRC_STRIDE_D2_REG_OFFSET) / 4];
+      uint32_t dst_stride = r[(plane ? DMA_DST_STRIDE_D3_REG_OFFSET : DMA_DST_STRIDE_D2_REG_OFFSET) / 4];
+      if(plane) {
+        src_plane += src_stride;
+        dst_plane += dst_stride;
+        src_row = src_plane;
+        dst_row = dst_plane;
+      } else {
+        src_row += src_stride;
+        dst_row += dst_stride;
+      }
+      src = src_row;
+      if(mode != DMA_MODE_MODE_VALUE_ADDRESS_MODE)
+        dst = dst_row;
+    }
+  }
+
+  units *= rows * planes;
+  d.transfers++;
+  d.bytes += (uint64_t)units * unit;
+  d.window_done = false;
+  r[DMA_WINDOW_COUNT_REG_OFFSET / 4] = units;
+  d.done_cycle = cycle_ + (units != 0 ? units : 1);
+}
+
+uint32_t IssSoc::regRead(uint32_t addr)
+{
+  if(inRange(addr, SOC_CTRL_START_ADDRESS, SOC_CTRL_SIZE)) {
+    uint32_t offset = addr - SOC_CTRL_START_ADDRESS;
+    if(offset == SOC_CTRL_EXIT_VALID_REG_OFFSET)
+      return exit_valid_;
+    if(offset == SOC_CTRL_EXIT_VALUE_REG_OFFSET)
+      return exit_value_;
+    return offset / 4 < 16 ? soc_ctrl_[offset / 4] : 0;
+  }
+  if(inRange(addr, UART_START_ADDRESS, UART_SIZE)) {
+    //the transmitter is always idle and nothing is ever received
+    if(addr - UART_START_ADDRESS == UART_STATUS_REG_OFFSET)
+      return (1 << UART_STATUS_TXEMPTY_BIT) | (1 << UART_STATUS_TXIDLE_BIT) |
+             (1 << UART_STATUS_RXIDLE_BIT) | (1 << UART_STATUS_RXEMPTY_BIT);
+    if(addr - UART_START_ADDRESS == UART_RDATA_REG_OFFSET)
+      return 0;
+    return regs_[addr];
+  }
+  if(inRange(addr, RV_TIMER_AO_START_ADDRESS, RV_TIMER_AO_SIZE))
+    return timerRead(&timers_[0], addr - RV_TIMER_AO_START_ADDRESS);
+  if(inRange(addr, DMA_START_ADDRESS, DMA_SIZE))
+    return dmaRead(addr - DMA_START_ADDRESS);
+  if(inRange(addr, FAST_INTR_CTRL_START_ADDRESS, FAST_INTR_CTRL_SIZE)) {
+    switch(addr - FAST_INTR_CTRL_START_ADDRESS) {
+      case FAST_INTR_CTRL_FAST_INTR_PENDING_REG_OFFSET: return fast_pending_;
+      case FAST_INTR_CTRL_FAST_INTR_ENABLE_REG_OFFSET:  return fast_enable_;
+      default: return 0;
+    }
+  }
+#ifdef RV_PLIC_IS_INCLUDED
+  if(inRange(addr, RV_PLIC_START_ADDRESS, RV_PLIC_SIZE))
+    return plicRead(addr - RV_PLIC_START_ADDRESS);
+#endif
+#ifdef RV_TIMER_IS_INCLUDED
+  if(inRange(addr, RV_TIMER_START_ADDRESS, RV_TIMER_SIZE))
+    return timerRead(&timers_[2], addr - RV_TIMER_START_ADDRESS);
+#endif
+  if(inRange(addr, AO_PERIPHERAL_START_ADDRESS, AO_PERIPHERAL_SIZE) ||
+     inRange(addr, PERIPHERAL_START_ADDRESS, PERIPHERAL_SIZE) ||
+     inRange(addr, EXT_SLAVE_START_ADDRESS, EXT_SLAVE_SIZE)) {
+    warnOnce(addr, "no model of this peripheral, its registers read back the last written value");
+    return regs_[addr];
+  }
+  warnOnce(addr, "nothing is mapped here, the reads return 0");
+  return 0;
+}
+
+void IssSoc::regWrite(uint32_t addr, uint32_t value)
+{
+  if(inRange(addr, SOC_CTRL_START_ADDRESS, SOC_CTRL_SIZE)) {
+    uint32_t offset = addr - SOC_CTRL_START_ADDRESS;
+    if(offset == SOC_CTRL_EXIT_VALID_REG_OFFSET)
+      exit_valid_ = value & 1;
+    else if(offset == SOC_CTRL_EXIT_VALUE_REG_OFFSET)
+      exit_value_ = value;
+    else if(offset == SOC_CTRL_HOST_CALL_REG_OFFSET)
+      hostcall_.serve(value);
+    else if(offset / 4 < 16)
+      soc_ctrl_[offset / 4] = value;
+    return;
+  }
+  if(inRange(addr, UART_START_ADDRESS, UART_SIZE)) {
+    if(addr - UART_START_ADDRESS == UART_WDATA_REG_OFFSET) {
+      uart_bytes_++;
+      if(uart_log_ != NULL) {
+        fputc(value & 0xff, uart_log_);
+        if((value & 0xff) == '\n')
+          fflush(uart_log_);
+      }
+      return;
+    }
+    regs_[addr] = value;
+    return;
+  }
+  if(inRange(addr, RV_TIMER_AO_START_ADDRESS, RV_TIMER_AO_SIZE)) {
+    timerWrite(&timers_[0], addr - RV_TIMER_AO_START_ADDRESS, value);
+    update();
+    return;
+  }
+  if(inRange(addr, DMA_START_ADDRESS, DMA_SIZE)) {
+    dmaWrite(addr - DMA_START_ADDRESS, value);
+    update();
+    return;
+  }
+  if(inRange(addr, FAST_INTR_CTRL_START_ADDRESS, FAST_INTR_CTRL_SIZE)) {
+    switch(addr - FAST_INTR_CTRL_START_ADDRESS) {
+      case FAST_INTR_CTRL_FAST_INTR_CLEAR_REG_OFFSET:  fast_pending_ &= ~value; break;
+      case FAST_INTR_CTRL_FAST_INTR_ENABLE_REG_OFFSET: fast_enable_ = value & 0x7fff; break;
+      default: break;
+    }
+    update();
+    return;
+  }
+#ifdef RV_PLIC_IS_INCLUDED
+  if(inRange(addr, RV_PLIC_START_ADDRESS, RV_PLIC_SIZE)) {
+    plicWrite(addr - RV_PLIC_START_ADDRESS, value);
+    updateIrqs();
+    return;
+  }
+#endif
+#ifdef RV_TIMER_IS_INCLUDED
+  if(inRange(addr, RV_TIMER_START_ADDRESS, RV_TIMER_SIZE)) {
+    timerWrite(&timers_[2], addr - RV_TIMER_START_ADDRESS, value);
+    update();
+    return;
+  }
+#endif
+  if(inRange(addr, AO_PERIPHERAL_START_ADDRESS, AO_PERIPHERAL_SIZE) ||
+     inRange(addr, PERIPHERAL_START_ADDRESS, PERIPHERAL_SIZE) ||
+     inRange(addr, EXT_SLAVE_START_ADDRESS, EXT_SLAVE_SIZE)) {
+    warnOnce(addr, "no model of this peripheral, its registers read back the last written value");
+    regs_[addr] = value;
+    return;
+  }
+  warnOnce(addr, "nothing is mapped here, the writes are dropped");
+}
+
+// Once per 64 KiB block, the size of the smallest peripheral of mcu_cfg.hjson
+void IssSoc::warnOnce(uint32_t addr, const char *what)
+{
+  //in replay mode the values that matter come from the RTL
+  if(replay_enabled_ || !warned_.insert(addr & ~0xffffu).second)
+    return;
+  std::cout<<"[ISS]: WARNING: 0x"<<std::hex<<addr<<std::dec<<": "<<what<<std::endl;
+}
+
+void IssSoc::printStats() const
+{
+  uint64_t transfers = 0, bytes = 0;
+
+  for(int i = 0; i < DMA_CH_NUM; i++) {
+    transfers += dma_[i].transfers;
+    bytes += dma_[i].bytes;
+  }
+  std::cout<<"[ISS]: UART: "<<uart_bytes_<<" bytes, DMA: "<<transfers<<" transfers ("
+           <<bytes<<" bytes)"<<std::endl;
+  hostcall_.printStats();
+}
@@ -0,0 +1,177 @@
+// Copyright EPFL contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef TB_ISS_SOC_H_
+#define TB_ISS_SOC_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "core_v_mini_mcu.h"
+
+#include "tb_hostcall.h"
+#include "tb_sram.h"
+
+// Functional model of the x-heep SoC around the ISS hart (tb_iss.h).
+//
+// The memory map is the one of core_v_mini_mcu.h, generated by mcu_gen.py
+// from mcu_cfg.hjson, and the register layouts come from the *_regs.h headers
+// of the drivers. soc_ctrl, UART, the two rv_timers, the PLIC,
+// fast_intr_ctrl and the DMA are modelled at register level, the registers
+// of the other peripherals read back the last written value. The time only
+// moves with the hart: the SoC is told the current cycle before each access
+// and whenever nextEvent() is reached.
+class IssSoc : public MemoryPort {
+ public:
+  enum Access { kOk, kStall, kReplayMismatch };
+
+  static const uint64_t kNever = ~0ULL;
+
+  IssSoc();
+  ~IssSoc();
+
+  // Copies the PT_LOAD segments to the RAM and to the flash
+  bool loadElf(const std::string &file, uint32_t &entry);
+
+  // RAM and flash, as seen by the host calls
+  bool write(uint32_t addr, const uint8_t *data, size_t len);
+  bool read(uint32_t addr, uint8_t *data, size_t len) const;
+
+  uint8_t *ram() { return &ram_[0]; }
+  uint32_t ramStart() const { return ram_start_; }
+  uint32_t ramSize() const { return ram_.size(); }
+  bool isMemory(uint32_t addr) const;
+
+  // Data accesses of the hart (size 1, 2 or 4) outside of the RAM
+  Access load(uint32_t addr, unsigned int size, uint32_t &value);
+  void store(uint32_t addr, unsigned int size, uint32_t value);
+  // Instruction fetch outside of the RAM, false if nothing is mapped there
+  bool fetch(uint32_t addr, uint16_t &half) const;
+
+  // Brings the timers and the DMA to cycle
+  void advance(uint64_t cycle) {
+    cycle_ = cycle;
+    if(cycle >= next_event_)
+      update();
+  }
+  uint64_t nextEvent() const { return next_event_; }
+  // Interrupt lines of the hart, in the mip layout: software (3), timer (7),
+  // external (11) and the fast interrupts from bit 16
+  uint32_t irqs() const { return irqs_; }
+  // Level of the external interrupt line of the PLIC (intr_vector_ext_i)
+  void setExtIrq(unsigned int line, bool level);
+
+  bool exited() const { return exit_valid_; }
+  uint32_t exitValue() const { return exit_value_; }
+
+  // The UART output goes to file, no output when empty
+  bool setUartLog(const std::string &file);
+  // In replay mode the reads of the peripherals return the values pushed by
+  // pushRead() in order instead of the ones of the models, see tb_lockstep.h
+  void setReplay(bool enable);
+  void pushRead(uint32_t addr, uint32_t data) { replay_.push_back(std::make_pair(addr, data)); }
+  bool replayPending(uint32_t &addr) const;
+
+  void printStats() const;
+
+ private:
+  // One hart of an rv_timer. The value is counted from base_cycle, the cycle
+  // of the last tick it was brought to.
+  struct Timer {
+    bool active;
+    uint32_t prescale;
+    uint32_t step;
+    uint64_t value;
+    uint64_t compare;
+    uint64_t base_cycle;
+    bool intr_enable;
+    bool intr_state;
+  };
+
+  struct Plic {
+    uint8_t prio[64];
+    bool level[64];
+    bool ip[64];
+    bool claimed[64];
+    uint64_t le;
+    uint64_t ie;
+    uint32_t threshold;
+    bool msip;
+  };
+
+  struct Dma {
+    uint32_t regs[32];
+    uint64_t done_cycle;
+    bool window_done;
+    bool transaction_done;
+    uint64_t transfers;
+    uint64_t bytes;
+  };
+
+  void update();
+  void updateIrqs();
+
+  bool inRange(uint32_t addr, uint32_t start, uint32_t size) const {
+    return addr - start < size;
+  }
+  uint8_t *memory(uint32_t addr, size_t len);
+
+  uint64_t timerValue(const Timer &t) const;
+  void timerSync(Timer &t);
+  uint64_t timerExpiry(const Timer &t) const;
+  uint32_t timerRead(Timer *harts, uint32_t offset);
+  void timerWrite(Timer *harts, uint32_t offset, uint32_t value);
+
+  uint32_t plicRead(uint32_t offset);
+  void plicWrite(uint32_t offset, uint32_t value);
+  void plicGateway(unsigned int src);
+  bool plicIrq() const;
+
+  uint32_t dmaRead(uint32_t offset);
+  void dmaWrite(uint32_t offset, uint32_t value);
+  void dmaLaunch(Dma &d, uint32_t base);
+  void dmaList(Dma &d, uint32_t base);
+
+  uint32_t regRead(uint32_t addr);
+  void regWrite(uint32_t addr, uint32_t value);
+  void warnOnce(uint32_t addr, const char *what);
+
+  uint32_t ram_start_;
+  std::vector<uint8_t> ram_;
+  std::vector<uint8_t> flash_;
+  uint64_t cycle_;
+  uint64_t next_event_;
+  uint32_t irqs_;
+
+  bool exit_valid_;
+  uint32_t exit_value_;
+  uint32_t soc_ctrl_[16];
+  HostCall hostcall_;
+
+  FILE *uart_log_;
+  uint64_t uart_bytes_;
+
+  // 0-1: rv_timer_ao, 2-3: rv_timer
+  Timer timers_[4];
+  uint32_t fast_enable_;
+  uint32_t fast_pending_;
+  Plic plic_;
+  // one per channel, DMA_CH_SIZE bytes of registers each
+  Dma dma_[DMA_CH_NUM];
+
+  // registers of the peripherals with no model
+  std::map<uint32_t, uint32_t> regs_;
+  std::set<uint32_t> warned_;
+
+  bool replay_enabled_;
+  std::deque<std::pair<uint32_t, uint32_t> > replay_;
+};
+
+#endif  // TB_ISS_SOC_H_
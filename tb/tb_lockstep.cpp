@@ -0,0 +1,213 @@
+// Copyright EPFL contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "tb_lockstep.h"
+
+#include <iostream>
+
+Lockstep tb_lockstep;
+
+static const uint32_t kCauseIrq = 0x80000000;
+// the vector table of the cores has one entry per exception code
+static const uint32_t kVectors = 32;
+
+Lockstep::Lockstep()
+    : soc_(NULL), core_(NULL), entry_(0), armed_(false), failed_(false), has_last_read_(false),
+      last_read_addr_(0), last_read_data_(0), instructions_(0), reads_(0), stores_(0), irqs_(0)
+{
+}
+
+Lockstep::~Lockstep()
+{
+  delete core_;
+  delete soc_;
+}
+
+bool Lockstep::init(const std::string &elf, bool has_f)
+{
+  soc_ = new IssSoc();
+  if(!soc_->loadElf(elf, entry_)) {
+    delete soc_;
+    soc_ = NULL;
+    return false;
+  }
+  soc_->setReplay(true);
+
+  core_ = new IssCore(*soc_, has_f);
+  core_->setIrqEnabled(false);
+  core_->setStoreHook([this](uint32_t addr, unsigned int size, uint32_t value) { issStore(addr, size, value); });
+  core_->reset(entry_);
+
+  std::cout<<"[LOCKSTEP]: Checking the CPU against the ISS from 0x"<<std::hex<<entry_<<std::dec
+           <<(has_f ? "" : ", no FPU")<<std::endl;
+  return true;
+}
+
+bool Lockstep::isVector(uint32_t pc, uint32_t &cause) const
+{
+  uint32_t base = core_->mtvec() & ~3u;
+
+  if((core_->mtvec() & 3) != 1 || pc - base >= 4 * kVectors || (pc & 3) != 0)
+    return false;
+  cause = (pc - base) / 4;
+  //entry 0 is the one of the exceptions
+  return cause != 0;
+}
+
+void Lockstep::fail(const std::string &what, uint32_t pc, uint32_t instr)
+{
+  failed_ = true;
+  std::cout<<"[LOCKSTEP]: ERROR: "<<what<<" after "<<instructions_<<" instructions"<<std::endl;
+  std::cout<<std::hex<<"[LOCKSTEP]:   RTL retired 0x"<<pc<<" (0x"<<instr<<"), the ISS is at 0x"<<core_->pc()
+           <<" (0x"<<core_->instr()<<")"<<std::endl;
+  if(has_last_read_)
+    std::cout<<"[LOCKSTEP]:   last replayed read: 0x"<<last_read_data_<<" from 0x"<<last_read_addr_<<std::endl;
+  std::cout<<std::dec;
+}
+
+// Runs the ISS over the instructions retired by the RTL, until it waits for
+// the data of a replayed read
+void Lockstep::drain()
+{
+  while(!commits_.empty() && !failed_) {
+    uint32_t pc = commits_.front().first, instr = commits_.front().second, cause;
+    IssCore::Result result;
+
+    if(core_->pc() != pc) {
+      if(isVector(pc, cause)) {
+        core_->trap(kCauseIrq | cause, 0);
+        irqs_++;
+        continue;
+      }
+      //the RTL does not report the instructions that trap
+      result = core_->step();
+      if(result == IssCore::kStalled)
+        return;
+      if(result == IssCore::kReplayMismatch) {
+        fail("the RTL read another address", pc, instr);
+        return;
+      }
+      if(result != IssCore::kTrapped || core_->pc() != pc) {
+        fail("PC mismatch", pc, instr);
+        return;
+      }
+    }
+
+    result = core_->step();
+    if(result == IssCore::kStalled)
+      return;
+    if(result == IssCore::kReplayMismatch) {
+      fail("the RTL read another address", pc, instr);
+      return;
+    }
+    commits_.pop_front();
+    instructions_++;
+  }
+}
+
+void Lockstep::commit(uint32_t pc, uint32_t instr)
+{
+  if(failed_)
+    return;
+  //the boot code runs before the firmware and is not checked
+  if(!armed_) {
+    if(pc != entry_)
+      return;
+    armed_ = true;
+  }
+  commits_.push_back(std::make_pair(pc, instr));
+  drain();
+}
+
+void Lockstep::dataRequest(bool we, uint32_t addr, uint32_t be, uint32_t wdata)
+{
+  requests_.push_back(std::make_pair(we, addr & ~3u));
+  if(!we || !armed_ || failed_)
+    return;
+
+  Store store = {addr & ~3u, be & 0xf, 0};
+  for(unsigned int i = 0; i < 4; i++)
+    if(be & (1u << i))
+      store.data |= wdata & (0xffu << (8 * i));
+  rtl_stores_.push_back(store);
+  checkStores();
+}
+
+void Lockstep::dataResponse(uint32_t rdata)
+{
+  //started while a request was outstanding
+  if(requests_.empty())
+    return;
+  std::pair<bool, uint32_t> request = requests_.front();
+  requests_.pop_front();
+  if(request.first || !armed_ || failed_ || soc_->isMemory(request.second))
+    return;
+
+  soc_->pushRead(request.second, rdata);
+  has_last_read_  = true;
+  last_read_addr_ = request.second;
+  last_read_data_ = rdata;
+  reads_++;
+  drain();
+}
+
+void Lockstep::issStore(uint32_t addr, unsigned int size, uint32_t value)
+{
+  //split as the core does on the bus, one store per word
+  for(unsigned int i = 0; i < size; i++) {
+    uint32_t byte_addr = addr + i;
+    if(i == 0 || (byte_addr & 3) == 0) {
+      Store store = {byte_addr & ~3u, 0, 0};
+      iss_stores_.push_back(store);
+    }
+    iss_stores_.back().be   |= 1u << (byte_addr & 3);
+    iss_stores_.back().data |= ((value >> (8 * i)) & 0xff) << (8 * (byte_addr & 3));
+  }
+  checkStores();
+}
+
+void Lockstep::checkStores()
+{
+  while(!rtl_stores_.empty() && !iss_stores_.empty() && !failed_) {
+    const Store &rtl = rtl_stores_.front();
+    const Store &iss = iss_stores_.front();
+    if(rtl.addr != iss.addr || rtl.be != iss.be || rtl.data != iss.data) {
+      failed_ = true;
+      std::cout<<"[LOCKSTEP]: ERROR: store mismatch after "<<instructions_<<" instructions"<<std::endl;
+      std::cout<<std::hex<<"[LOCKSTEP]:   RTL: 0x"<<rtl.data<<" to 0x"<<rtl.addr<<" (be 0x"<<rtl.be
+               <<"), ISS: 0x"<<iss.data<<" to 0x"<<iss.addr<<" (be 0x"<<iss.be<<"), ISS at 0x"<<core_->pc()
+               <<std::dec<<std::endl;
+      return;
+    }
+    rtl_stores_.pop_front();
+    iss_stores_.pop_front();
+    stores_++;
+  }
+}
+
+void Lockstep::printStats() const
+{
+  if(!enabled())
+    return;
+  std::cout<<"[LOCKSTEP]: "<<(failed_ ? "FAILED" : "PASSED")<<": "<<instructions_<<" instructions, "<<stores_
+           <<" stores, "<<irqs_<<" interrupts compared, "<<reads_<<" reads replayed"<<std::endl;
+}
+
+extern "C" void tb_lockstep_commit(int pc, int instr)
+{
+  if(tb_lockstep.enabled())
+    tb_lockstep.commit(pc, instr);
+}
+
+extern "C" void tb_lockstep_data_req(int we, int addr, int be, int wdata)
+{
+  if(tb_lockstep.enabled())
+    tb_lockstep.dataRequest(we != 0, addr, be, wdata);
+}
+
+extern "C" void tb_lockstep_data_resp(int rdata)
+{
+  if(tb_lockstep.enabled())
+    tb_lockstep.dataResponse(rdata);
+}
@@ -0,0 +1,85 @@
+// Copyright EPFL contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef TB_LOCKSTEP_H_
+#define TB_LOCKSTEP_H_
+
+#include <stdint.h>
+#include <deque>
+#include <string>
+#include <utility>
+
+#include "tb_iss.h"
+#include "tb_iss_soc.h"
+
+// Lockstep check of the RTL CPU against the ISS (tb_iss.h).
+//
+// tb_util.svh reports the PC of every instruction retired by the RTL and the
+// transactions of the core data port. The ISS runs the same firmware from the
+// ELF entry on and must retire the same PCs and issue the same stores; the
+// reads of the peripherals are replayed from the RTL, so that polling loops
+// and interrupt handlers see the same values. The interrupts are taken when
+// the RTL enters the vector table (vectored mtvec only), the ISS never raises
+// them by itself.
+//
+// What the hardware computes from time (mcycle, the timer values) can still
+// differ: they come from the peripherals when read through the bus, but not
+// when read from the CSRs.
+class Lockstep {
+ public:
+  Lockstep();
+  ~Lockstep();
+
+  bool init(const std::string &elf, bool has_f);
+  bool enabled() const { return core_ != NULL; }
+  bool failed() const { return failed_; }
+
+  void commit(uint32_t pc, uint32_t instr);
+  void dataRequest(bool we, uint32_t addr, uint32_t be, uint32_t wdata);
+  void dataResponse(uint32_t rdata);
+
+  void printStats() const;
+
+ private:
+  // Word-aligned store with its byte enables
+  struct Store {
+    uint32_t addr;
+    uint32_t be;
+    uint32_t data;
+  };
+
+  void drain();
+  void issStore(uint32_t addr, unsigned int size, uint32_t value);
+  void checkStores();
+  bool isVector(uint32_t pc, uint32_t &cause) const;
+  void fail(const std::string &what, uint32_t pc, uint32_t instr);
+
+  IssSoc *soc_;
+  IssCore *core_;
+  uint32_t entry_;
+  bool armed_;
+  bool failed_;
+
+  // retired by the RTL and not yet by the ISS
+  std::deque<std::pair<uint32_t, uint32_t> > commits_;
+  // data requests of the RTL waiting for their response (we, addr)
+  std::deque<std::pair<bool, uint32_t> > requests_;
+  std::deque<Store> rtl_stores_;
+  std::deque<Store> iss_stores_;
+
+  bool has_last_read_;
+  uint32_t last_read_addr_;
+  uint32_t last_read_data_;
+
+  uint64_t instructions_;
+  uint64_t reads_;
+  uint64_t stores_;
+  uint64_t irqs_;
+};
+
+// Instance fed by the tb_lockstep_commit, tb_lockstep_data_req and
+// tb_lockstep_data_resp DPI functions
+extern Lockstep tb_lockstep;
+
+#endif  // TB_LOCKSTEP_H_
@@ -0,0 +1,137 @@
+// Copyright EPFL contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "tb_memdump.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+
+static std::vector<std::string> split(const std::string &str, char sep)
+{
+  std::vector<std::string> fields;
+  std::istringstream in(str);
+  std::string field;
+  while(std::getline(in, field, sep))
+    fields.push_back(field);
+  if(!str.empty() && str[str.size() - 1] == sep)
+    fields.push_back("");
+  return fields;
+}
+
+static bool parseNumber(const std::string &str, uint32_t &value)
+{
+  char *end;
+  unsigned long v = strtoul(str.c_str(), &end, 0);
+  if(str.empty() || *end != '\0' || v > 0xffffffffUL)
+    return false;
+  value = v;
+  return true;
+}
+
+bool MemDump::parse(const std::string &regions)
+{
+  std::vector<std::string> specs = split(regions, ',');
+  for(size_t i = 0; i < specs.size(); i++) {
+    Region region;
+    size_t first  = specs[i].find(':');
+    size_t second = first == std::string::npos ? first : specs[i].find(':', first + 1);
+    if(second == std::string::npos || !parseNumber(specs[i].substr(0, first), region.addr) ||
+       !parseNumber(specs[i].substr(first + 1, second - first - 1), region.len) ||
+       region.len == 0 || second + 1 >= specs[i].size()) {
+      std::cout<<"[MEMDUMP]: ERROR: Expected <addr>:<len>:<file>, got "<<specs[i]<<std::endl;
+      return false;
+    }
+    region.file = specs[i].substr(second + 1);
+    regions_.push_back(region);
+  }
+  return true;
+}
+
+bool MemDump::setGolden(const std::string &files)
+{
+  std::vector<std::string> golden = split(files, ',');
+  if(golden.size() > regions_.size()) {
+    std::cout<<"[MEMDUMP]: ERROR: "<<golden.size()<<" golden files for "<<regions_.size()<<" dumped regions"<<std::endl;
+    return false;
+  }
+  for(size_t i = 0; i < golden.size(); i++)
+    regions_[i].golden = golden[i];
+  return true;
+}
+
+bool MemDump::dump(const MemoryPort &mem) const
+{
+  bool ok = true;
+
+  for(size_t i = 0; i < regions_.size(); i++) {
+    const Region &region = regions_[i];
+    std::vector<uint8_t> data(region.len);
+
+    if(!mem.read(region.addr, data.data(), region.len)) {
+      std::cout<<"[MEMDUMP]: ERROR: 0x"<<std::hex<<region.addr<<std::dec<<" + "<<region.len
+               <<" bytes is not in the SRAM"<<std::endl;
+      ok = false;
+      continue;
+    }
+
+    std::ofstream out(region.file.c_str(), std::ios::binary);
+    out.write((const char *)data.data(), data.size());
+    if(!out) {
+      std::cout<<"[MEMDUMP]: ERROR: cannot write "<<region.file<<std::endl;
+      ok = false;
+      continue;
+    }
+    std::cout<<"[MEMDUMP]: 0x"<<std::hex<<region.addr<<std::dec<<" + "<<region.len<<" bytes written to "
+             <<region.file<<std::endl;
+
+    if(!region.golden.empty() && !compare(region, data))
+      ok = false;
+  }
+  return ok;
+}
+
+bool MemDump::compare(const Region &region, const std::vector<uint8_t> &data) const
+{
+  std::ifstream in(region.golden.c_str(), std::ios::binary);
+  if(!in) {
+    std::cout<<"[MEMDUMP]: ERROR: cannot open the golden file "<<region.golden<<std::endl;
+    return false;
+  }
+  std::vector<uint8_t> golden((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  if(golden.size() != data.size()) {
+    std::cout<<"[MEMDUMP]: ERROR: "<<region.golden<<" has "<<golden.size()<<" bytes, the region "
+             <<data.size()<<std::endl;
+    return false;
+  }
+
+  // compared by 32-bit word, the natural size of the results
+  unsigned int diffs = 0;
+  for(size_t k = 0; k < data.size(); k += 4) {
+    size_t n = data.size() - k < 4 ? data.size() - k : 4;
+    uint32_t got = 0, expected = 0;
+    for(size_t b = 0; b < n; b++) {
+      got      |= (uint32_t)data[k + b] << (8 * b);
+      expected |= (uint32_t)golden[k + b] << (8 * b);
+    }
+    if(got == expected)
+      continue;
+    if(diffs < kMaxDiffs) {
+      char line[96];
+      snprintf(line, sizeof(line), "0x%08x: 0x%08x, expected 0x%08x", (unsigned int)(region.addr + k), got, expected);
+      std::cout<<"[MEMDUMP]:   "<<line<<std::endl;
+    }
+    diffs++;
+  }
+
+  if(diffs != 0) {
+    std::cout<<"[MEMDUMP]: ERROR: "<<diffs<<" words differ from "<<region.golden<<std::endl;
+    return false;
+  }
+  std::cout<<"[MEMDUMP]: "<<region.file<<" matches "<<region.golden<<std::endl;
+  return true;
+}
@@ -0,0 +1,48 @@
+// Copyright EPFL contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef TB_MEMDUMP_H_
+#define TB_MEMDUMP_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "tb_sram.h"
+
+// SRAM regions written to raw binary files at the end of the simulation
+// (+dump_mem=) and compared with golden files (+golden=), so that a firmware
+// can leave the checking of its results to the host.
+class MemDump {
+ public:
+  // "<addr>:<len>:<file>[,<addr>:<len>:<file>...]", addr and len in decimal
+  // or 0x hexadecimal
+  bool parse(const std::string &regions);
+  // "<file>[,<file>...]", one per region in the same order, an empty entry
+  // skips its region
+  bool setGolden(const std::string &files);
+
+  bool enabled() const { return !regions_.empty(); }
+
+  // Writes the regions through the backdoor, false if a region is not in
+  // the memory, cannot be written or differs from its golden file
+  bool dump(const MemoryPort &mem) const;
+
+ private:
+  // Differences printed per region
+  static const unsigned int kMaxDiffs = 8;
+
+  struct Region {
+    uint32_t addr;
+    uint32_t len;
+    std::string file;
+    std::string golden;
+  };
+
+  bool compare(const Region &region, const std::vector<uint8_t> &data) const;
+
+  std::vector<Region> regions_;
+};
+
+#endif  // TB_MEMDUMP_H_
@@ -0,0 +1,176 @@
+// Copyright EPFL contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "tb_profiler.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+// gmon.out record tags, see gmon_out.h of binutils
+static const uint8_t kGmonTagTimeHist = 0;
+static const uint8_t kGmonTagCgArc    = 1;
+static const uint64_t kGmonMaxCount   = 0xffff;
+
+Profiler tb_profiler;
+
+static void put8(std::ostream &os, uint8_t v)
+{
+  os.put((char)v);
+}
+
+static void put16(std::ostream &os, uint16_t v)
+{
+  put8(os, v);
+  put8(os, v >> 8);
+}
+
+static void put32(std::ostream &os, uint32_t v)
+{
+  put16(os, v);
+  put16(os, v >> 16);
+}
+
+static bool countAfter(const std::pair<uint64_t, std::string> &a, const std::pair<uint64_t, std::string> &b)
+{
+  return a.first > b.first;
+}
+
+Profiler::Profiler()
+    : period_(0), low_pc_(0), high_pc_(0), last_pc_(0), skipped_(0), samples_(0) {}
+
+bool Profiler::init(const std::string &elf, unsigned int period)
+{
+  if(!elfLoadSymbols(elf, symbols_))
+    return false;
+  if(symbols_.empty()) {
+    std::cout<<"[PROFILE]: ERROR: "<<elf<<" has no function symbols"<<std::endl;
+    return false;
+  }
+
+  low_pc_  = symbols_.front().addr & ~1U;
+  high_pc_ = low_pc_;
+  for(size_t i = 0; i < symbols_.size(); i++)
+    high_pc_ = std::max(high_pc_, symbols_[i].addr + std::max(symbols_[i].size, 2U));
+  high_pc_ = (high_pc_ + 1) & ~1U;
+
+  hist_.assign((high_pc_ - low_pc_) / 2, 0);
+  period_ = period;
+  std::cout<<"[PROFILE]: Sampling the PC every "<<period_<<" cycles over 0x"<<std::hex<<low_pc_
+           <<"-0x"<<high_pc_<<std::dec<<" ("<<symbols_.size()<<" functions)"<<std::endl;
+  return true;
+}
+
+void Profiler::sample(uint32_t pc)
+{
+  last_pc_ = pc;
+  samples_++;
+  if(pc >= low_pc_ && pc < high_pc_)
+    hist_[(pc - low_pc_) / 2]++;
+}
+
+void Profiler::arc(uint32_t from_pc, uint32_t self_pc)
+{
+  arcs_[std::make_pair(from_pc, self_pc)]++;
+}
+
+void Profiler::skip(uint64_t cycles)
+{
+  if(period_ == 0)
+    return;
+  skipped_ += cycles;
+  uint64_t n = skipped_ / period_;
+  skipped_ %= period_;
+  samples_ += n;
+  if(last_pc_ >= low_pc_ && last_pc_ < high_pc_)
+    hist_[(last_pc_ - low_pc_) / 2] += n;
+}
+
+bool Profiler::writeGmon(const std::string &file) const
+{
+  std::ofstream os(file.c_str(), std::ios::binary);
+
+  // header: cookie, version and padding
+  os.write("gmon", 4);
+  put32(os, 1);
+  for(int i = 0; i < 12; i++)
+    put8(os, 0);
+
+  // the bins are 16-bit, gprof adds up the records of the same range
+  uint64_t max_count = hist_.empty() ? 0 : *std::max_element(hist_.begin(), hist_.end());
+  uint64_t records   = std::max<uint64_t>(1, (max_count + kGmonMaxCount - 1) / kGmonMaxCount);
+  for(uint64_t r = 0; r < records; r++) {
+    char dimen[15] = "seconds";
+    put8(os, kGmonTagTimeHist);
+    put32(os, low_pc_);
+    put32(os, high_pc_);
+    put32(os, hist_.size());
+    put32(os, kClockHz / period_);
+    os.write(dimen, sizeof(dimen));
+    put8(os, 's');
+    for(size_t i = 0; i < hist_.size(); i++) {
+      uint64_t left = hist_[i] > r * kGmonMaxCount ? hist_[i] - r * kGmonMaxCount : 0;
+      put16(os, std::min(left, kGmonMaxCount));
+    }
+  }
+
+  for(std::map<std::pair<uint32_t, uint32_t>, uint64_t>::const_iterator it = arcs_.begin(); it != arcs_.end(); ++it) {
+    put8(os, kGmonTagCgArc);
+    put32(os, it->first.first);
+    put32(os, it->first.second);
+    put32(os, std::min<uint64_t>(it->second, 0x7fffffff));
+  }
+
+  os.close();
+  if(!os) {
+    std::cout<<"[PROFILE]: ERROR: cannot write "<<file<<std::endl;
+    return false;
+  }
+  std::cout<<"[PROFILE]: "<<samples_<<" samples and "<<arcs_.size()<<" call arcs written to "<<file<<std::endl;
+  return true;
+}
+
+void Profiler::printFlat(unsigned int top) const
+{
+  std::vector<uint64_t> counts(symbols_.size() + 1, 0);
+
+  for(size_t i = 0; i < hist_.size(); i++) {
+    if(hist_[i] == 0)
+      continue;
+    uint32_t pc = low_pc_ + 2 * i;
+    size_t s    = symbols_.size();
+    for(size_t k = 0; k < symbols_.size() && symbols_[k].addr <= pc; k++) {
+      if(pc < symbols_[k].addr + std::max(symbols_[k].size, 2U))
+        s = k;
+    }
+    counts[s] += hist_[i];
+  }
+
+  std::vector<std::pair<uint64_t, std::string> > flat;
+  for(size_t k = 0; k < counts.size(); k++) {
+    if(counts[k] != 0)
+      flat.push_back(std::make_pair(counts[k], k < symbols_.size() ? symbols_[k].name : "<unknown>"));
+  }
+  std::stable_sort(flat.begin(), flat.end(), countAfter);
+
+  std::cout<<"[PROFILE]:   %time      cycles  function"<<std::endl;
+  for(size_t k = 0; k < flat.size() && k < top; k++) {
+    std::cout<<"[PROFILE]: "<<std::setw(7)<<std::fixed<<std::setprecision(2)
+             <<(samples_ ? 100.0 * flat[k].first / samples_ : 0.0)<<std::setw(12)
+             <<flat[k].first * period_<<"  "<<flat[k].second<<std::endl;
+  }
+  std::cout.unsetf(std::ios::fixed);
+  std::cout<<std::setprecision(6);
+}
+
+extern "C" void tb_prof_sample(int pc)
+{
+  tb_profiler.sample((uint32_t)pc);
+}
+
+extern "C" void tb_prof_arc(int from_pc, int self_pc)
+{
+  tb_profiler.arc((uint32_t)from_pc, (uint32_t)self_pc);
+}
@@ -0,0 +1,59 @@
+// Copyright EPFL contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef TB_PROFILER_H_
+#define TB_PROFILER_H_
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tb_elfloader.h"
+
+// Statistical profiler of the firmware.
+//
+// Every period cycles tb_util.svh sends the PC of the last retired
+// instruction, together with the call arcs (jal/jalr linking to ra or t0)
+// retired in between. The samples are binned over the functions of the
+// firmware ELF and written as a gmon.out file, for
+// riscv32-unknown-elf-gprof main.elf gmon.out (flat profile and call graph).
+class Profiler {
+ public:
+  // Simulated clock, used to express the samples in seconds for gprof
+  static const uint64_t kClockHz = 100 * 1000 * 1000;
+
+  Profiler();
+
+  // Reads the function symbols of the firmware ELF
+  bool init(const std::string &elf, unsigned int period);
+  unsigned int period() const { return period_; }
+
+  void sample(uint32_t pc);
+  void arc(uint32_t from_pc, uint32_t self_pc);
+  // Idle cycles skipped by the WFI fast-forward, charged to the last PC
+  void skip(uint64_t cycles);
+
+  bool writeGmon(const std::string &file) const;
+  // Prints the functions with the most samples
+  void printFlat(unsigned int top) const;
+
+ private:
+  unsigned int period_;
+  std::vector<ElfSymbol> symbols_;
+  uint32_t low_pc_;
+  uint32_t high_pc_;
+  uint32_t last_pc_;
+  uint64_t skipped_;
+  uint64_t samples_;
+  // one bin per 2 bytes of [low_pc_, high_pc_), samples out of it are dropped
+  std::vector<uint64_t> hist_;
+  std::map<std::pair<uint32_t, uint32_t>, uint64_t> arcs_;
+};
+
+// Instance fed by the tb_prof_sample and tb_prof_arc DPI functions
+extern Profiler tb_profiler;
+
+#endif  // TB_PROFILER_H_
@@ -0,0 +1,285 @@
+// Copyright EPFL contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "tb_sim.h"
+
+#include "Vtestharness__Syms.h"
+#ifdef TB_SAVABLE
+#include "verilated_save.h"
+#endif
+#include "tb_elfloader.h"
+#include "tb_hostcall.h"
+#include "tb_profiler.h"
+
+#include <stdlib.h>
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+XHeepSim::XHeepSim(const std::string &trace_file, int trace_depth)
+    : trace_(NULL), time_(0), trace_start_(0), trace_stop_(0), ff_enabled_(false),
+      ff_min_cycles_(100), ff_skipped_cycles_(0), ff_jumps_(0), gpio_oe_(0), gpio_out_(0)
+{
+  int mem_size, num_banks, ram_start, num_banks_il;
+
+  // Tracing must be enabled before the model is built
+  Verilated::traceEverOn(!trace_file.empty());
+  dut_ = new Vtestharness;
+  if(!trace_file.empty()) {
+    trace_ = new VerilatedFstC;
+    dut_->trace(trace_, trace_depth);
+    trace_->open(trace_file.c_str());
+  }
+
+  svSetScope(svGetScopeFromName("TOP.testharness"));
+  svScope scope = svGetScope();
+  if (!scope) {
+    std::cout<<"Warning: svGetScope failed"<< std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  //the loaders and the host calls access the SRAM through the backdoor
+  dut_->tb_getMemSize(&mem_size, &num_banks);
+  dut_->tb_getMemCfg(&ram_start, &num_banks_il);
+  if(!sram_.init(ram_start, mem_size, num_banks, num_banks_il) || !tb_hostcall.init(&sram_))
+    exit(EXIT_FAILURE);
+
+  dut_->clk_i                = 0;
+  dut_->rst_ni               = 1;
+  dut_->jtag_tck_i           = 0;
+  dut_->jtag_tms_i           = 0;
+  dut_->jtag_trst_ni         = 0;
+  dut_->jtag_tdi_i           = 0;
+  dut_->execute_from_flash_i = 1;
+  dut_->boot_select_i        = 0;
+}
+
+XHeepSim::~XHeepSim()
+{
+  dut_->final();
+  if(trace_ != NULL) {
+    trace_->close();
+    delete trace_;
+  }
+  delete dut_;
+}
+
+void XHeepSim::setTraceWindow(vluint64_t start, vluint64_t stop)
+{
+  trace_start_ = start;
+  trace_stop_  = stop;
+}
+
+void XHeepSim::setFastForward(bool enable, vluint64_t min_cycles)
+{
+  ff_enabled_    = enable;
+  ff_min_cycles_ = min_cycles;
+}
+
+void XHeepSim::setBootMode(int boot_sel, int execute_from_flash)
+{
+  dut_->boot_select_i        = boot_sel;
+  dut_->execute_from_flash_i = execute_from_flash;
+}
+
+void XHeepSim::dumpTrace()
+{
+  vluint64_t cycle = time_ / 2;
+  if(cycle >= trace_start_ && (trace_stop_ == 0 || cycle < trace_stop_))
+    trace_->dump(time_);
+}
+
+void XHeepSim::start()
+{
+  dut_->eval();
+  if(trace_ != NULL) dumpTrace();
+  time_++;
+}
+
+void XHeepSim::reset()
+{
+  dut_->rst_ni = 1;
+  //this creates the negedge
+  tick(50);
+  dut_->rst_ni = 0;
+  tick(50);
+
+  dut_->rst_ni = 1;
+  tick(20);
+}
+
+void XHeepSim::tick(vluint64_t edges)
+{
+  //untraced runs do not pay for the dump
+  if(trace_ == NULL) {
+    for(vluint64_t i = 0; i < edges; i++) {
+      dut_->clk_i ^= 1;
+      dut_->eval();
+      time_++;
+    }
+    return;
+  }
+  for(vluint64_t i = 0; i < edges; i++) {
+    dut_->clk_i ^= 1;
+    dut_->eval();
+    dumpTrace();
+    time_++;
+  }
+}
+
+// Jumps over the cycles in which the core sleeps and nothing else moves, at
+// most max_cycles. It must be called with the clock low. Returns the number
+// of skipped cycles, which count as simulated ones.
+vluint64_t XHeepSim::fastForward(vluint64_t max_cycles)
+{
+  long long skipped = 0;
+
+  if(dut_->clk_i != 0 || max_cycles < ff_min_cycles_)
+    return 0;
+  dut_->tb_wfi_fast_forward(ff_min_cycles_, max_cycles, &skipped);
+  if(skipped <= 0)
+    return 0;
+
+  //the updated timers show up right before the next rising edge
+  time_ += 2 * skipped - 1;
+  dut_->eval();
+  if(trace_ != NULL) dumpTrace();
+  time_++;
+
+  ff_skipped_cycles_ += skipped;
+  ff_jumps_++;
+  tb_profiler.skip(skipped);
+  return skipped;
+}
+
+void XHeepSim::step(vluint64_t ncycles)
+{
+  vluint64_t end = time_ + 2 * ncycles;
+
+  if(!ff_enabled_) {
+    tick(2 * ncycles);
+    return;
+  }
+  while(time_ < end) {
+    fastForward((end - time_) / 2);
+    tick(std::min<vluint64_t>(end - time_, 2 * kFFCheckCycles));
+  }
+}
+
+bool XHeepSim::runUntil(const std::function<bool(XHeepSim &)> &pred, vluint64_t max_cycles)
+{
+  vluint64_t start = time_;
+  vluint64_t cycles;
+  while(!pred(*this)) {
+    cycles = (time_ - start) / 2;
+    if(max_cycles != 0 && cycles >= max_cycles)
+      return false;
+    if(ff_enabled_ && cycles % kFFCheckCycles == 0)
+      fastForward(max_cycles != 0 ? max_cycles - cycles : kFFMaxCycles);
+    tick(2);
+  }
+  return true;
+}
+
+static bool simExited(XHeepSim &sim)
+{
+  return sim.exited();
+}
+
+bool XHeepSim::runUntilExit(vluint64_t max_cycles)
+{
+  return runUntil(simExited, max_cycles);
+}
+
+bool XHeepSim::loadElf(const std::string &file)
+{
+  std::vector<ElfSegment> segments;
+
+  if(!elfLoadSegments(file, segments))
+    return false;
+
+  for(size_t i = 0; i < segments.size(); i++) {
+    if(!sram_.write(segments[i].addr, &segments[i].data[0], segments[i].data.size())) {
+      std::cout<<"[TESTBENCH]: ERROR: ELF segment at 0x"<<std::hex<<segments[i].addr<<std::dec
+               <<" ("<<segments[i].data.size()<<" bytes) does not fit in the SRAM"<<std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+void XHeepSim::loadHex(const std::string &file)
+{
+  dut_->tb_loadHEX(file.c_str());
+}
+
+void XHeepSim::startFirmware()
+{
+  tick(1);
+  dut_->tb_set_exit_loop();
+  tick(1);
+}
+
+bool XHeepSim::readMem(uint32_t addr, uint8_t *data, size_t len) const
+{
+  return sram_.read(addr, data, len);
+}
+
+bool XHeepSim::writeMem(uint32_t addr, const uint8_t *data, size_t len)
+{
+  return sram_.write(addr, data, len);
+}
+
+void XHeepSim::setIrq(unsigned int line, bool level)
+{
+  dut_->tb_set_ext_irq(line, level);
+}
+
+void XHeepSim::driveGpio(uint32_t mask, uint32_t value)
+{
+  gpio_oe_ |= mask;
+  gpio_out_ = (gpio_out_ & ~mask) | (value & mask);
+  dut_->tb_gpio_drive(gpio_oe_, gpio_out_);
+}
+
+void XHeepSim::releaseGpio(uint32_t mask)
+{
+  gpio_oe_ &= ~mask;
+  dut_->tb_gpio_drive(gpio_oe_, gpio_out_);
+}
+
+uint32_t XHeepSim::readGpio()
+{
+  int value;
+  dut_->tb_gpio_read(&value);
+  return value;
+}
+
+#ifdef TB_SAVABLE
+void XHeepSim::saveCheckpoint(const std::string &file)
+{
+  VerilatedSave os;
+  os.open(file.c_str());
+  os << time_;
+  os << *dut_;
+#ifdef TB_SPARSE_SRAM
+  SparseSram::saveAll(os);
+#endif
+  os.close();
+}
+
+void XHeepSim::restoreCheckpoint(const std::string &file)
+{
+  VerilatedRestore os;
+  os.open(file.c_str());
+  os >> time_;
+  os >> *dut_;
+#ifdef TB_SPARSE_SRAM
+  SparseSram::restoreAll(os);
+#endif
+  os.close();
+  //the C state of the UART DPI is not part of the checkpoint
+  dut_->tb_uart_reinit();
+}
+#endif
@@ -0,0 +1,121 @@
+// Copyright EPFL contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef TB_SIM_H_
+#define TB_SIM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <functional>
+#include <string>
+
+#include "verilated.h"
+#include "verilated_fst_c.h"
+#include "Vtestharness.h"
+
+#include "tb_sram.h"
+
+// Verilated x-heep testharness driven from C++.
+//
+// tb_top.cpp is one client of this class, a co-simulation can link the same
+// files and step x-heep in lockstep with its own models:
+//
+//   Verilated::commandArgs(argc, argv);
+//   XHeepSim sim;
+//   sim.reset();
+//   sim.loadElf("main.elf");
+//   sim.startFirmware();
+//   while(!sim.exited()) {
+//     sim.step(100);
+//     sim.setIrq(2, sensor.ready());
+//   }
+//
+// Only one instance can exist, the DPI tasks of tb_util.svh are bound to the
+// TOP.testharness scope. Time is counted in clock edges, two per cycle.
+class XHeepSim {
+ public:
+  // Idle cycles checked by the fast-forward, and longest single jump
+  static const unsigned int kFFCheckCycles = 16;
+  static const vluint64_t kFFMaxCycles = 1ULL << 40;
+
+  // An empty trace_file disables the waveform tracing
+  explicit XHeepSim(const std::string &trace_file = "", int trace_depth = 99);
+  ~XHeepSim();
+
+  Vtestharness *dut() { return dut_; }
+  VerilatedFstC *trace() { return trace_; }
+
+  // Waveform window in clock cycles, stop = 0 means until the end
+  void setTraceWindow(vluint64_t start, vluint64_t stop);
+  // Jumps over the WFI idle periods of at least min_cycles cycles, see
+  // tb_wfi_fast_forward in tb_util.svh
+  void setFastForward(bool enable, vluint64_t min_cycles);
+  bool fastForwardEnabled() const { return ff_enabled_; }
+  vluint64_t ffSkippedCycles() const { return ff_skipped_cycles_; }
+  vluint64_t ffJumps() const { return ff_jumps_; }
+  // Boot pins, sampled when the reset is released
+  void setBootMode(int boot_sel, int execute_from_flash);
+
+  vluint64_t time() const { return time_; }
+  vluint64_t cycles() const { return time_ / 2; }
+
+  // First evaluation of the model, must come before anything else
+  void start();
+  void reset();
+  // Toggles the clock edges times, no fast-forward
+  void tick(vluint64_t edges = 1);
+  // Runs ncycles clock cycles, jumping over the idle periods when enabled
+  void step(vluint64_t ncycles = 1);
+  // Runs until pred is true, checked every cycle, or for at most max_cycles
+  // cycles (0 = no limit). Returns false on timeout.
+  bool runUntil(const std::function<bool(XHeepSim &)> &pred, vluint64_t max_cycles = 0);
+  bool runUntilExit(vluint64_t max_cycles = 0);
+
+  bool exited() const { return dut_->exit_valid_o == 1; }
+  uint32_t exitValue() const { return dut_->exit_value_o; }
+
+  // Loads the firmware straight into the memory banks
+  bool loadElf(const std::string &file);
+  void loadHex(const std::string &file);
+  // Releases the boot loop waiting for a firmware loaded through the backdoor
+  void startFirmware();
+
+  // Backdoor access to the SRAM banks, false if the range is not in the SRAM
+  bool readMem(uint32_t addr, uint8_t *data, size_t len) const;
+  bool writeMem(uint32_t addr, const uint8_t *data, size_t len);
+  const MemoryPort &memory() const { return sram_; }
+
+  // Level of an external interrupt line of the PLIC (intr_vector_ext_i)
+  void setIrq(unsigned int line, bool level);
+  // Drives the GPIO pads in mask to value until they are released. Only the
+  // pads not used by the testharness devices can be driven, see
+  // tb_gpio_drive in tb_util.svh
+  void driveGpio(uint32_t mask, uint32_t value);
+  void releaseGpio(uint32_t mask);
+  uint32_t readGpio();
+
+#ifdef TB_SAVABLE
+  void saveCheckpoint(const std::string &file);
+  void restoreCheckpoint(const std::string &file);
+#endif
+
+ private:
+  void dumpTrace();
+  vluint64_t fastForward(vluint64_t max_cycles);
+
+  Vtestharness *dut_;
+  VerilatedFstC *trace_;
+  SramBackdoor sram_;
+  vluint64_t time_;
+  vluint64_t trace_start_;
+  vluint64_t trace_stop_;
+  bool ff_enabled_;
+  vluint64_t ff_min_cycles_;
+  vluint64_t ff_skipped_cycles_;
+  vluint64_t ff_jumps_;
+  uint32_t gpio_oe_;
+  uint32_t gpio_out_;
+};
+
+#endif  // TB_SIM_H_
@@ -0,0 +1,143 @@
+// Copyright EPFL contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "tb_slowmem.h"
+
+#include <stdio.h>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+SlowMemLatency tb_slowmem;
+
+SlowMemLatency::SlowMemLatency()
+  : mode_(kRandom), wait_min_(0), wait_max_(0), latency_min_(kMinLatency), latency_max_(33),
+    trace_pos_(0), wait_(0), requests_(0), total_wait_(0), total_latency_(0)
+{
+  draw();
+}
+
+bool SlowMemLatency::configure(const std::string &profile)
+{
+  unsigned int wmin, wmax;
+  int lmin, lmax;
+  char c;
+
+  if(profile.compare("random") == 0) {
+    mode_        = kRandom;
+    latency_min_ = kMinLatency;
+    latency_max_ = 33;
+  } else if(sscanf(profile.c_str(), "fixed,%u,%d%c", &wmin, &lmin, &c) == 2) {
+    mode_        = kFixed;
+    wait_min_    = wait_max_ = wmin;
+    latency_min_ = latency_max_ = lmin;
+  } else if(sscanf(profile.c_str(), "uniform,%u,%u,%d,%d%c", &wmin, &wmax, &lmin, &lmax, &c) == 4) {
+    mode_        = kUniform;
+    wait_min_    = wmin;
+    wait_max_    = wmax;
+    latency_min_ = lmin;
+    latency_max_ = lmax;
+  } else if(profile.compare(0, 6, "trace,") == 0) {
+    std::string file = profile.substr(6);
+    std::ifstream in(file.c_str());
+    if(!in) {
+      std::cout<<"[SLOWMEM]: ERROR: Cannot open "<<file<<std::endl;
+      return false;
+    }
+    trace_.clear();
+    std::string line;
+    while(std::getline(in, line)) {
+      std::istringstream fields(line);
+      unsigned int wait;
+      int latency;
+      if(line.empty() || line[0] == '#')
+        continue;
+      if(!(fields>>wait>>latency) || latency < kMinLatency || latency > kMaxLatency) {
+        std::cout<<"[SLOWMEM]: ERROR: Expected \"<wait> <latency>\" with a latency of "<<kMinLatency<<" to "
+                 <<kMaxLatency<<" cycles in "<<file<<": "<<line<<std::endl;
+        return false;
+      }
+      trace_.push_back(std::make_pair(wait, latency));
+    }
+    if(trace_.empty()) {
+      std::cout<<"[SLOWMEM]: ERROR: No request in "<<file<<std::endl;
+      return false;
+    }
+    mode_      = kTrace;
+    trace_pos_ = 0;
+  } else {
+    std::cout<<"[SLOWMEM]: ERROR: Unknown latency profile "<<profile<<", expected random, fixed,<wait>,<latency>, "
+             <<"uniform,<wmin>,<wmax>,<lmin>,<lmax> or trace,<file>"<<std::endl;
+    return false;
+  }
+
+  if(wait_min_ > wait_max_ || latency_min_ > latency_max_ || latency_min_ < kMinLatency || latency_max_ > kMaxLatency) {
+    std::cout<<"[SLOWMEM]: ERROR: The latency of "<<profile<<" must be within "<<kMinLatency<<" and "
+             <<kMaxLatency<<" cycles, with the minimums before the maximums"<<std::endl;
+    return false;
+  }
+  draw();
+  return true;
+}
+
+void SlowMemLatency::setSeed(uint32_t seed)
+{
+  rng_.seed(seed);
+  trace_pos_ = 0;
+  draw();
+}
+
+void SlowMemLatency::draw()
+{
+  switch(mode_) {
+    case kRandom:
+    case kFixed:
+    case kUniform:
+      next_wait_    = std::uniform_int_distribution<unsigned int>(wait_min_, wait_max_)(rng_);
+      next_latency_ = std::uniform_int_distribution<int>(latency_min_, latency_max_)(rng_);
+      break;
+    case kTrace:
+      next_wait_    = trace_[trace_pos_].first;
+      next_latency_ = trace_[trace_pos_].second;
+      trace_pos_    = (trace_pos_ + 1) % trace_.size();
+      break;
+  }
+}
+
+void SlowMemLatency::tick(bool rst_n, bool req, bool gnt, bool &gnt_next, int &latency)
+{
+  if(!rst_n) {
+    wait_ = 0;
+  } else if(req && gnt) {
+    requests_++;
+    total_wait_    += wait_;
+    total_latency_ += next_latency_;
+    wait_ = 0;
+    draw();
+  } else if(req) {
+    wait_++;
+  }
+
+  if(mode_ == kRandom)
+    gnt_next = (rng_() & 1) != 0;
+  else
+    gnt_next = rst_n && wait_ >= next_wait_;
+  latency = next_latency_;
+}
+
+void SlowMemLatency::printStats() const
+{
+  if(requests_ == 0)
+    return;
+  std::cout<<"[SLOWMEM]: "<<requests_<<" requests, average wait "<<(double)total_wait_ / requests_
+           <<" cycles, average latency "<<(double)total_latency_ / requests_<<" cycles"<<std::endl;
+}
+
+extern "C" void tb_slow_memory_tick(unsigned char rst_n, unsigned char req, unsigned char gnt,
+                                    unsigned char *gnt_next, int *latency)
+{
+  bool next;
+  tb_slowmem.tick(rst_n != 0, req != 0, gnt != 0, next, *latency);
+  *gnt_next = next;
+}
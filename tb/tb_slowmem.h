@@ -0,0 +1,67 @@
+// Copyright EPFL contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef TB_SLOWMEM_H_
+#define TB_SLOWMEM_H_
+
+#include <stdint.h>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Grant delays and read latencies of the slow_memory example, the external
+// memory behind the OBI FIFO of the testharness. Called once per clock cycle
+// by slow_memory.sv under Verilator. Profiles:
+//
+//   random                              a grant with probability 1/2 on every
+//                                       cycle and a latency of 2 to 33 cycles,
+//                                       as the $random of the RTL (default)
+//   fixed,<wait>,<latency>              every request
+//   uniform,<wmin>,<wmax>,<lmin>,<lmax> drawn for every request
+//   trace,<file>                        one "<wait> <latency>" line per
+//                                       request, replayed in a loop
+//
+// The wait is the number of cycles a request waits for its grant, the latency
+// the number of cycles from the grant to the read data (at least 2). The
+// random draws only depend on the seed.
+class SlowMemLatency {
+ public:
+  static const int kMinLatency = 2;
+  static const int kMaxLatency = 65537;
+
+  SlowMemLatency();
+
+  bool configure(const std::string &profile);
+  void setSeed(uint32_t seed);
+
+  void tick(bool rst_n, bool req, bool gnt, bool &gnt_next, int &latency);
+
+  void printStats() const;
+
+ private:
+  enum Mode { kRandom, kFixed, kUniform, kTrace };
+
+  void draw();
+
+  Mode mode_;
+  std::mt19937 rng_;
+  unsigned int wait_min_, wait_max_;
+  int latency_min_, latency_max_;
+  std::vector<std::pair<unsigned int, int> > trace_;
+  size_t trace_pos_;
+
+  // Current request
+  unsigned int wait_;
+  unsigned int next_wait_;
+  int next_latency_;
+
+  uint64_t requests_;
+  uint64_t total_wait_;
+  uint64_t total_latency_;
+};
+
+extern SlowMemLatency tb_slowmem;
+
+#endif  // TB_SLOWMEM_H_
@@ -0,0 +1,514 @@
+// Copyright EPFL contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "tb_spiflash.h"
+
+#include "svdpi.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <iostream>
+
+// W25Q128JW instructions
+enum {
+  kWriteEnable     = 0x06,
+  kVolatileSrWe    = 0x50,
+  kWriteDisable    = 0x04,
+  kReleasePd       = 0xAB,
+  kReadMfgId       = 0x90,
+  kReadJedecId     = 0x9F,
+  kReadUniqueId    = 0x4B,
+  kRead            = 0x03,
+  kFastRead        = 0x0B,
+  kFastReadQuadIo  = 0xEB,
+  kPageProgram     = 0x02,
+  kQuadPageProgram = 0x32,
+  kSectorErase     = 0x20,
+  kBlockErase32    = 0x52,
+  kBlockErase64    = 0xD8,
+  kChipErase       = 0xC7,
+  kChipErase2      = 0x60,
+  kReadSr1         = 0x05,
+  kReadSr2         = 0x35,
+  kReadSr3         = 0x15,
+  kWriteSr1        = 0x01,
+  kWriteSr2        = 0x31,
+  kWriteSr3        = 0x11,
+  kPowerDown       = 0xB9,
+  kEnableReset     = 0x66,
+  kReset           = 0x99,
+  kModeReset       = 0xFF
+};
+
+static const uint8_t kManufacturer = 0xEF;
+static const uint8_t kDevice       = 0x17;
+static const uint8_t kJedec[3]     = {0xEF, 0x60, 0x18};
+static const uint8_t kUnique[8]    = {0x58, 0x48, 0x45, 0x45, 0x50, 0x53, 0x49, 0x4D};
+
+SpiFlash tb_spiflash;
+
+SpiFlash::SpiFlash()
+    : mem_(NULL), mapped_(0), quad_dummy_(8), cycle_(0), busy_until_(0), wel_(false),
+      volatile_sr_we_(false), powered_down_(false), reset_enabled_(false),
+      continuous_read_(false), csb_(true), sck_(false), phase_(kIgnore), source_(kMem),
+      cmd_(0), in_width_(1), out_width_(1), shift_in_(0), bits_in_(0), shift_out_(0),
+      bits_out_(0), dummy_left_(0), addr_bytes_(0), data_bytes_(0), addr_(0),
+      pending_(false), io_out_(0), io_oe_(0), page_(256, 0xff), unsupported_(256, false),
+      commands_(0), bytes_read_(0), bytes_programmed_(0), erases_(0)
+{
+  // Typical values of the datasheet at 100MHz
+  timing_.page_program = 40000;
+  timing_.sector_erase = 4500000;
+  timing_.block_erase  = 15000000;
+  timing_.chip_erase   = 4000000000ULL;
+  memset(status_, 0, sizeof(status_));
+  // QE is set in the factory on the quad parts
+  status_[1] = 0x02;
+}
+
+SpiFlash::~SpiFlash()
+{
+  if(mem_ != NULL)
+    munmap(mem_, kSize);
+}
+
+bool SpiFlash::open(const std::string &file, bool writeback)
+{
+  int fd = ::open(file.c_str(), writeback ? O_RDWR : O_RDONLY);
+  if(fd < 0) {
+    std::cout<<"[FLASH]: ERROR: cannot open "<<file<<": "<<strerror(errno)<<std::endl;
+    return false;
+  }
+  struct stat st;
+  if(fstat(fd, &st) != 0 || (size_t)st.st_size > kSize) {
+    std::cout<<"[FLASH]: ERROR: "<<file<<" is larger than the flash ("<<kSize<<" bytes)"<<std::endl;
+    close(fd);
+    return false;
+  }
+  mapped_ = st.st_size;
+
+  void *p;
+  if(writeback) {
+    // grow the image with erased bytes so that the whole array is mapped
+    if(mapped_ < kSize) {
+      std::vector<uint8_t> erased(kSize - mapped_, 0xff);
+      if(pwrite(fd, &erased[0], erased.size(), mapped_) != (ssize_t)erased.size()) {
+        std::cout<<"[FLASH]: ERROR: cannot extend "<<file<<std::endl;
+        close(fd);
+        return false;
+      }
+    }
+    p = mmap(NULL, kSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  } else {
+    // private copy of the image on top of an erased array
+    p = mmap(NULL, kSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(p != MAP_FAILED && mapped_ > 0 &&
+       mmap(p, mapped_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+      munmap(p, kSize);
+      p = MAP_FAILED;
+    }
+    if(p != MAP_FAILED)
+      memset((uint8_t *)p + mapped_, 0xff, kSize - mapped_);
+  }
+  close(fd);
+  if(p == MAP_FAILED) {
+    std::cout<<"[FLASH]: ERROR: cannot map "<<file<<": "<<strerror(errno)<<std::endl;
+    return false;
+  }
+
+  if(mem_ != NULL)
+    munmap(mem_, kSize);
+  mem_ = (uint8_t *)p;
+  std::cout<<"[FLASH]: "<<file<<" mapped ("<<mapped_<<" bytes"<<(writeback ? ", writeback" : "")<<")"<<std::endl;
+  return true;
+}
+
+void SpiFlash::update(uint64_t cycle, bool csb, bool sck, uint8_t io_in, uint8_t &io_out, uint8_t &io_oe)
+{
+  cycle_ = cycle;
+  if(csb != csb_) {
+    if(csb)
+      deselect(cycle);
+    else
+      select(cycle);
+  } else if(!csb && sck != sck_) {
+    if(sck)
+      risingEdge(io_in);
+    else
+      fallingEdge();
+  }
+  csb_   = csb;
+  sck_   = sck;
+  io_out = io_out_;
+  io_oe  = io_oe_;
+}
+
+void SpiFlash::select(uint64_t cycle)
+{
+  cycle_       = cycle;
+  phase_       = kCmd;
+  source_      = kMem;
+  cmd_         = 0;
+  in_width_    = 1;
+  out_width_   = 1;
+  bits_in_     = 0;
+  bits_out_    = 0;
+  addr_bytes_  = 0;
+  data_bytes_  = 0;
+  addr_        = 0;
+  pending_     = false;
+  io_oe_       = 0;
+  std::fill(page_.begin(), page_.end(), 0xff);
+
+  if(mem_ == NULL) {
+    // no image given: start from an erased array
+    void *p = mmap(NULL, kSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(p == MAP_FAILED) {
+      std::cout<<"[FLASH]: ERROR: cannot allocate the array"<<std::endl;
+      exit(EXIT_FAILURE);
+    }
+    mem_ = (uint8_t *)p;
+    memset(mem_, 0xff, kSize);
+  }
+
+  // Continuous read mode: the Fast Read Quad I/O instruction is implied
+  if(continuous_read_ && !busy()) {
+    commands_++;
+    cmd_      = kFastReadQuadIo;
+    in_width_ = 4;
+    phase_    = kAddr;
+  }
+}
+
+void SpiFlash::deselect(uint64_t cycle)
+{
+  cycle_ = cycle;
+  io_oe_ = 0;
+  if(pending_) {
+    switch(cmd_) {
+      case kPageProgram:
+      case kQuadPageProgram: {
+        // only the addressed page is programmed, the address wraps inside it
+        uint8_t *page = mem_ + (addr_ & ~0xffU);
+        for(size_t i = 0; i < page_.size(); i++)
+          page[i] &= page_[i];
+        bytes_programmed_ += std::min(data_bytes_, 256U);
+        busy_until_ = cycle_ + timing_.page_program;
+        wel_        = false;
+        break;
+      }
+      case kSectorErase:
+        erase(addr_, 4 * 1024, timing_.sector_erase);
+        break;
+      case kBlockErase32:
+        erase(addr_, 32 * 1024, timing_.block_erase);
+        break;
+      case kBlockErase64:
+        erase(addr_, 64 * 1024, timing_.block_erase);
+        break;
+      case kChipErase:
+      case kChipErase2:
+        erase(0, kSize, timing_.chip_erase);
+        break;
+      case kWriteSr1:
+      case kWriteSr2:
+      case kWriteSr3:
+        if(!volatile_sr_we_)
+          wel_ = false;
+        volatile_sr_we_ = false;
+        break;
+      default:
+        break;
+    }
+  }
+  pending_ = false;
+  phase_   = kIgnore;
+}
+
+void SpiFlash::risingEdge(uint8_t io_in)
+{
+  if(phase_ == kDummy) {
+    if(--dummy_left_ == 0)
+      phase_ = kDataOut;
+    return;
+  }
+  if(phase_ == kDataOut || phase_ == kIgnore)
+    return;
+
+  if(in_width_ == 4) {
+    shift_in_ = (shift_in_ << 4) | (io_in & 0xf);
+    bits_in_ += 4;
+  } else {
+    shift_in_ = (shift_in_ << 1) | (io_in & 0x1);
+    bits_in_ += 1;
+  }
+  if(bits_in_ == 8) {
+    bits_in_ = 0;
+    byteIn(shift_in_);
+  }
+}
+
+void SpiFlash::fallingEdge()
+{
+  if(phase_ != kDataOut) {
+    io_oe_ = 0;
+    return;
+  }
+  if(bits_out_ == 0) {
+    shift_out_ = byteOut();
+    bits_out_  = 8;
+  }
+  if(out_width_ == 4) {
+    io_out_ = shift_out_ >> 4;
+    io_oe_  = 0xf;
+    shift_out_ <<= 4;
+    bits_out_ -= 4;
+  } else {
+    // single data output on DO (io1)
+    io_out_ = ((shift_out_ >> 7) & 0x1) << 1;
+    io_oe_  = 0x2;
+    shift_out_ <<= 1;
+    bits_out_ -= 1;
+  }
+}
+
+void SpiFlash::command(uint8_t cmd)
+{
+  commands_++;
+  cmd_   = cmd;
+  phase_ = kIgnore;
+
+  // while powered down only the release instruction is decoded, while busy
+  // only the status registers can be read
+  if(powered_down_ && cmd != kReleasePd)
+    return;
+  if(busy() && cmd != kReadSr1 && cmd != kReadSr2 && cmd != kReadSr3)
+    return;
+  if(cmd != kReset)
+    reset_enabled_ = false;
+
+  switch(cmd) {
+    case kWriteEnable:
+      wel_ = true;
+      break;
+    case kVolatileSrWe:
+      volatile_sr_we_ = true;
+      break;
+    case kWriteDisable:
+      wel_ = false;
+      break;
+    case kReleasePd:
+      // three dummy bytes, then the device ID
+      powered_down_ = false;
+      phase_        = kAddr;
+      break;
+    case kPowerDown:
+      powered_down_ = true;
+      break;
+    case kReadMfgId:
+    case kReadUniqueId:
+    case kRead:
+    case kFastRead:
+      phase_ = kAddr;
+      break;
+    case kFastReadQuadIo:
+      phase_    = kAddr;
+      in_width_ = 4;
+      break;
+    case kReadJedecId:
+      phase_  = kDataOut;
+      source_ = kJedecId;
+      break;
+    case kPageProgram:
+    case kQuadPageProgram:
+    case kSectorErase:
+    case kBlockErase32:
+    case kBlockErase64:
+      if(wel_)
+        phase_ = kAddr;
+      break;
+    case kChipErase:
+    case kChipErase2:
+      pending_ = wel_;
+      break;
+    case kReadSr1:
+    case kReadSr2:
+    case kReadSr3:
+      phase_  = kDataOut;
+      source_ = kStatus;
+      break;
+    case kWriteSr1:
+    case kWriteSr2:
+    case kWriteSr3:
+      if(wel_ || volatile_sr_we_)
+        phase_ = kDataIn;
+      break;
+    case kEnableReset:
+      reset_enabled_ = true;
+      break;
+    case kReset:
+      if(reset_enabled_) {
+        wel_             = false;
+        volatile_sr_we_  = false;
+        continuous_read_ = false;
+        reset_enabled_   = false;
+      }
+      break;
+    case kModeReset:
+      continuous_read_ = false;
+      break;
+    default:
+      if(!unsupported_[cmd]) {
+        std::cout<<"[FLASH]: WARNING: unsupported instruction 0x"<<std::hex<<(unsigned int)cmd<<std::dec<<" ignored"<<std::endl;
+        unsupported_[cmd] = true;
+      }
+      break;
+  }
+}
+
+void SpiFlash::addressDone()
+{
+  switch(cmd_) {
+    case kReleasePd:
+      phase_  = kDataOut;
+      source_ = kDeviceId;
+      break;
+    case kReadMfgId:
+      phase_  = kDataOut;
+      source_ = kMfgId;
+      break;
+    case kReadUniqueId:
+      // four dummy bytes
+      phase_      = kDummy;
+      dummy_left_ = 32;
+      source_     = kUniqueId;
+      break;
+    case kRead:
+      phase_ = kDataOut;
+      break;
+    case kFastRead:
+      phase_      = kDummy;
+      dummy_left_ = 8;
+      break;
+    case kFastReadQuadIo:
+      phase_ = kMode;
+      break;
+    case kPageProgram:
+      phase_ = kDataIn;
+      break;
+    case kQuadPageProgram:
+      phase_    = kDataIn;
+      in_width_ = 4;
+      break;
+    default:
+      // erases, executed when CS# goes high
+      phase_   = kIgnore;
+      pending_ = true;
+      break;
+  }
+}
+
+void SpiFlash::byteIn(uint8_t b)
+{
+  switch(phase_) {
+    case kCmd:
+      command(b);
+      break;
+    case kAddr:
+      addr_ = (addr_ << 8) | b;
+      if(++addr_bytes_ == 3) {
+        addr_ &= kSize - 1;
+        addressDone();
+      }
+      break;
+    case kMode:
+      // M5-4 = 10 keeps the device in continuous read mode
+      continuous_read_ = (b & 0x30) == 0x20;
+      out_width_       = 4;
+      dummy_left_      = quad_dummy_;
+      phase_           = dummy_left_ > 0 ? kDummy : kDataOut;
+      break;
+    case kDataIn:
+      if(cmd_ == kPageProgram || cmd_ == kQuadPageProgram) {
+        page_[(addr_ + data_bytes_) & 0xff] = b;
+      } else {
+        // Write Status Register-1 may be followed by Status Register-2
+        unsigned int n = cmd_ == kWriteSr1 ? data_bytes_ : cmd_ == kWriteSr2 ? 1 : 2;
+        if(n < 3)
+          status_[n] = n == 0 ? (b & ~0x03) : b;
+      }
+      pending_ = true;
+      data_bytes_++;
+      break;
+    default:
+      break;
+  }
+}
+
+uint8_t SpiFlash::byteOut()
+{
+  uint8_t b = 0xff;
+  switch(source_) {
+    case kMem:
+      b     = mem_[addr_];
+      addr_ = (addr_ + 1) & (kSize - 1);
+      bytes_read_++;
+      break;
+    case kStatus:
+      b = statusRegister(cmd_ == kReadSr1 ? 0 : cmd_ == kReadSr2 ? 1 : 2);
+      break;
+    case kDeviceId:
+      b = kDevice;
+      break;
+    case kMfgId:
+      b = (addr_ & 0x1) ? kDevice : kManufacturer;
+      addr_ ^= 0x1;
+      break;
+    case kJedecId:
+      b = kJedec[data_bytes_++ % 3];
+      break;
+    case kUniqueId:
+      b = kUnique[data_bytes_++ % 8];
+      break;
+  }
+  return b;
+}
+
+void SpiFlash::erase(uint32_t addr, uint32_t len, uint64_t cycles)
+{
+  memset(mem_ + (addr & ~(len - 1)), 0xff, len);
+  busy_until_ = cycle_ + cycles;
+  wel_        = false;
+  erases_++;
+}
+
+uint8_t SpiFlash::statusRegister(unsigned int n) const
+{
+  if(n == 0)
+    return (status_[0] & ~0x03) | (wel_ ? 0x02 : 0x00) | (busy() ? 0x01 : 0x00);
+  return status_[n];
+}
+
+void SpiFlash::printStats() const
+{
+  if(commands_ == 0)
+    return;
+  std::cout<<"[FLASH]: "<<commands_<<" instructions, "<<bytes_read_<<" bytes read, "
+           <<bytes_programmed_<<" bytes programmed, "<<erases_<<" erases"<<std::endl;
+}
+
+extern "C" void spiflashdpi_tick(long long cycle, unsigned char csb, unsigned char sck,
+                                 const svBitVecVal *io_i, svBitVecVal *io_o, svBitVecVal *io_oe)
+{
+  uint8_t out, oe;
+  tb_spiflash.update(cycle, csb != 0, sck != 0, io_i[0] & 0xf, out, oe);
+  io_o[0]  = out;
+  io_oe[0] = oe;
+}
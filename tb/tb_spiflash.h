@@ -0,0 +1,115 @@
+// Copyright EPFL contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef TB_SPIFLASH_H_
+#define TB_SPIFLASH_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Behavioural model of the W25Q128JW SPI flash used for booting.
+//
+// The model is called by the spiflashdpi shim (tb/spiflashdpi.sv) once per
+// clock cycle and detects the edges of SCK and CS# itself. It implements the commands used by the boot ROM, by
+// spimemio and by sw/device/bsp/w25q: standard, fast and quad I/O reads
+// (including the continuous read mode of spimemio), standard and quad page
+// program, sector/block/chip erase, status registers and the ID commands.
+// The 16 MiB array is backed by an mmap'ed raw image file.
+class SpiFlash {
+ public:
+  static const size_t kSize = 16 * 1024 * 1024;
+
+  // Duration of the internal operations, in clock cycles of the MCU
+  struct Timing {
+    uint64_t page_program;
+    uint64_t sector_erase;
+    uint64_t block_erase;
+    uint64_t chip_erase;
+  };
+
+  SpiFlash();
+  ~SpiFlash();
+
+  // Maps the image file (a raw binary, e.g. sw/build/main.bin). The part of
+  // the array not covered by the file reads as erased. Programs and erases
+  // go back to the file only with writeback.
+  bool open(const std::string &file, bool writeback);
+
+  void setTiming(const Timing &timing) { timing_ = timing; }
+  // Dummy clocks of the Fast Read Quad I/O command (4 on the real device,
+  // 8 for the simulation models, see DUMMY_CLOCKS_SIM in w25q128jw.h)
+  void setQuadDummy(unsigned int clocks) { quad_dummy_ = clocks; }
+
+  // Called once per clock cycle with the bus lines, returns the data lines
+  // driven by the flash and their output enables
+  void update(uint64_t cycle, bool csb, bool sck, uint8_t io_in, uint8_t &io_out, uint8_t &io_oe);
+
+  void printStats() const;
+
+ private:
+  enum Phase { kCmd, kAddr, kMode, kDummy, kDataIn, kDataOut, kIgnore };
+  enum Source { kMem, kStatus, kDeviceId, kMfgId, kJedecId, kUniqueId };
+
+  void select(uint64_t cycle);
+  void deselect(uint64_t cycle);
+  void risingEdge(uint8_t io_in);
+  void fallingEdge();
+  void command(uint8_t cmd);
+  void addressDone();
+  void byteIn(uint8_t b);
+  uint8_t byteOut();
+  void erase(uint32_t addr, uint32_t len, uint64_t cycles);
+  uint8_t statusRegister(unsigned int n) const;
+  bool busy() const { return cycle_ < busy_until_; }
+
+  uint8_t *mem_;
+  size_t mapped_;
+  Timing timing_;
+  unsigned int quad_dummy_;
+
+  // Device state
+  uint64_t cycle_;
+  uint64_t busy_until_;
+  uint8_t status_[3];
+  bool wel_;
+  bool volatile_sr_we_;
+  bool powered_down_;
+  bool reset_enabled_;
+  bool continuous_read_;
+
+  // Transaction state
+  bool csb_;
+  bool sck_;
+  Phase phase_;
+  Source source_;
+  uint8_t cmd_;
+  unsigned int in_width_;
+  unsigned int out_width_;
+  uint8_t shift_in_;
+  unsigned int bits_in_;
+  uint8_t shift_out_;
+  unsigned int bits_out_;
+  unsigned int dummy_left_;
+  unsigned int addr_bytes_;
+  unsigned int data_bytes_;
+  uint32_t addr_;
+  bool pending_;
+  uint8_t io_out_;
+  uint8_t io_oe_;
+  std::vector<uint8_t> page_;
+  std::vector<bool> unsupported_;
+
+  // Statistics
+  uint64_t commands_;
+  uint64_t bytes_read_;
+  uint64_t bytes_programmed_;
+  uint64_t erases_;
+};
+
+// Flash instance driven by the spiflashdpi shim
+extern SpiFlash tb_spiflash;
+
+#endif  // TB_SPIFLASH_H_
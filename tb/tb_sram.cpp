@@ -0,0 +1,264 @@
+// Copyright EPFL contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "tb_sram.h"
+
+#include "verilated.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <iostream>
+#include <string>
+
+std::vector<SparseSram *> SparseSram::banks_;
+
+// Returns the bank index of a gen_sram[<i>] scope, or -1. Depending on the
+// Verilator version the index is printed as [i] or as __BRA__i__KET__.
+static int bankFromScope(const std::string &name)
+{
+  size_t pos = name.find("memory_subsystem_i.gen_sram");
+  if(pos == std::string::npos)
+    return -1;
+  pos += strlen("memory_subsystem_i.gen_sram");
+  if(name.compare(pos, 1, "[") == 0)
+    pos += 1;
+  else if(name.compare(pos, 7, "__BRA__") == 0)
+    pos += 7;
+  else
+    return -1;
+  return atoi(name.c_str() + pos);
+}
+
+SramBackdoor::SramBackdoor()
+    : ram_start_(0), mem_size_(0), bank_size_(0), num_banks_(0), num_banks_il_(0) {}
+
+bool SramBackdoor::init(uint32_t ram_start, uint32_t mem_size, unsigned int num_banks,
+                        unsigned int num_banks_il)
+{
+  ram_start_    = ram_start;
+  mem_size_     = mem_size;
+  num_banks_    = num_banks;
+  num_banks_il_ = num_banks_il;
+  bank_size_    = mem_size / num_banks;
+  banks_.assign(num_banks, (uint32_t *)NULL);
+
+  sparse_.assign(num_banks, (SparseSram *)NULL);
+
+#ifdef TB_SPARSE_SRAM
+  for(unsigned int i = 0; i < num_banks; i++)
+    sparse_[i] = SparseSram::bank(i, bank_size_ / 4);
+  return true;
+#endif
+
+  const VerilatedScopeNameMap *scopes = Verilated::scopeNameMap();
+  for(VerilatedScopeNameMap::const_iterator it = scopes->begin(); it != scopes->end(); ++it) {
+    int bank = bankFromScope(it->first);
+    if(bank < 0 || bank >= (int)num_banks || strstr(it->first, "tc_ram_i") == NULL)
+      continue;
+    VerilatedVar *var = it->second->varFind("sram");
+    if(var != NULL)
+      banks_[bank] = (uint32_t *)var->datap();
+  }
+
+  for(unsigned int i = 0; i < num_banks; i++) {
+    if(banks_[i] == NULL) {
+      std::cout<<"[SRAM]: ERROR: memory bank "<<i<<" is not accessible from C++"<<std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+bool SramBackdoor::locate(uint32_t addr, unsigned int &bank, uint32_t &word) const
+{
+  uint32_t offset = addr - ram_start_;
+  uint32_t cont_size = (num_banks_ - num_banks_il_) * bank_size_;
+
+  if(addr < ram_start_ || offset >= mem_size_)
+    return false;
+
+  if(offset < cont_size) {
+    bank = offset / bank_size_;
+    word = (offset % bank_size_) / 4;
+  } else {
+    // Interleaved banks: consecutive words go to consecutive banks
+    offset -= cont_size;
+    bank = (num_banks_ - num_banks_il_) + (offset / 4) % num_banks_il_;
+    word = offset / (4 * num_banks_il_);
+  }
+  return true;
+}
+
+bool SramBackdoor::write(uint32_t addr, const uint8_t *data, size_t len)
+{
+  unsigned int bank;
+  uint32_t word;
+
+  if(len == 0)
+    return true;
+  if(addr < ram_start_ || (uint64_t)addr - ram_start_ + len > mem_size_)
+    return false;
+
+  while(len > 0) {
+    locate(addr, bank, word);
+    if((addr & 3) == 0 && len >= 4) {
+      store(bank, word, (uint32_t)data[0] | ((uint32_t)data[1] << 8) |
+                        ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24));
+      addr += 4;
+      data += 4;
+      len  -= 4;
+    } else {
+      unsigned int shift = (addr & 3) * 8;
+      store(bank, word, (load(bank, word) & ~(0xffu << shift)) | ((uint32_t)data[0] << shift));
+      addr += 1;
+      data += 1;
+      len  -= 1;
+    }
+  }
+  return true;
+}
+
+bool SramBackdoor::read(uint32_t addr, uint8_t *data, size_t len) const
+{
+  unsigned int bank;
+  uint32_t word;
+
+  if(addr < ram_start_ || (uint64_t)addr - ram_start_ + len > mem_size_)
+    return false;
+
+  for(size_t i = 0; i < len; i++, addr++) {
+    locate(addr, bank, word);
+    data[i] = load(bank, word) >> ((addr & 3) * 8);
+  }
+  return true;
+}
+
+SparseSram::SparseSram(uint32_t num_words)
+    : num_words_(num_words), pages_((num_words + kPageWords - 1) / kPageWords, (uint32_t *)NULL),
+      reads_(0), writes_(0) {}
+
+SparseSram::~SparseSram()
+{
+  for(size_t i = 0; i < pages_.size(); i++)
+    delete[] pages_[i];
+}
+
+SparseSram *SparseSram::bank(unsigned int i, uint32_t num_words)
+{
+  if(i >= banks_.size())
+    banks_.resize(i + 1, (SparseSram *)NULL);
+  if(banks_[i] == NULL)
+    banks_[i] = new SparseSram(num_words);
+  return banks_[i];
+}
+
+void SparseSram::write(uint32_t word, uint32_t value, uint32_t be)
+{
+  uint32_t mask = 0;
+
+  if(word >= num_words_)
+    return;
+  uint32_t *&page = pages_[word / kPageWords];
+  if(page == NULL) {
+    page = new uint32_t[kPageWords];
+    memset(page, 0, kPageWords * 4);
+  }
+  for(unsigned int i = 0; i < 4; i++)
+    if(be & (1u << i))
+      mask |= 0xffu << (8 * i);
+  page[word % kPageWords] = (page[word % kPageWords] & ~mask) | (value & mask);
+}
+
+size_t SparseSram::allocatedPages() const
+{
+  size_t n = 0;
+  for(size_t i = 0; i < pages_.size(); i++)
+    n += pages_[i] != NULL;
+  return n;
+}
+
+void SparseSram::printStats()
+{
+  for(size_t i = 0; i < banks_.size(); i++) {
+    if(banks_[i] == NULL)
+      continue;
+    std::cout<<"[SRAM]: bank "<<i<<": "<<banks_[i]->reads()<<" reads, "<<banks_[i]->writes()<<" writes, "
+             <<banks_[i]->allocatedPages() * kPageWords * 4 / 1024<<" of "<<banks_[i]->numWords() * 4 / 1024
+             <<" KiB allocated"<<std::endl;
+  }
+}
+
+#ifdef TB_SAVABLE
+void SparseSram::saveAll(VerilatedSerialize &os)
+{
+  uint32_t num_banks = banks_.size();
+
+  os << num_banks;
+  for(size_t i = 0; i < banks_.size(); i++) {
+    SparseSram *mem = banks_[i];
+    uint32_t num_words = mem != NULL ? mem->num_words_ : 0;
+    os << num_words;
+    if(mem == NULL)
+      continue;
+    os << mem->reads_ << mem->writes_;
+    for(size_t p = 0; p < mem->pages_.size(); p++) {
+      bool allocated = mem->pages_[p] != NULL;
+      os << allocated;
+      if(allocated)
+        os.write(mem->pages_[p], kPageWords * 4);
+    }
+  }
+}
+
+void SparseSram::restoreAll(VerilatedDeserialize &os)
+{
+  uint32_t num_banks, num_words;
+
+  os >> num_banks;
+  for(unsigned int i = 0; i < num_banks; i++) {
+    os >> num_words;
+    if(num_words == 0)
+      continue;
+    SparseSram *mem = bank(i, num_words);
+    os >> mem->reads_ >> mem->writes_;
+    for(size_t p = 0; p < mem->pages_.size(); p++) {
+      bool allocated;
+      os >> allocated;
+      if(!allocated) {
+        delete[] mem->pages_[p];
+        mem->pages_[p] = NULL;
+        continue;
+      }
+      if(mem->pages_[p] == NULL)
+        mem->pages_[p] = new uint32_t[kPageWords];
+      os.read(mem->pages_[p], kPageWords * 4);
+    }
+  }
+}
+#endif
+
+extern "C" void *tb_sparse_sram_create(const char *scope, int num_words)
+{
+  int bank = bankFromScope(scope);
+
+  //an sram_wrapper outside of memory_subsystem gets a private store
+  if(bank < 0)
+    return new SparseSram(num_words);
+  return SparseSram::bank(bank, num_words);
+}
+
+extern "C" int tb_sparse_sram_read(void *mem, int addr)
+{
+  return ((SparseSram *)mem)->busRead(addr);
+}
+
+extern "C" void tb_sparse_sram_write(void *mem, int addr, int wdata, int be)
+{
+  ((SparseSram *)mem)->busWrite(addr, wdata, be);
+}
+
+extern "C" void tb_sparse_sram_load(void *mem, int addr, int data)
+{
+  ((SparseSram *)mem)->write(addr, data, 0xf);
+}
@@ -0,0 +1,128 @@
+// Copyright EPFL contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef TB_SRAM_H_
+#define TB_SRAM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#ifdef TB_SAVABLE
+#include "verilated_save.h"
+#endif
+
+// Byte access to a simulated memory, used by the host calls
+class MemoryPort {
+ public:
+  virtual ~MemoryPort() {}
+
+  // Copies len bytes to the memory, false if the range is not in the memory
+  virtual bool write(uint32_t addr, const uint8_t *data, size_t len) = 0;
+  // Copies len bytes from the memory, false if the range is not in the memory
+  virtual bool read(uint32_t addr, uint8_t *data, size_t len) const = 0;
+};
+
+// Memory bank of hw/simulation/sram_wrapper_sparse.sv: the words are kept
+// in 4 KiB pages allocated on the first write, the words never written read
+// as 0. The banks of memory_subsystem are registered by index, see bank().
+class SparseSram {
+ public:
+  static const uint32_t kPageWords = 1024;
+
+  explicit SparseSram(uint32_t num_words);
+  ~SparseSram();
+
+  // Bank i of memory_subsystem, created on the first call
+  static SparseSram *bank(unsigned int i, uint32_t num_words);
+  static unsigned int numBanks() { return banks_.size(); }
+  // Accesses and allocated pages of every bank
+  static void printStats();
+
+  uint32_t read(uint32_t word) const {
+    const uint32_t *page = word < num_words_ ? pages_[word / kPageWords] : NULL;
+    return page != NULL ? page[word % kPageWords] : 0;
+  }
+  void write(uint32_t word, uint32_t value, uint32_t be);
+
+  // Accesses of the bus, counted
+  uint32_t busRead(uint32_t word) {
+    reads_++;
+    return read(word);
+  }
+  void busWrite(uint32_t word, uint32_t value, uint32_t be) {
+    writes_++;
+    write(word, value, be);
+  }
+
+  uint32_t numWords() const { return num_words_; }
+  size_t allocatedPages() const;
+  uint64_t reads() const { return reads_; }
+  uint64_t writes() const { return writes_; }
+
+#ifdef TB_SAVABLE
+  // The pages are not part of the Verilated model, tb_sim.cpp saves them
+  // after it
+  static void saveAll(VerilatedSerialize &os);
+  static void restoreAll(VerilatedDeserialize &os);
+#endif
+
+ private:
+  SparseSram(const SparseSram &);
+  SparseSram &operator=(const SparseSram &);
+
+  uint32_t num_words_;
+  std::vector<uint32_t *> pages_;
+  uint64_t reads_;
+  uint64_t writes_;
+
+  static std::vector<SparseSram *> banks_;
+};
+
+// Backdoor access to the memory banks of the Verilated model.
+//
+// The bank arrays are made public in tb.vlt and located through the
+// Verilator scope table, so that whole segments are copied straight into
+// the model with no SystemVerilog task call per word. With the sparse SRAM
+// (TB_SPARSE_SRAM) the banks are the SparseSram page stores instead. The
+// bank layout (contiguous banks followed by the interleaved ones) matches
+// memory_subsystem.sv and system_xbar.sv.
+class SramBackdoor : public MemoryPort {
+ public:
+  SramBackdoor();
+
+  // Looks up the bank arrays, must be called after the model is built
+  bool init(uint32_t ram_start, uint32_t mem_size, unsigned int num_banks,
+            unsigned int num_banks_il);
+
+  // Copies len bytes to the SRAM, false if the range is not in the SRAM
+  bool write(uint32_t addr, const uint8_t *data, size_t len);
+  // Copies len bytes from the SRAM, false if the range is not in the SRAM
+  bool read(uint32_t addr, uint8_t *data, size_t len) const;
+
+  uint32_t ramStart() const { return ram_start_; }
+  uint32_t memSize() const { return mem_size_; }
+
+ private:
+  bool locate(uint32_t addr, unsigned int &bank, uint32_t &word) const;
+  uint32_t load(unsigned int bank, uint32_t word) const {
+    return banks_[bank] != NULL ? banks_[bank][word] : sparse_[bank]->read(word);
+  }
+  void store(unsigned int bank, uint32_t word, uint32_t value) {
+    if(banks_[bank] != NULL)
+      banks_[bank][word] = value;
+    else
+      sparse_[bank]->write(word, value, 0xf);
+  }
+
+  uint32_t ram_start_;
+  uint32_t mem_size_;
+  uint32_t bank_size_;
+  unsigned int num_banks_;
+  unsigned int num_banks_il_;
+  std::vector<uint32_t *> banks_;
+  std::vector<SparseSram *> sparse_;
+};
+
+#endif  // TB_SRAM_H_
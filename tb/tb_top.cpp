@@ -2,16 +2,28 @@
 // Solderpad Hardware License, Version 2.1, see LICENSE.md for details.
 // SPDX-License-Identifier: Apache-2.0 WITH SHL-2.1
 
-#include "verilated.h"
-#include "verilated_fst_c.h"
-#include "Vtestharness.h"
-#include "Vtestharness__Syms.h"
+#include "tb_audio.h"
+#include "tb_busmon.h"
+#include "tb_gdbserver.h"
+#include "tb_hostcall.h"
+#include "tb_lockstep.h"
+#include "tb_memdump.h"
+#include "tb_profiler.h"
+#include "tb_sim.h"
+#include "tb_slowmem.h"
+#include "tb_spiflash.h"
 
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
 #include <iostream>
-
-
-vluint64_t sim_time = 0;
+#include <sstream>
 
 
 std::string getCmdOption(int argc, char* argv[], const std::string& option)
@@ -30,34 +42,228 @@ std::string getCmdOption(int argc, char* argv[], const std::string& option)
      return cmd;
 }
 
-void runCycles(unsigned int ncycles, Vtestharness *dut, VerilatedFstC *m_trace){
-  for(unsigned int i = 0; i < ncycles; i++) {
-    dut->clk_i ^= 1;
-    dut->eval();
-    m_trace->dump(sim_time);
-    sim_time++;
+// Performance counters of the run as JSON fields, see tb_getPerf in tb_util.svh
+std::string perfJson(Vtestharness *dut){
+  long long mcycle, minstret, dma_busy, reads, writes;
+  int mem_size, num_banks;
+  std::ostringstream json, json_writes;
+
+  dut->tb_getPerf(&mcycle, &minstret, &dma_busy);
+  dut->tb_getMemSize(&mem_size, &num_banks);
+
+  json<<"\"mcycle\": "<<mcycle<<", \"minstret\": "<<minstret<<", \"dma_busy_cycles\": "<<dma_busy
+      <<", \"sram_reads\": [";
+  for(int k = 0; k < num_banks; k++) {
+    dut->tb_getSramAccesses(k, &reads, &writes);
+    json<<(k == 0 ? "" : ", ")<<reads;
+    json_writes<<(k == 0 ? "" : ", ")<<writes;
+  }
+  json<<"], \"sram_writes\": ["<<json_writes.str()<<"]";
+  return json.str();
+}
+
+bool isElfFile(const std::string &file){
+  return file.size() > 4 && file.compare(file.size() - 4, 4, ".elf") == 0;
+}
+
+std::string jsonEscape(const std::string &str){
+  std::string out;
+  for(size_t i = 0; i < str.size(); i++) {
+    if(str[i] == '"' || str[i] == '\\')
+      out += '\\';
+    out += str[i];
+  }
+  return out;
+}
+
+// Reads the firmware list of the batch mode: one hex or ELF file per line,
+// empty lines and lines starting with '#' are skipped
+bool readFirmwareList(const std::string &file, std::vector<std::string> &images){
+  std::ifstream f(file.c_str());
+  std::string line;
+  if(!f)
+    return false;
+  while(std::getline(f, line)) {
+    size_t first = line.find_first_not_of(" \t\r");
+    if(first == std::string::npos || line[first] == '#')
+      continue;
+    size_t last = line.find_last_not_of(" \t\r");
+    images.push_back(line.substr(first, last - first + 1));
+  }
+  return true;
+}
+
+// Runs the images assigned to this worker (every jobs-th image starting from
+// worker) and appends one JSON line per image to the report.
+// Returns the number of failing images.
+int runBatch(XHeepSim &sim, const std::vector<std::string> &images, vluint64_t max_cycles,
+             int report_fd, unsigned int worker, unsigned int jobs){
+  Vtestharness *dut = sim.dut();
+  int failures = 0;
+
+  for(size_t i = worker; i < images.size(); i += jobs) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::string status;
+    std::ostringstream uart_log, line;
+    bool loaded = true;
+    vluint64_t cycles, ff_start = sim.ffSkippedCycles();
+
+    sim.reset();
+    uart_log<<"uart0_"<<i<<".log";
+    dut->tb_uart_reopen(uart_log.str().c_str());
+    tb_hostcall.restartStreams("." + std::to_string(i));
+
+    if(isElfFile(images[i]))
+      loaded = sim.loadElf(images[i]);
+    else
+      sim.loadHex(images[i]);
+
+    vluint64_t run_start = sim.time();
+    dut->tb_perf_reset();
+    if(!loaded) {
+      status = "load_error";
+    } else {
+      sim.startFirmware();
+      if(!sim.runUntilExit(max_cycles))
+        status = "timeout";
+      else
+        status = dut->exit_value_o == 0 ? "pass" : "fail";
+    }
+    cycles = (sim.time() - run_start) / 2;
+
+    double wall_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if(status != "pass")
+      failures++;
+
+    line<<"{\"image\": "<<i
+        <<", \"firmware\": \""<<jsonEscape(images[i])<<"\""
+        <<", \"status\": \""<<status<<"\""
+        <<", \"exit_valid\": "<<(dut->exit_valid_o == 1 ? "true" : "false")
+        <<", \"exit_value\": "<<dut->exit_value_o
+        <<", \"cycles\": "<<cycles
+        <<", \"fast_forward_cycles\": "<<sim.ffSkippedCycles() - ff_start
+        <<", "<<perfJson(dut)
+        <<", \"wall_time_s\": "<<wall_time
+        <<", \"uart_log\": \""<<uart_log.str()<<"\"}\n";
+    //a single write per line keeps the report consistent across workers
+    if(write(report_fd, line.str().c_str(), line.str().size()) < 0)
+      std::cout<<"[TESTBENCH]: ERROR: cannot write the batch report"<<std::endl;
+
+    std::cout<<"[TESTBENCH]: "<<images[i]<<": "<<status<<" ("<<cycles<<" cycles)"<<std::endl;
+  }
+  return failures;
+}
+
+// Spreads the batch over jobs forked copies of the already built model
+int runBatchPool(XHeepSim &sim, const std::vector<std::string> &images, vluint64_t max_cycles,
+                 int report_fd, unsigned int jobs){
+  std::vector<pid_t> workers;
+  int failures = 0;
+
+  if(jobs <= 1)
+    return runBatch(sim, images, max_cycles, report_fd, 0, 1);
+
+#ifdef TB_THREADED
+  //the worker threads of the model do not survive a fork
+  std::cout<<"[TESTBENCH]: ERROR: +jobs needs a single-threaded model"<<std::endl;
+  return images.size();
+#endif
+
+  fflush(stdout);
+  for(unsigned int k = 0; k < jobs; k++) {
+    pid_t pid = fork();
+    if(pid == 0) {
+      int worker_failures = runBatch(sim, images, max_cycles, report_fd, k, jobs);
+      sim.dut()->final();
+      fflush(stdout);
+      _exit(worker_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+    } else if(pid < 0) {
+      std::cout<<"[TESTBENCH]: ERROR: cannot fork batch worker "<<k<<std::endl;
+      failures++;
+    } else {
+      workers.push_back(pid);
+    }
+  }
+
+  for(size_t k = 0; k < workers.size(); k++) {
+    int status;
+    if(waitpid(workers[k], &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS)
+      failures++;
   }
+  return failures;
 }
 
 int main (int argc, char * argv[])
 {
 
   unsigned int SRAM_SIZE;
-  std::string firmware, arg_max_sim_time, arg_openocd, arg_boot_sel, arg_execute_from_flash;
+  std::string firmware, elf, arg_max_sim_time, arg_openocd, arg_boot_sel, arg_execute_from_flash;
+  std::string arg_trace, arg_trace_start, arg_trace_stop, arg_trace_depth;
+  std::string save_checkpoint, restore_checkpoint;
+  std::string firmware_list, arg_max_cycles, arg_jobs, batch_report;
+  std::string arg_wfi_fast_forward, arg_ff_min_cycles, perf_report;
+  std::string arg_profile, profile_elf, profile_out;
+  std::string arg_bus_monitor, bus_report;
+  std::string arg_lockstep;
+  std::string arg_gdb_port;
+  std::string flash_image, arg_flash_timing, arg_flash_dummy;
+  std::string host_in, host_out;
+  std::string arg_seed, slowmem_latency;
+  std::string dump_mem, golden;
+  std::string pdm_file, arg_pdm_ratio, pdm_capture, i2s_file, arg_i2s_bits, i2s_capture;
+  std::vector<std::string> images;
+  MemDump mem_dump;
+  vluint64_t max_cycles = 0;
+  unsigned int jobs = 1;
   unsigned int max_sim_time;
   bool use_openocd;
+  int gdb_port = 0;
+  bool use_trace;
   bool run_all = false;
-  int i,j, exit_val, boot_sel, execute_from_flash;
+  vluint64_t trace_start = 0, trace_stop = 0, ff_min_cycles = 100;
+  int i,j, exit_val, boot_sel, execute_from_flash, trace_depth;
   Verilated::commandArgs(argc, argv);
 
-  // Instantiate the model
-  Vtestharness *dut = new Vtestharness;
+  firmware_list = getCmdOption(argc, argv, "+firmware_list=");
+
+  arg_trace = getCmdOption(argc, argv, "+trace=");
+  use_trace = true;
+  if(!firmware_list.empty()) {
+    std::cout<<"[TESTBENCH]: Waveform tracing is disabled in batch mode"<<std::endl;
+    use_trace = false;
+  } else if(arg_trace.empty() || arg_trace.compare("fst") == 0) {
+    std::cout<<"[TESTBENCH]: Waveform tracing enabled (fst)"<<std::endl;
+  } else if(arg_trace.compare("none") == 0) {
+    std::cout<<"[TESTBENCH]: Waveform tracing disabled"<<std::endl;
+    use_trace = false;
+  } else {
+    std::cout<<"[TESTBENCH]: ERROR: Wrong trace option specified (none, fst)"<<std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  arg_trace_start = getCmdOption(argc, argv, "+trace_start=");
+  if(!arg_trace_start.empty()) {
+    trace_start = stoull(arg_trace_start);
+    std::cout<<"[TESTBENCH]: Tracing from cycle "<<trace_start<<std::endl;
+  }
+
+  arg_trace_stop = getCmdOption(argc, argv, "+trace_stop=");
+  if(!arg_trace_stop.empty()) {
+    trace_stop = stoull(arg_trace_stop);
+    std::cout<<"[TESTBENCH]: Tracing until cycle "<<trace_stop<<std::endl;
+  }
+
+  arg_trace_depth = getCmdOption(argc, argv, "+trace_depth=");
+  trace_depth     = 99;
+  if(!arg_trace_depth.empty()) {
+    trace_depth = stoi(arg_trace_depth);
+    std::cout<<"[TESTBENCH]: Trace depth is "<<trace_depth<<std::endl;
+  }
 
-  // Open VCD
-  Verilated::traceEverOn (true);
-  VerilatedFstC *m_trace = new VerilatedFstC;
-  dut->trace (m_trace, 99);
-  m_trace->open ("waveform.vcd");
+  // Instantiate the model, with the VCD when tracing
+  XHeepSim *sim = new XHeepSim(use_trace ? "waveform.vcd" : "", trace_depth);
+  Vtestharness *dut = sim->dut();
+  sim->setTraceWindow(trace_start, trace_stop);
 
   arg_openocd = getCmdOption(argc, argv, "+openOCD=");
   use_openocd = false;
@@ -68,23 +274,86 @@ int main (int argc, char * argv[])
     use_openocd = true;
   }
 
-  firmware = getCmdOption(argc, argv, "+firmware=");
-  if(firmware.empty()){
-    std::cout<<"[TESTBENCH]: No firmware  specified"<<std::endl;
-    if(use_openocd==false)
-      exit(EXIT_FAILURE);
-  } else {
-    std::cout<<"[TESTBENCH]: loading firmware  "<<firmware<<std::endl;
+  //built-in GDB server on the JTAG pins, see tb_gdbserver.h
+  arg_gdb_port = getCmdOption(argc, argv, "+gdb_port=");
+  if(!arg_gdb_port.empty()) {
+    gdb_port = stoi(arg_gdb_port);
+    if(use_openocd || !firmware_list.empty()) {
+      std::cout<<"[TESTBENCH]: ERROR: The GDB server is not supported with OpenOCD nor in batch mode"<<std::endl;
+      std::cout<<"exit simulation..."<<std::endl;
+      return -1;
+    }
+    std::cout<<"[TESTBENCH]: GDB server on port "<<gdb_port<<std::endl;
   }
 
-  arg_max_sim_time = getCmdOption(argc, argv, "+max_sim_time=");
-  max_sim_time     = 0;
-  if(arg_max_sim_time.empty()){
-    std::cout<<"[TESTBENCH]: No Max time specified"<<std::endl;
-    run_all = true;
-  } else {
-    max_sim_time = stoi(arg_max_sim_time);
-    std::cout<<"[TESTBENCH]: Max Times is  "<<max_sim_time<<std::endl;
+  arg_wfi_fast_forward = getCmdOption(argc, argv, "+wfi_fast_forward=");
+  if(arg_wfi_fast_forward.compare("1") == 0) {
+#ifdef TB_HIER
+    std::cout<<"[TESTBENCH]: ERROR: WFI fast-forward needs the timers of peripheral_subsystem, out of reach in a model built with FUSESOC_FLAGS=\"--flag=verilator_hier\""<<std::endl;
+    std::cout<<"exit simulation..."<<std::endl;
+    return -1;
+#endif
+    if(use_openocd || gdb_port != 0) {
+      std::cout<<"[TESTBENCH]: ERROR: WFI fast-forward is not supported with OpenOCD nor GDB"<<std::endl;
+      std::cout<<"exit simulation..."<<std::endl;
+      return -1;
+    }
+    arg_ff_min_cycles = getCmdOption(argc, argv, "+wfi_fast_forward_min=");
+    if(!arg_ff_min_cycles.empty())
+      ff_min_cycles = stoull(arg_ff_min_cycles);
+    sim->setFastForward(true, ff_min_cycles);
+    std::cout<<"[TESTBENCH]: WFI fast-forward enabled for idle periods of at least "<<ff_min_cycles<<" cycles"<<std::endl;
+  }
+
+  save_checkpoint    = getCmdOption(argc, argv, "+save_checkpoint=");
+  restore_checkpoint = getCmdOption(argc, argv, "+restore_checkpoint=");
+  if(!save_checkpoint.empty() || !restore_checkpoint.empty()) {
+#ifndef TB_SAVABLE
+    std::cout<<"[TESTBENCH]: ERROR: Checkpoints need a model built with FUSESOC_FLAGS=\"--flag=verilator_savable\""<<std::endl;
+    std::cout<<"exit simulation..."<<std::endl;
+    return -1;
+#endif
+    if(!save_checkpoint.empty() && !restore_checkpoint.empty()) {
+      std::cout<<"[TESTBENCH]: ERROR: +save_checkpoint and +restore_checkpoint are mutually exclusive"<<std::endl;
+      std::cout<<"exit simulation..."<<std::endl;
+      return -1;
+    }
+    if(use_openocd) {
+      std::cout<<"[TESTBENCH]: ERROR: Checkpoints are not supported with OpenOCD"<<std::endl;
+      std::cout<<"exit simulation..."<<std::endl;
+      return -1;
+    }
+  }
+
+  if(!firmware_list.empty()) {
+    if(!save_checkpoint.empty() || !restore_checkpoint.empty() || use_openocd) {
+      std::cout<<"[TESTBENCH]: ERROR: The batch mode does not support checkpoints nor OpenOCD"<<std::endl;
+      std::cout<<"exit simulation..."<<std::endl;
+      return -1;
+    }
+    if(!readFirmwareList(firmware_list, images)) {
+      std::cout<<"[TESTBENCH]: ERROR: cannot read the firmware list "<<firmware_list<<std::endl;
+      std::cout<<"exit simulation..."<<std::endl;
+      return -1;
+    }
+    std::cout<<"[TESTBENCH]: Batch of "<<images.size()<<" firmware images from "<<firmware_list<<std::endl;
+
+    arg_max_cycles = getCmdOption(argc, argv, "+max_cycles=");
+    if(!arg_max_cycles.empty()) {
+      max_cycles = stoull(arg_max_cycles);
+      std::cout<<"[TESTBENCH]: Max cycles per image is "<<max_cycles<<std::endl;
+    }
+
+    arg_jobs = getCmdOption(argc, argv, "+jobs=");
+    if(!arg_jobs.empty()) {
+      jobs = stoi(arg_jobs);
+      std::cout<<"[TESTBENCH]: Running the batch on "<<jobs<<" processes"<<std::endl;
+    }
+
+    batch_report = getCmdOption(argc, argv, "+batch_report=");
+    if(batch_report.empty())
+      batch_report = "batch_report.jsonl";
+    std::cout<<"[TESTBENCH]: Writing the batch report to "<<batch_report<<std::endl;
   }
 
   arg_boot_sel = getCmdOption(argc, argv, "+boot_sel=");
@@ -105,73 +374,333 @@ int main (int argc, char * argv[])
     }
   }
 
-  arg_boot_sel = getCmdOption(argc, argv, "+execute_from_flash=");
-  execute_from_flash = 1;
+  arg_execute_from_flash = getCmdOption(argc, argv, "+execute_from_flash=");
+  execute_from_flash     = 1;
+  if(arg_execute_from_flash.compare("0") == 0)
+    execute_from_flash = 0;
 
   if(boot_sel == 1) {
-    std::cout<<"[TESTBENCH]: ERROR: Executing from SPI is not supported (yet) in Verilator"<<std::endl;
+    if(!firmware_list.empty() || !save_checkpoint.empty() || !restore_checkpoint.empty()) {
+      std::cout<<"[TESTBENCH]: ERROR: Booting from flash is not supported in batch mode nor with checkpoints"<<std::endl;
+      std::cout<<"exit simulation..."<<std::endl;
+      return -1;
+    }
+    std::cout<<"[TESTBENCH]: "<<(execute_from_flash ? "Executing from flash" : "Copying the firmware from flash")<<std::endl;
+  }
+
+  //boot flash model, see tb_spiflash.h
+  flash_image = getCmdOption(argc, argv, "+flash_image=");
+  if(!flash_image.empty()) {
+    if(!tb_spiflash.open(flash_image, getCmdOption(argc, argv, "+flash_writeback=").compare("1") == 0)) {
+      std::cout<<"exit simulation..."<<std::endl;
+      return -1;
+    }
+  } else if(boot_sel == 1) {
+    std::cout<<"[TESTBENCH]: ERROR: Booting from flash needs +flash_image=<binary>"<<std::endl;
     std::cout<<"exit simulation..."<<std::endl;
     return -1;
   }
 
-  svSetScope(svGetScopeFromName("TOP.testharness"));
-  svScope scope = svGetScope();
-  if (!scope) {
-    std::cout<<"Warning: svGetScope failed"<< std::endl;
-    exit(EXIT_FAILURE);
+  arg_flash_timing = getCmdOption(argc, argv, "+flash_timing=");
+  if(!arg_flash_timing.empty()) {
+    SpiFlash::Timing timing;
+    if(sscanf(arg_flash_timing.c_str(), "%" SCNu64 ",%" SCNu64 ",%" SCNu64 ",%" SCNu64,
+              &timing.page_program, &timing.sector_erase, &timing.block_erase, &timing.chip_erase) != 4) {
+      std::cout<<"[TESTBENCH]: ERROR: +flash_timing expects page_program,sector_erase,block_erase,chip_erase in cycles"<<std::endl;
+      std::cout<<"exit simulation..."<<std::endl;
+      return -1;
+    }
+    tb_spiflash.setTiming(timing);
+  }
+
+  arg_flash_dummy = getCmdOption(argc, argv, "+flash_dummy=");
+  if(!arg_flash_dummy.empty())
+    tb_spiflash.setQuadDummy(stoi(arg_flash_dummy));
+
+  //grants and latencies of the external slow_memory, see tb_slowmem.h
+  arg_seed        = getCmdOption(argc, argv, "+seed=");
+  slowmem_latency = getCmdOption(argc, argv, "+slowmem_latency=");
+  if(!arg_seed.empty())
+    tb_slowmem.setSeed(stoul(arg_seed));
+  if(!slowmem_latency.empty()) {
+    if(!tb_slowmem.configure(slowmem_latency)) {
+      std::cout<<"exit simulation..."<<std::endl;
+      return -1;
+    }
+    std::cout<<"[TESTBENCH]: Slow memory latency "<<slowmem_latency<<(arg_seed.empty() ? "" : ", seed " + arg_seed)<<std::endl;
+  }
+
+  //microphone models, see tb_audio.h
+  pdm_file      = getCmdOption(argc, argv, "+pdm_file=");
+  arg_pdm_ratio = getCmdOption(argc, argv, "+pdm_ratio=");
+  pdm_capture   = getCmdOption(argc, argv, "+pdm_capture=");
+  i2s_file      = getCmdOption(argc, argv, "+i2s_file=");
+  arg_i2s_bits  = getCmdOption(argc, argv, "+i2s_bits=");
+  i2s_capture   = getCmdOption(argc, argv, "+i2s_capture=");
+  if((!arg_pdm_ratio.empty() && stoi(arg_pdm_ratio) <= 0) || (!arg_i2s_bits.empty() && (stoi(arg_i2s_bits) <= 0 || stoi(arg_i2s_bits) > 32))) {
+    std::cout<<"[TESTBENCH]: ERROR: +pdm_ratio must be positive and +i2s_bits between 1 and 32"<<std::endl;
+    std::cout<<"exit simulation..."<<std::endl;
+    return -1;
+  }
+  if(!arg_pdm_ratio.empty())
+    tb_pdm_mic.setRatio(stoi(arg_pdm_ratio));
+  if(!arg_i2s_bits.empty())
+    tb_i2s_mic.setBits(stoi(arg_i2s_bits));
+  if((!pdm_file.empty() && !tb_pdm_mic.open(pdm_file)) || (!pdm_capture.empty() && !tb_pdm_mic.setCapture(pdm_capture)) ||
+     (!i2s_file.empty() && !tb_i2s_mic.open(i2s_file)) || (!i2s_capture.empty() && !tb_i2s_mic.setCapture(i2s_capture))) {
+    std::cout<<"exit simulation..."<<std::endl;
+    return -1;
+  }
+
+  firmware = getCmdOption(argc, argv, "+firmware=");
+  elf      = getCmdOption(argc, argv, "+elf=");
+  if(!firmware_list.empty()){
+    // images come from the firmware list
+  } else if(!elf.empty()){
+    std::cout<<"[TESTBENCH]: loading ELF firmware  "<<elf<<std::endl;
+  } else if(firmware.empty()){
+    std::cout<<"[TESTBENCH]: No firmware  specified"<<std::endl;
+    if(use_openocd==false && gdb_port == 0 && boot_sel == 0 && save_checkpoint.empty())
+      exit(EXIT_FAILURE);
+  } else {
+    std::cout<<"[TESTBENCH]: loading firmware  "<<firmware<<std::endl;
+  }
+
+  //data streams of host_read and host_write (sw/device/lib/runtime/host_call.h),
+  //each image of a batch reads the input from its start
+  host_in  = getCmdOption(argc, argv, "+host_in=");
+  host_out = getCmdOption(argc, argv, "+host_out=");
+  HostCall::setStreams(host_in, host_out);
+  if(!host_in.empty())
+    std::cout<<"[TESTBENCH]: Host input stream "<<host_in<<std::endl;
+  if(!host_out.empty())
+    std::cout<<"[TESTBENCH]: Host output stream "<<host_out<<(firmware_list.empty() ? "" : ".<image>")<<std::endl;
+
+  //SRAM regions written at exit, see tb_memdump.h
+  dump_mem = getCmdOption(argc, argv, "+dump_mem=");
+  golden   = getCmdOption(argc, argv, "+golden=");
+  if(!dump_mem.empty() || !golden.empty()) {
+    if(dump_mem.empty() || !firmware_list.empty()) {
+      std::cout<<"[TESTBENCH]: ERROR: +golden needs +dump_mem=, and neither is supported in batch mode"<<std::endl;
+      std::cout<<"exit simulation..."<<std::endl;
+      return -1;
+    }
+    if(!mem_dump.parse(dump_mem) || !mem_dump.setGolden(golden)) {
+      std::cout<<"exit simulation..."<<std::endl;
+      return -1;
+    }
+  }
+
+  perf_report = getCmdOption(argc, argv, "+perf_report=");
+  if(!perf_report.empty())
+    std::cout<<"[TESTBENCH]: Writing the performance report to "<<perf_report<<std::endl;
+
+  //PC-sampling profiler, the symbols come from the ELF of the firmware
+  arg_profile = getCmdOption(argc, argv, "+profile=");
+  if(!arg_profile.empty() && stoi(arg_profile) > 0) {
+#ifdef TB_HIER
+    std::cout<<"[TESTBENCH]: ERROR: Profiling needs the CPU internals, out of reach in a model built with FUSESOC_FLAGS=\"--flag=verilator_hier\""<<std::endl;
+    std::cout<<"exit simulation..."<<std::endl;
+    return -1;
+#endif
+    profile_elf = getCmdOption(argc, argv, "+profile_elf=");
+    if(profile_elf.empty())
+      profile_elf = elf;
+    profile_out = getCmdOption(argc, argv, "+profile_out=");
+    if(profile_out.empty())
+      profile_out = "gmon.out";
+    if(!firmware_list.empty() || profile_elf.empty()) {
+      std::cout<<"[TESTBENCH]: ERROR: Profiling needs +elf= or +profile_elf= and is not supported in batch mode"<<std::endl;
+      std::cout<<"exit simulation..."<<std::endl;
+      return -1;
+    }
+    if(!tb_profiler.init(profile_elf, stoi(arg_profile))) {
+      std::cout<<"exit simulation..."<<std::endl;
+      return -1;
+    }
+  }
+
+  //OBI bus monitor, +bus_report= also writes its statistics as JSON
+  arg_bus_monitor = getCmdOption(argc, argv, "+bus_monitor=");
+  bus_report      = getCmdOption(argc, argv, "+bus_report=");
+  bool bus_monitor = arg_bus_monitor.compare("1") == 0 || !bus_report.empty();
+  if(bus_monitor && !firmware_list.empty()) {
+    std::cout<<"[TESTBENCH]: ERROR: The bus monitor is not supported in batch mode"<<std::endl;
+    std::cout<<"exit simulation..."<<std::endl;
+    return -1;
+  }
+
+  //lockstep check of the CPU against the ISS, see tb_lockstep.h
+  arg_lockstep = getCmdOption(argc, argv, "+lockstep=");
+  if(arg_lockstep.compare("1") == 0) {
+#ifdef TB_HIER
+    std::cout<<"[TESTBENCH]: ERROR: The lockstep check needs the CPU internals, out of reach in a model built with FUSESOC_FLAGS=\"--flag=verilator_hier\""<<std::endl;
+    std::cout<<"exit simulation..."<<std::endl;
+    return -1;
+#endif
+    if(elf.empty() || !firmware_list.empty() || use_openocd || gdb_port != 0 || boot_sel != 0) {
+      std::cout<<"[TESTBENCH]: ERROR: The lockstep check needs +elf= and is not supported in batch mode, with OpenOCD or GDB nor when booting from flash"<<std::endl;
+      std::cout<<"exit simulation..."<<std::endl;
+      return -1;
+    }
+    if(!tb_lockstep.init(elf, getCmdOption(argc, argv, "+fpu=").compare("0") != 0)) {
+      std::cout<<"exit simulation..."<<std::endl;
+      return -1;
+    }
   }
 
-  dut->clk_i                = 0;
-  dut->rst_ni               = 1;
-  dut->jtag_tck_i           = 0;
-  dut->jtag_tms_i           = 0;
-  dut->jtag_trst_ni         = 0;
-  dut->jtag_tdi_i           = 0;
-  dut->execute_from_flash_i = execute_from_flash;
-  dut->boot_select_i        = boot_sel;
+  arg_max_sim_time = getCmdOption(argc, argv, "+max_sim_time=");
+  max_sim_time     = 0;
+  if(arg_max_sim_time.empty()){
+    std::cout<<"[TESTBENCH]: No Max time specified"<<std::endl;
+    run_all = true;
+  } else {
+    max_sim_time = stoi(arg_max_sim_time);
+    std::cout<<"[TESTBENCH]: Max Times is  "<<max_sim_time<<std::endl;
+  }
+
+  sim->setBootMode(boot_sel, execute_from_flash);
+
+  if(!firmware_list.empty()) {
+    int report_fd = open(batch_report.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    if(report_fd < 0) {
+      std::cout<<"[TESTBENCH]: ERROR: cannot open "<<batch_report<<std::endl;
+      exit(EXIT_FAILURE);
+    }
 
-  dut->eval();
-  m_trace->dump(sim_time);
-  sim_time++;
+    sim->start();
+    int failures = runBatchPool(*sim, images, max_cycles, report_fd, jobs);
+    close(report_fd);
 
-  dut->rst_ni               = 1;
-  //this creates the negedge
-  runCycles(50, dut, m_trace);
-  dut->rst_ni               = 0;
-  runCycles(50, dut, m_trace);
+    std::cout<<"[TESTBENCH]: Batch finished, "<<failures<<" failing"<<std::endl;
+    delete sim;
+    exit(failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
 
+#ifdef TB_SAVABLE
+  if(!restore_checkpoint.empty()) {
+    //the checkpoint already went through reset and reached the boot loop
+    sim->restoreCheckpoint(restore_checkpoint);
+    std::cout<<"Checkpoint "<<restore_checkpoint<<" restored at time "<<sim->time()<<std::endl;
+  } else
+#endif
+  {
+    sim->start();
+    sim->reset();
+    std::cout<<"Reset Released"<< std::endl;
+  }
 
-  dut->rst_ni = 1;
-  runCycles(20, dut, m_trace);
-  std::cout<<"Reset Released"<< std::endl;
+#ifdef TB_SAVABLE
+  if(!save_checkpoint.empty()) {
+    //the boot loop is waiting for the firmware, nothing is loaded yet
+    sim->saveCheckpoint(save_checkpoint);
+    std::cout<<"Checkpoint saved to "<<save_checkpoint<<std::endl;
+    delete sim;
+    exit(EXIT_SUCCESS);
+  }
+#endif
 
-  //dont need to exit from boot loop if using OpenOCD or Boot from Flash
-  if(use_openocd==false || boot_sel == 1) {
-    dut->tb_loadHEX(firmware.c_str());
-    runCycles(1, dut, m_trace);
-    dut->tb_set_exit_loop();
+  //dont need to exit from boot loop if using OpenOCD or Boot from Flash,
+  //with the GDB server the firmware is optional
+  if(use_openocd==false && boot_sel == 0 && (!elf.empty() || !firmware.empty())) {
+    if(!elf.empty()) {
+      if(!sim->loadElf(elf)) {
+        std::cout<<"exit simulation..."<<std::endl;
+        exit(EXIT_FAILURE);
+      }
+    } else {
+      sim->loadHex(firmware);
+    }
+    //armed when the firmware reaches its entry point
+    if(tb_lockstep.enabled())
+      dut->tb_lockstep_start();
+    sim->startFirmware();
     std::cout<<"Set Exit Loop"<< std::endl;
-    runCycles(1, dut, m_trace);
     std::cout<<"Memory Loaded"<< std::endl;
-  } else {
+  } else if(boot_sel == 0) {
     std::cout<<"Waiting for GDB"<< std::endl;
   }
 
-  if(run_all==false) {
-    runCycles(max_sim_time, dut, m_trace);
+  std::chrono::steady_clock::time_point run_start = std::chrono::steady_clock::now();
+  vluint64_t run_start_time = sim->time();
+  dut->tb_perf_reset();
+  if(tb_profiler.period() != 0)
+    dut->tb_prof_start(tb_profiler.period());
+  if(bus_monitor) {
+    int bus_masters, bus_slaves;
+    dut->tb_bus_monitor_start(&bus_masters, &bus_slaves);
+    int mem_size, num_banks;
+    dut->tb_getMemSize(&mem_size, &num_banks);
+    tb_busmon.init(bus_masters, bus_slaves, num_banks);
+  }
+
+  if(gdb_port != 0) {
+    //the simulation goes on after GDB detaches, until the firmware exits
+    GdbServer gdb(*sim);
+    if(gdb.run(gdb_port))
+      sim->runUntilExit();
+  } else if(run_all==false) {
+    //+max_sim_time counts clock edges
+    sim->step(max_sim_time / 2);
+    sim->tick(max_sim_time % 2);
+  } else if(tb_lockstep.enabled()) {
+    //stops on the first divergence
+    sim->runUntil([](XHeepSim &s) { return s.exited() || tb_lockstep.failed(); });
   } else {
-    while(dut->exit_valid_o!=1) {
-      runCycles(500, dut, m_trace);
-    }
+    //checked every cycle, so that the run stops on the exit cycle
+    sim->runUntilExit();
   }
 
+  tb_spiflash.printStats();
+  tb_slowmem.printStats();
+  tb_pdm_mic.printStats();
+  tb_i2s_mic.printStats();
+  tb_hostcall.printStats();
+  tb_busmon.printStats((sim->time() - run_start_time) / 2);
+  tb_lockstep.printStats();
+#ifdef TB_SPARSE_SRAM
+  SparseSram::printStats();
+#endif
+  if(!bus_report.empty())
+    tb_busmon.writeReport(bus_report, (sim->time() - run_start_time) / 2);
+
+  if(tb_profiler.period() != 0) {
+    tb_profiler.printFlat(10);
+    tb_profiler.writeGmon(profile_out);
+  }
+
+  if(sim->fastForwardEnabled())
+    std::cout<<"[TESTBENCH]: Fast-forwarded "<<sim->ffSkippedCycles()<<" idle cycles in "<<sim->ffJumps()<<" jumps"<<std::endl;
+
+  //simulation throughput, parsed by util/sim_bench.py
+  double run_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - run_start).count();
+  vluint64_t run_cycles = (sim->time() - run_start_time) / 2;
+  std::cout<<"[TESTBENCH]: Simulated "<<run_cycles<<" cycles in "<<run_time<<" s ("
+           <<(run_time > 0 ? run_cycles / run_time / 1000 : 0)<<" kHz)"<<std::endl;
+
+  if(!perf_report.empty()) {
+    std::ofstream report(perf_report.c_str());
+    report<<"{\"firmware\": \""<<jsonEscape(elf.empty() ? firmware : elf)<<"\""
+          <<", \"exit_valid\": "<<(dut->exit_valid_o == 1 ? "true" : "false")
+          <<", \"exit_value\": "<<dut->exit_value_o
+          <<", \"cycles\": "<<run_cycles
+          <<", \"fast_forward_cycles\": "<<sim->ffSkippedCycles()
+          <<", \"wall_time_s\": "<<run_time
+          <<", "<<perfJson(dut)<<"}"<<std::endl;
+    if(!report)
+      std::cout<<"[TESTBENCH]: ERROR: cannot write the performance report "<<perf_report<<std::endl;
+  }
+
+  bool dump_ok = !mem_dump.enabled() || mem_dump.dump(sim->memory());
+
   if(dut->exit_valid_o==1) {
     std::cout<<"Program Finished with value "<<dut->exit_value_o<<std::endl;
     exit_val = EXIT_SUCCESS;
   } else exit_val = EXIT_FAILURE;
+  if(tb_lockstep.failed() || !dump_ok)
+    exit_val = EXIT_FAILURE;
 
-  m_trace->close();
-  delete dut;
+  delete sim;
 
   exit(exit_val);
 
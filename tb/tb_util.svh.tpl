@@ -10,8 +10,421 @@ export "DPI-C" task tb_loadHEX;
 export "DPI-C" task tb_writetoSram${bank};
 % endfor
 export "DPI-C" task tb_getMemSize;
+export "DPI-C" task tb_getMemCfg;
 export "DPI-C" task tb_set_exit_loop;
 
+// External interrupt lines and GPIO pads driven by the C++ testbench, see
+// tb_set_ext_irq and tb_gpio_drive
+logic [63:0] tb_ext_irq = '0;
+logic [31:0] tb_gpio_oe = '0;
+logic [31:0] tb_gpio_out = '0;
+
+`ifdef VERILATOR
+// The C context of the UART DPI is not part of a Verilator checkpoint and
+// has to be created again after a restore
+import "DPI-C" function chandle uartdpi_create(
+  input string name,
+  input string log_file_path
+);
+import "DPI-C" function void uartdpi_close(input chandle ctx);
+export "DPI-C" task tb_uart_reinit;
+export "DPI-C" task tb_uart_reopen;
+
+task tb_uart_reinit;
+  i_uart0.ctx = uartdpi_create("uart0", i_uart0.log_file_path);
+endtask
+
+// Redirects the UART output to a new log file (one per image in batch mode)
+task tb_uart_reopen;
+  input string log_file_path;
+  uartdpi_close(i_uart0.ctx);
+  i_uart0.log_file_path = log_file_path;
+  tb_uart_reinit();
+endtask
+
+// Interrupts and GPIOs of XHeepSim (tb_sim.cpp): the external interrupt
+// lines not used by testharness.sv and the GPIO pads only connected to x-heep
+// follow the levels set from C++
+export "DPI-C" task tb_set_ext_irq;
+export "DPI-C" task tb_gpio_drive;
+export "DPI-C" task tb_gpio_read;
+
+task tb_set_ext_irq;
+  input int line;
+  input int level;
+  if (line >= 0 && line < core_v_mini_mcu_pkg::NEXT_INT) tb_ext_irq[line] = level != 0;
+endtask
+
+task tb_gpio_drive;
+  input int oe;
+  input int value;
+  tb_gpio_oe  = oe;
+  tb_gpio_out = value;
+endtask
+
+task tb_gpio_read;
+  output int value;
+  value = gpio;
+endtask
+
+// WFI fast-forward: while the core sleeps, no master is on the system bus and
+// the DMA and the power manager counters are idle, the only thing that can
+// wake the core up is an rv_timer compare match. The enabled timers are then
+// advanced in one step up to TB_FF_MARGIN cycles before the first match
+// instead of being clocked cycle by cycle.
+<%
+  ff_mcu = "x_heep_system_i.core_v_mini_mcu_i"
+  ff_pm = ff_mcu + ".ao_peripheral_subsystem_i.power_manager_i"
+  ff_timers = [(ff_mcu + ".ao_peripheral_subsystem_i.rv_timer_0_1_i", "1'b1")]
+  if peripherals["rv_timer"]["is_included"] in ("yes"):
+    ff_timers.append((ff_mcu + ".peripheral_subsystem_i.rv_timer_2_3_i", ff_mcu + ".peripheral_subsystem_clkgate_en_n"))
+  ff_counters = ["cpu_reset_assert", "cpu_reset_deassert", "cpu_powergate_switch_off",
+                 "cpu_powergate_switch_on", "cpu_powergate_iso_off", "cpu_powergate_iso_on"]
+%>
+localparam longint unsigned TB_FF_MARGIN = 4;
+
+// Total number of skipped cycles, it marks every jump in the waveforms
+longint unsigned tb_ff_skipped_cycles = 0;
+
+export "DPI-C" task tb_wfi_fast_forward;
+
+`ifndef VERILATOR_HIER
+function automatic bit tb_ff_idle();
+  if (!${ff_mcu}.core_sleep || |${ff_mcu}.intr) return 1'b0;
+  if (${ff_mcu}.ao_peripheral_subsystem_i.dma_i.busy) return 1'b0;
+  for (int i = 0; i < core_v_mini_mcu_pkg::SYSTEM_XBAR_NMASTER; i++)
+    if (${ff_mcu}.system_bus_i.int_master_req[i].req) return 1'b0;
+  for (int i = 0; i < core_v_mini_mcu_pkg::SYSTEM_XBAR_NSLAVE; i++)
+    if (${ff_mcu}.system_bus_i.int_slave_req[i].req) return 1'b0;
+% for counter in ff_counters:
+  if (2'(${ff_pm}.reg_to_counter_${counter}_i.counter_curr_state) == 2'd1) return 1'b0;
+% endfor
+  return 1'b1;
+endfunction
+
+// Cycles until mtime reaches mtimecmp, saturated to limit
+function automatic longint unsigned tb_ff_timer_distance(
+  input longint unsigned mtime, input longint unsigned mtimecmp, input int unsigned prescaler,
+  input int unsigned step, input int unsigned tick_count, input longint unsigned limit);
+  longint unsigned ticks;
+  if (mtime >= mtimecmp || tick_count > prescaler) return 0;
+  ticks = (mtimecmp - mtime - 1) / step + 1;
+  if (ticks > limit / (prescaler + 1)) return limit;
+  return ticks * (prescaler + 1) - tick_count;
+endfunction
+
+task tb_wfi_fast_forward;
+  input longint min_skip;
+  input longint max_skip;
+  output longint skipped;
+  longint unsigned dist, total, mtime;
+  bit armed;
+
+  skipped = 0;
+  if (!tb_ff_idle()) return;
+
+  dist  = max_skip + TB_FF_MARGIN;
+  armed = 1'b0;
+% for timer, clk_en in ff_timers:
+% for h in range(2):
+  if (${clk_en} && ${timer}.u_reg.u_ctrl_active_${h}.q && ${timer}.u_reg.u_intr_enable${h}.q &&
+      ${timer}.u_reg.u_cfg${h}_step.q != 0) begin
+    armed = 1'b1;
+    total = tb_ff_timer_distance({${timer}.u_reg.u_timer_v_upper${h}.q, ${timer}.u_reg.u_timer_v_lower${h}.q},
+                                 {${timer}.u_reg.u_compare_upper${h}_0.q, ${timer}.u_reg.u_compare_lower${h}_0.q},
+                                 ${timer}.u_reg.u_cfg${h}_prescale.q, ${timer}.u_reg.u_cfg${h}_step.q,
+                                 ${timer}.gen_harts[${h}].u_core.tick_count, dist);
+    if (total < dist) dist = total;
+  end
+% endfor
+% endfor
+  if (!armed || dist < min_skip + TB_FF_MARGIN) return;
+  skipped = dist - TB_FF_MARGIN;
+
+  // Every running timer moves on by skipped cycles, matching timer_core.sv
+% for timer, clk_en in ff_timers:
+% for h in range(2):
+  if (${clk_en} && ${timer}.u_reg.u_ctrl_active_${h}.q) begin
+    total = ${timer}.gen_harts[${h}].u_core.tick_count + skipped;
+    mtime = {${timer}.u_reg.u_timer_v_upper${h}.q, ${timer}.u_reg.u_timer_v_lower${h}.q} +
+            total / (${timer}.u_reg.u_cfg${h}_prescale.q + 1) * ${timer}.u_reg.u_cfg${h}_step.q;
+    ${timer}.u_reg.u_timer_v_upper${h}.q = mtime[63:32];
+    ${timer}.u_reg.u_timer_v_lower${h}.q = mtime[31:0];
+    ${timer}.gen_harts[${h}].u_core.tick_count = 12'(total % (${timer}.u_reg.u_cfg${h}_prescale.q + 1));
+  end
+% endfor
+% endfor
+  tb_ff_skipped_cycles = tb_ff_skipped_cycles + skipped;
+endtask
+`else
+// The timers of peripheral_subsystem are inside its hierarchical block and
+// cannot be advanced from here, tb_top.cpp refuses +wfi_fast_forward
+task tb_wfi_fast_forward;
+  input longint min_skip;
+  input longint max_skip;
+  output longint skipped;
+  skipped = 0;
+endtask
+`endif
+
+// Performance counters of the run, cleared by tb_perf_reset when the
+// firmware is started and read back by tb_getPerf and tb_getSramAccesses
+<%
+  if cpu_type == "cv32e20":
+    perf_cs = ff_mcu + ".cpu_subsystem_i.gen_cv32e20.cv32e20_i.u_cve2_core.cs_registers_i"
+    perf_mcycle = perf_cs + ".mcycle_counter_i.counter_val_o"
+    perf_minstret = perf_cs + ".minstret_counter_i.counter_val_o"
+  else:
+    if cpu_type == "cv32e40x":
+      perf_cs = ff_mcu + ".cpu_subsystem_i.gen_cv32e40x.cv32e40x_core_i.cs_registers_i"
+    elif cpu_type == "cv32e40px":
+      perf_cs = ff_mcu + ".cpu_subsystem_i.gen_cv32e40px.cv32e40px_top_i.core_i.cs_registers_i"
+    else:
+      perf_cs = ff_mcu + ".cpu_subsystem_i.gen_cv32e40p.cv32e40p_top_i.core_i.cs_registers_i"
+    perf_mcycle = perf_cs + ".mhpmcounter_q[0]"
+    perf_minstret = perf_cs + ".mhpmcounter_q[2]"
+%>
+longint unsigned tb_perf_sram_reads [core_v_mini_mcu_pkg::NUM_BANKS];
+longint unsigned tb_perf_sram_writes[core_v_mini_mcu_pkg::NUM_BANKS];
+longint unsigned tb_perf_dma_busy;
+
+always_ff @(posedge clk_i) begin
+  for (int i = 0; i < core_v_mini_mcu_pkg::NUM_BANKS; i++) begin
+    if (${ff_mcu}.memory_subsystem_i.ram_req_i[i].req) begin
+      if (${ff_mcu}.memory_subsystem_i.ram_req_i[i].we)
+        tb_perf_sram_writes[i] <= tb_perf_sram_writes[i] + 1;
+      else tb_perf_sram_reads[i] <= tb_perf_sram_reads[i] + 1;
+    end
+  end
+  if (${ff_mcu}.ao_peripheral_subsystem_i.dma_i.busy)
+    tb_perf_dma_busy <= tb_perf_dma_busy + 1;
+end
+
+export "DPI-C" task tb_perf_reset;
+export "DPI-C" task tb_getPerf;
+export "DPI-C" task tb_getSramAccesses;
+
+task tb_perf_reset;
+  for (int i = 0; i < core_v_mini_mcu_pkg::NUM_BANKS; i++) begin
+    tb_perf_sram_reads[i]  = 0;
+    tb_perf_sram_writes[i] = 0;
+  end
+  tb_perf_dma_busy = 0;
+endtask
+
+// mcycle and minstret are read from the CSRs of ${cpu_type}
+task tb_getPerf;
+  output longint mcycle;
+  output longint minstret;
+  output longint dma_busy;
+`ifndef VERILATOR_HIER
+  mcycle   = ${perf_mcycle};
+  minstret = ${perf_minstret};
+`else
+  // the CSRs are inside the hierarchical block of cpu_subsystem
+  mcycle   = -1;
+  minstret = -1;
+`endif
+  dma_busy = tb_perf_dma_busy;
+endtask
+
+task tb_getSramAccesses;
+  input int bank;
+  output longint reads;
+  output longint writes;
+  reads  = tb_perf_sram_reads[bank];
+  writes = tb_perf_sram_writes[bank];
+endtask
+
+// PC-sampling profiler (tb_profiler.cpp): every tb_prof_period cycles the PC
+// of the last retired instruction is sampled, and every retired call (jal or
+// jalr linking to ra or t0) is reported with the first PC retired after it
+<%
+  if cpu_type == "cv32e20":
+    prof_core = ff_mcu + ".cpu_subsystem_i.gen_cv32e20.cv32e20_i.u_cve2_core"
+    prof_retire = prof_core + ".instr_id_done"
+    prof_pc = prof_core + ".pc_id"
+    prof_instr = prof_core + ".instr_rdata_id"
+  elif cpu_type == "cv32e40x":
+    prof_core = ff_mcu + ".cpu_subsystem_i.gen_cv32e40x.cv32e40x_core_i"
+    prof_retire = prof_core + ".wb_valid"
+    prof_pc = prof_core + ".ex_wb_pipe.pc"
+    prof_instr = prof_core + ".ex_wb_pipe.instr.bus_resp.rdata"
+  else:
+    if cpu_type == "cv32e40px":
+      prof_core = ff_mcu + ".cpu_subsystem_i.gen_cv32e40px.cv32e40px_top_i.core_i"
+    else:
+      prof_core = ff_mcu + ".cpu_subsystem_i.gen_cv32e40p.cv32e40p_top_i.core_i"
+    prof_retire = prof_core + ".instr_valid_id && " + prof_core + ".id_valid && " + prof_core + ".is_decoding"
+    prof_pc = prof_core + ".pc_id"
+    prof_instr = prof_core + ".instr_rdata_id"
+%>
+import "DPI-C" function void tb_prof_sample(input int pc);
+import "DPI-C" function void tb_prof_arc(input int from_pc, input int self_pc);
+export "DPI-C" task tb_prof_start;
+
+int unsigned tb_prof_period = 0;
+int unsigned tb_prof_count;
+logic [31:0] tb_prof_pc;
+logic [31:0] tb_prof_call_pc;
+logic        tb_prof_call;
+
+// the instruction words of ${cpu_type} are already decompressed at retirement
+function automatic logic tb_prof_is_call(logic [31:0] instr);
+  return (instr[6:0] == 7'b1101111 || instr[6:0] == 7'b1100111) &&
+         (instr[11:7] == 5'd1 || instr[11:7] == 5'd5);
+endfunction
+
+`ifndef VERILATOR_HIER
+always_ff @(posedge clk_i) begin
+  if (tb_prof_period != 0) begin
+    if (${prof_retire}) begin
+      if (tb_prof_call) tb_prof_arc(tb_prof_call_pc, ${prof_pc});
+      tb_prof_call    <= tb_prof_is_call(${prof_instr});
+      tb_prof_call_pc <= ${prof_pc};
+      tb_prof_pc      <= ${prof_pc};
+    end
+    if (tb_prof_count + 1 >= tb_prof_period) begin
+      tb_prof_sample(tb_prof_pc);
+      tb_prof_count <= 0;
+    end else tb_prof_count <= tb_prof_count + 1;
+  end
+end
+`endif
+
+task tb_prof_start;
+  input int period;
+  tb_prof_period = period;
+  tb_prof_count  = 0;
+  tb_prof_call   = 1'b0;
+`ifndef VERILATOR_HIER
+  tb_prof_pc     = ${prof_pc};
+`endif
+endtask
+
+// Host calls (sw/device/lib/runtime/host_call.h): the descriptor whose address
+// is written to the HOST_CALL register of soc_ctrl is served by tb_hostcall.cpp
+// on the clock edge of the write
+import "DPI-C" function void tb_host_call(input int desc);
+
+always_ff @(posedge clk_i) begin
+  if (${ff_mcu}.ao_peripheral_subsystem_i.soc_ctrl_i.soc_ctrl_reg_top_i.host_call_we)
+    tb_host_call(${ff_mcu}.ao_peripheral_subsystem_i.soc_ctrl_i.soc_ctrl_reg_top_i.host_call_wd);
+end
+
+// OBI bus monitor (tb_busmon.cpp): watches the masters of the system crossbar
+// once tb_bus_monitor_start is called. The accesses forwarded to the external
+// slaves by the demux crossbars do not go through it and are not seen.
+<%
+  bus_mon = ff_mcu + ".system_bus_i"
+%>
+import "DPI-C" function void tb_bus_grant(input int master, input int slave, input int we,
+                                          input int bytes, input int wait_cycles,
+                                          input longint cycle);
+import "DPI-C" function void tb_bus_response(input int master, input longint cycle);
+import "DPI-C" function void tb_bus_stall(input int master, input int winner);
+export "DPI-C" task tb_bus_monitor_start;
+
+localparam int unsigned TB_BUS_NMASTER = core_v_mini_mcu_pkg::SYSTEM_XBAR_NMASTER +
+    (USE_EXTERNAL_DEVICE_EXAMPLE ? testharness_pkg::EXT_XBAR_NMASTER : 0);
+
+bit              tb_bus_monitor_on = 1'b0;
+longint unsigned tb_bus_cycle;
+int unsigned     tb_bus_wait[TB_BUS_NMASTER];
+
+// Slave selected by the address decoder of system_xbar
+function automatic int tb_bus_slave(input logic [31:0] addr);
+  for (int i = 0; i < core_v_mini_mcu_pkg::SYSTEM_XBAR_NSLAVE; i++) begin
+    if (addr >= core_v_mini_mcu_pkg::XBAR_ADDR_RULES[i].start_addr &&
+        addr < core_v_mini_mcu_pkg::XBAR_ADDR_RULES[i].end_addr) begin
+      // the interleaved banks share one rule, the bank is in the word address
+      if (core_v_mini_mcu_pkg::NUM_BANKS_IL != 0 && core_v_mini_mcu_pkg::XBAR_ADDR_RULES[i].idx ==
+          core_v_mini_mcu_pkg::NUM_BANKS - core_v_mini_mcu_pkg::NUM_BANKS_IL + 1)
+        return int'(core_v_mini_mcu_pkg::XBAR_ADDR_RULES[i].idx) +
+               int'((addr >> 2) & (core_v_mini_mcu_pkg::NUM_BANKS_IL - 1));
+      return int'(core_v_mini_mcu_pkg::XBAR_ADDR_RULES[i].idx);
+    end
+  end
+  return int'(core_v_mini_mcu_pkg::ERROR_IDX);
+endfunction
+
+// with the ${bus_type} bus a waiting master is stalled by the masters granted
+% if bus_type == "NtoM":
+// on the same slave
+% else:
+// on any slave, as they all go through a single port
+% endif
+function automatic bit tb_bus_stalled_by(input int master, input int winner);
+  if (winner == master || !${bus_mon}.master_req[winner].req || !${bus_mon}.master_resp[winner].gnt)
+    return 1'b0;
+% if bus_type == "NtoM":
+  return tb_bus_slave(${bus_mon}.master_req[winner].addr) == tb_bus_slave(${bus_mon}.master_req[master].addr);
+% else:
+  return 1'b1;
+% endif
+endfunction
+
+always_ff @(posedge clk_i) begin
+  if (tb_bus_monitor_on) begin
+    for (int m = 0; m < TB_BUS_NMASTER; m++) begin
+      if (${bus_mon}.master_resp[m].rvalid) tb_bus_response(m, tb_bus_cycle);
+      if (${bus_mon}.master_req[m].req) begin
+        if (${bus_mon}.master_resp[m].gnt) begin
+          tb_bus_grant(m, tb_bus_slave(${bus_mon}.master_req[m].addr), int'(${bus_mon}.master_req[m].we),
+                       $countones(${bus_mon}.master_req[m].be), tb_bus_wait[m], tb_bus_cycle);
+          tb_bus_wait[m] <= 0;
+        end else begin
+          tb_bus_wait[m] <= tb_bus_wait[m] + 1;
+          for (int k = 0; k < TB_BUS_NMASTER; k++)
+            if (tb_bus_stalled_by(m, k)) tb_bus_stall(m, k);
+        end
+      end
+    end
+    tb_bus_cycle <= tb_bus_cycle + 1;
+  end
+end
+
+task tb_bus_monitor_start;
+  output int num_masters;
+  output int num_slaves;
+  for (int m = 0; m < TB_BUS_NMASTER; m++) tb_bus_wait[m] = 0;
+  tb_bus_cycle      = 0;
+  tb_bus_monitor_on = 1'b1;
+  num_masters       = TB_BUS_NMASTER;
+  num_slaves        = core_v_mini_mcu_pkg::SYSTEM_XBAR_NSLAVE;
+endtask
+
+// Lockstep check against the ISS (tb_lockstep.cpp): the retired PCs and the
+// transactions of the core data port, responses first, then requests, then
+// the instruction that retires on the same edge
+import "DPI-C" function void tb_lockstep_commit(input int pc, input int instr);
+import "DPI-C" function void tb_lockstep_data_req(input int we, input int addr, input int be, input int wdata);
+import "DPI-C" function void tb_lockstep_data_resp(input int rdata);
+export "DPI-C" task tb_lockstep_start;
+
+bit tb_lockstep_on = 1'b0;
+
+always_ff @(posedge clk_i) begin
+  if (tb_lockstep_on) begin
+    if (${bus_mon}.master_resp[core_v_mini_mcu_pkg::CORE_DATA_IDX].rvalid)
+      tb_lockstep_data_resp(${bus_mon}.master_resp[core_v_mini_mcu_pkg::CORE_DATA_IDX].rdata);
+    if (${bus_mon}.master_req[core_v_mini_mcu_pkg::CORE_DATA_IDX].req &&
+        ${bus_mon}.master_resp[core_v_mini_mcu_pkg::CORE_DATA_IDX].gnt)
+      tb_lockstep_data_req(int'(${bus_mon}.master_req[core_v_mini_mcu_pkg::CORE_DATA_IDX].we),
+                           ${bus_mon}.master_req[core_v_mini_mcu_pkg::CORE_DATA_IDX].addr,
+                           int'(${bus_mon}.master_req[core_v_mini_mcu_pkg::CORE_DATA_IDX].be),
+                           ${bus_mon}.master_req[core_v_mini_mcu_pkg::CORE_DATA_IDX].wdata);
+`ifndef VERILATOR_HIER
+    if (${prof_retire}) tb_lockstep_commit(${prof_pc}, ${prof_instr});
+`endif
+  end
+end
+
+task tb_lockstep_start;
+  tb_lockstep_on = 1'b1;
+endtask
+`endif
+
 import core_v_mini_mcu_pkg::*;
 
 task tb_getMemSize;
@@ -21,6 +434,13 @@ task tb_getMemSize;
   num_banks = core_v_mini_mcu_pkg::NUM_BANKS;
 endtask
 
+task tb_getMemCfg;
+  output int ram_start;
+  output int num_banks_il;
+  ram_start    = core_v_mini_mcu_pkg::RAM0_START_ADDRESS;
+  num_banks_il = core_v_mini_mcu_pkg::NUM_BANKS_IL;
+endtask
+
 task tb_readHEX;
   input string file;
   output logic [7:0] stimuli[core_v_mini_mcu_pkg::MEM_SIZE];
@@ -101,7 +521,11 @@ task tb_writetoSram${bank};
   input [7:0] val2;
   input [7:0] val1;
   input [7:0] val0;
-`ifdef VCS
+`ifdef SPARSE_SRAM
+  x_heep_system_i.core_v_mini_mcu_i.memory_subsystem_i.gen_sram[${bank}].ram_i.tb_write_word(addr, {
+    val3, val2, val1, val0
+  });
+`elsif VCS
   force x_heep_system_i.core_v_mini_mcu_i.memory_subsystem_i.gen_sram[${bank}].ram_i.tc_ram_i.sram[addr] = {
     val3, val2, val1, val0
   };
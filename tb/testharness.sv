@@ -129,15 +129,20 @@ module testharness #(
   ) ext_if ();
 
   always_comb begin
-    // All interrupt lines set to zero by default
+    // All interrupt lines driven by the C++ testbench, zero by default
     for (int i = 0; i < core_v_mini_mcu_pkg::NEXT_INT; i++) begin
-      intr_vector_ext[i] = 1'b0;
+      intr_vector_ext[i] = tb_ext_irq[i];
     end
     // Re-assign the interrupt lines used here
     intr_vector_ext[0] = memcopy_intr;
     intr_vector_ext[1] = iffifo_int_o;
   end
 
+  // GPIOs 0 to 17 are only connected to x-heep, the C++ testbench can drive them
+  for (genvar i = 0; i < 18; i++) begin : gen_tb_gpio
+    assign gpio[i] = tb_gpio_oe[i] ? tb_gpio_out[i] : 1'bz;
+  end
+
   //log parameters
   initial begin
     $display("%t: the parameter COREV_PULP is %x", $time, COREV_PULP);
@@ -518,6 +523,7 @@ module testharness #(
           .gpio_o(gpio[31])
       );
 
+`ifndef VERILATOR
       pdm2pcm_dummy pdm2pcm_dummy_i (
           .clk_i,
           .rst_ni,
@@ -532,6 +538,22 @@ module testharness #(
           .i2s_ws_i(gpio[21]),
           .i2s_sd_o(gpio[22])
       );
+`else
+      // C++ models of the microphones, driven from audio files, see tb/tb_audio.h
+      pdmmicdpi pdm2pcm_dummy_i (
+          .clk_i,
+          .rst_ni,
+          .pdm_data_o(gpio[18]),
+          .pdm_clk_i (gpio[19])
+      );
+
+      i2smicdpi i2s_microphone_i (
+          .rst_ni(rst_ni),
+          .i2s_sck_i(gpio[20]),
+          .i2s_ws_i(gpio[21]),
+          .i2s_sd_o(gpio[22])
+      );
+`endif
 
 `ifndef VERILATOR
       // Flash used for booting (execute from flash or copy from flash)
@@ -543,6 +565,17 @@ module testharness #(
           .io2(spi_flash_sd_io[2]),
           .io3(spi_flash_sd_io[3])
       );
+`else
+      // C++ model of the boot flash, see tb/tb_spiflash.cpp
+      spiflashdpi flash_boot_i (
+          .clk_i,
+          .csb(spi_flash_csb[0]),
+          .sck(spi_flash_sck),
+          .io0(spi_flash_sd_io[0]),  // MOSI
+          .io1(spi_flash_sd_io[1]),  // MISO
+          .io2(spi_flash_sd_io[2]),
+          .io3(spi_flash_sd_io[3])
+      );
 `endif
 
 `ifndef VERILATOR
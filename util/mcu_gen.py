@@ -454,6 +454,38 @@ def main():
     if  external_domains > 32:
         exit("external_domains must be less than 32 instead of " + str(external_domains))
 
+    try:
+        dma_ch_num = int(obj['dma']['num_channels'])
+    except KeyError:
+        dma_ch_num = 1
+
+    if dma_ch_num < 1 or dma_ch_num > 16:
+        exit("dma num_channels must be between 1 and 16 instead of " + str(dma_ch_num))
+
+    try:
+        dma_arb_policy = obj['dma']['arbitration']
+    except KeyError:
+        dma_arb_policy = 'round_robin'
+
+    if dma_arb_policy not in ('round_robin', 'priority'):
+        exit("dma arbitration must be 'round_robin' or 'priority' instead of " + str(dma_arb_policy))
+
+    try:
+        dma_fifo_depth = int(obj['dma']['fifo_depth'])
+    except KeyError:
+        dma_fifo_depth = 4
+
+    try:
+        dma_max_outstanding = int(obj['dma']['max_outstanding'])
+    except KeyError:
+        dma_max_outstanding = 2
+
+    if dma_fifo_depth < 2:
+        exit("dma fifo_depth must be at least 2 instead of " + str(dma_fifo_depth))
+
+    if dma_max_outstanding < 1 or dma_max_outstanding >= dma_fifo_depth:
+        exit("dma max_outstanding must be at least 1 and less than fifo_depth instead of " + str(dma_max_outstanding))
+
     debug_start_address = string2int(obj['debug']['address'])
     if int(debug_start_address, 16) < int('10000', 16):
         exit("debug start address must be greater than 0x10000")
@@ -846,6 +878,10 @@ def main():
         "ram_numbanks_il"                  : ram_numbanks_il,
         "log_ram_numbanks_il"              : log_ram_numbanks_il,
         "external_domains"                 : external_domains,
+        "dma_ch_num"                       : dma_ch_num,
+        "dma_arb_policy"                   : dma_arb_policy,
+        "dma_fifo_depth"                   : dma_fifo_depth,
+        "dma_max_outstanding"              : dma_max_outstanding,
         "ram_size_address"                 : ram_size_address,
         "debug_start_address"              : debug_start_address,
         "debug_size_address"               : debug_size_address,
@@ -0,0 +1,138 @@
+#!/usr/bin/env python3
+# Copyright EPFL contributors.
+# Licensed under the Apache License, Version 2.0, see LICENSE for details.
+# SPDX-License-Identifier: Apache-2.0
+
+# Verilator simulation throughput benchmark.
+#
+# For every CPU and bus type, the MCU is generated, the Verilator model is
+# built and each benchmark application is simulated without waveforms. The
+# simulated kHz reported by the testbench are collected in a table and in a
+# CSV file, so that simulator speed regressions can be tracked over time.
+
+import argparse
+import csv
+import os
+import re
+import subprocess
+import sys
+import time
+
+CPUS = ["cv32e20", "cv32e40p", "cv32e40x", "cv32e40px"]
+BUSES = ["onetoM", "NtoM"]
+APPS = ["hello_world", "coremark", "example_matmul"]
+
+SIM_DIR = "build/openhwgroup.org_systems_core-v-mini-mcu_0/sim-verilator"
+THROUGHPUT_RE = re.compile(r"\[TESTBENCH\]: Simulated (\d+) cycles in ([0-9.e+-]+) s")
+EXIT_RE = re.compile(r"Program Finished with value (\d+)")
+BUILD_ERROR_RE = re.compile(r"^(%Error|ERROR)", re.M)
+
+
+def make(target, log, **variables):
+    cmd = ["make", "--no-print-directory", target]
+    cmd += ["{}={}".format(k, v) for k, v in variables.items()]
+    log.write("$ {}\n".format(" ".join(cmd)))
+    log.flush()
+    return subprocess.run(cmd, stdout=log, stderr=subprocess.STDOUT).returncode == 0
+
+
+def build_model(fusesoc_flags, log):
+    # make verilator-sim pipes FuseSoC through tee, its status is always 0:
+    # the model of the previous configuration is removed, so the build only
+    # succeeded if a new one was linked
+    model = os.path.join(SIM_DIR, "Vtestharness")
+    if os.path.exists(model):
+        os.remove(model)
+    start = time.time()
+    make("verilator-sim", log, FUSESOC_FLAGS=fusesoc_flags)
+    with open("buildsim.log") as build_log:
+        if BUILD_ERROR_RE.search(build_log.read()):
+            return False
+    return os.path.isfile(model) and os.path.getmtime(model) >= start
+
+
+def simulate(timeout, log):
+    cmd = ["./Vtestharness", "+elf=../../../sw/build/main.elf", "+trace=none"]
+    start = time.monotonic()
+    try:
+        out = subprocess.run(cmd, cwd=SIM_DIR, stdout=subprocess.PIPE,
+                             stderr=subprocess.STDOUT, timeout=timeout,
+                             universal_newlines=True).stdout
+    except subprocess.TimeoutExpired:
+        return None
+    wall = time.monotonic() - start
+    log.write(out)
+
+    throughput = THROUGHPUT_RE.search(out)
+    exit_value = EXIT_RE.search(out)
+    if throughput is None or exit_value is None:
+        return None
+    cycles = int(throughput.group(1))
+    run_time = float(throughput.group(2))
+    return {
+        "cycles": cycles,
+        "run_time_s": run_time,
+        "wall_time_s": wall,
+        "khz": cycles / run_time / 1000 if run_time > 0 else 0,
+        "exit_value": int(exit_value.group(1)),
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Verilator simulation throughput benchmark")
+    parser.add_argument("--cpus", default=",".join(CPUS),
+                        help="comma separated list of CPU types")
+    parser.add_argument("--buses", default=",".join(BUSES),
+                        help="comma separated list of bus types")
+    parser.add_argument("--apps", default=",".join(APPS),
+                        help="comma separated list of applications")
+    parser.add_argument("--fusesoc-flags", default="",
+                        help="FUSESOC_FLAGS used to build the model, e.g. --flag=verilator_mt")
+    parser.add_argument("--timeout", type=int, default=3600,
+                        help="timeout of each simulation in seconds")
+    parser.add_argument("--csv", default="sim_bench.csv", help="CSV output file")
+    parser.add_argument("--log", default="sim_bench_build.log",
+                        help="log of the build and simulation output")
+    args = parser.parse_args()
+
+    results = []
+    with open(args.log, "w") as log:
+        for cpu in args.cpus.split(","):
+            for bus in args.buses.split(","):
+                print("Building the model for CPU={} BUS={}".format(cpu, bus), flush=True)
+                if not (make("mcu-gen", log, CPU=cpu, BUS=bus) and
+                        build_model(args.fusesoc_flags, log)):
+                    print("  build failed, see {}".format(args.log))
+                    continue
+                for app in args.apps.split(","):
+                    if not make("app", log, PROJECT=app):
+                        print("  {}: build failed".format(app))
+                        continue
+                    res = simulate(args.timeout, log)
+                    if res is None:
+                        print("  {}: simulation failed".format(app))
+                        continue
+                    res.update({"cpu": cpu, "bus": bus, "app": app})
+                    results.append(res)
+                    print("  {}: {} cycles, {:.1f} kHz".format(app, res["cycles"], res["khz"]),
+                          flush=True)
+
+    fields = ["cpu", "bus", "app", "cycles", "run_time_s", "wall_time_s", "khz", "exit_value"]
+    with open(args.csv, "w", newline="") as f:
+        writer = csv.DictWriter(f, fieldnames=fields)
+        writer.writeheader()
+        writer.writerows(results)
+
+    print("\n{:<10} {:<7} {:<16} {:>12} {:>10}".format("CPU", "BUS", "APP", "CYCLES", "kHz"))
+    for res in results:
+        print("{:<10} {:<7} {:<16} {:>12} {:>10.1f}".format(
+            res["cpu"], res["bus"], res["app"], res["cycles"], res["khz"]))
+    print("\nResults written to {}".format(args.csv))
+
+    expected = len(args.cpus.split(",")) * len(args.buses.split(",")) * len(args.apps.split(","))
+    sys.exit(0 if len(results) == expected else 1)
+
+
+if __name__ == "__main__":
+    main()